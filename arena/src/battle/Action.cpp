@@ -19,9 +19,13 @@ void PotionAction::execute(BattleSystem& /*battle*/, Player& self, Player& /*opp
         LOG_WARN(module(), "Potion heal amount is non-positive, skipping.");
         return;
     }
-    Pet& pet = self.activePet();
-    pet.restoreHP(healAmount_);
-    LOG_INFO(module(), "Healed for ", healAmount_, " HP. Current HP=", pet.currentHP(), "/", pet.maxHP());
+    Pet* pet = self.activePetOrNull();
+    if (!pet) {
+        LOG_WARN(module(), "No active pet to heal, skipping.");
+        return;
+    }
+    pet->restoreHP(healAmount_);
+    LOG_INFO(module(), "Healed for ", healAmount_, " HP. Current HP=", pet->currentHP(), "/", pet->maxHP());
 }
 
 void FleeAction::execute(BattleSystem& battle, Player& /*self*/, Player& /*opponent*/) {
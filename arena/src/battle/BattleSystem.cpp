@@ -8,6 +8,7 @@
 #include <Player.h>
 
 #include "Action.h"
+#include "Zobrist.h"
 
 void BattleSystem::init(Player& p1, Player& p2) {
     player1_ = &p1;
@@ -17,33 +18,41 @@ void BattleSystem::init(Player& p1, Player& p2) {
     turnCounter_ = 0;
 }
 
-void BattleSystem::endBattle(const std::string& reason) {
+void BattleSystem::endBattle(std::string_view reason) {
     battleEnded_ = true;
-    endReason_ = reason;
+    endReason_.assign(reason.data(), reason.size()); // reuses the buffer kept across init()
     LOG_INFO(module(), "Battle ended. Reason: ", reason);
 }
 
+std::uint64_t BattleSystem::stateHash() const {
+    if (!player1_ || !player2_) return 0;
+    std::uint64_t h = Zobrist::place(Zobrist::Feature::Side, 0, player1_->stateHash());
+    h ^= Zobrist::place(Zobrist::Feature::Side, 1, player2_->stateHash());
+    h ^= Zobrist::key(Zobrist::Feature::TurnParity, 0, static_cast<std::uint64_t>(turnCounter_ & 1));
+    h ^= Zobrist::key(Zobrist::Feature::BattleEnded, 0, battleEnded_ ? 1 : 0);
+    return h;
+}
+
 void BattleSystem::onTurnStart(Player& p1, Player& p2) {
     // Hook for start-of-turn effects (weather, terrain, buffs, etc.).
-    if (p1.hasUsablePets() && !p1.activePet().isFainted()) {
-        p1.activePet().resetTurnDamageTaken();
-    }
-    if (p2.hasUsablePets() && !p2.activePet().isFainted()) {
-        p2.activePet().resetTurnDamageTaken();
+    for (Player* player : { &p1, &p2 }) {
+        if (Pet* pet = player->activePetOrNull(); pet && !pet->isFainted()) {
+            pet->battleState().resetTurnDamageTaken();
+        }
     }
 }
 
 void BattleSystem::onTurnEnd(Player& p1, Player& p2) {
     // Hook for end-of-turn effects (residual damage, timers, cleanup, etc.).
-    if (p1.hasUsablePets() && !p1.activePet().isFainted()) {
-        p1.activePet().tickDamageReductionTurn();
-    }
-    if (p2.hasUsablePets() && !p2.activePet().isFainted()) {
-        p2.activePet().tickDamageReductionTurn();
+    for (Player* player : { &p1, &p2 }) {
+        if (Pet* pet = player->activePetOrNull(); pet && !pet->isFainted()) {
+            pet->battleState().tickDamageReductionTurn();
+        }
     }
 }
 
-std::pair<Action*, Action*> BattleSystem::decideOrder(Action& action1, Action& action2, Pet& pet1, Pet& pet2) {
+std::pair<Action*, Action*> BattleSystem::decideOrder(Action& action1, Action& action2, const PetBattleState& pet1,
+                                                      const PetBattleState& pet2) {
     const int p1Priority = action1.priority();
     const int p2Priority = action2.priority();
 
@@ -95,8 +104,10 @@ void BattleSystem::takeTurn(Action& action1, Action& action2) {
     onTurnStart(*player1_, *player2_);
     if (battleEnded_) return;
 
-    Pet& pet1 = player1_->activePet();
-    Pet& pet2 = player2_->activePet();
+    // ensureActiveUsable() above guarantees both active slots are non-null.
+    // Turn ordering only needs the hot battle state (speed stage, stats).
+    const PetBattleState& pet1 = player1_->activePetOrNull()->battleState();
+    const PetBattleState& pet2 = player2_->activePetOrNull()->battleState();
     auto order = decideOrder(action1, action2, pet1, pet2);
 
     Action* first = order.first;
@@ -113,7 +124,7 @@ void BattleSystem::takeTurn(Action& action1, Action& action2) {
         return;
     }
 
-    if (secondPlayer->activePet().isFainted()) {
+    if (const Pet* secondPet = secondPlayer->activePetOrNull(); !secondPet || secondPet->isFainted()) {
         LOG_INFO(module(), "Second actor's active pet fainted; skipping action.");
         return;
     }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include <Pet.h>
@@ -12,16 +14,22 @@ class BattleSystem {
     void takeTurn(Action& action1, Action& action2);
 
     bool isBattleOver() const { return battleEnded_; }
-    void endBattle(const std::string& reason = {});
+    void endBattle(std::string_view reason = {});
     const std::string& endReason() const { return endReason_; }
 
     int currentTurn() const { return turnCounter_; }
 
+    // Zobrist hash of the whole battle: both sides' rosters (HP, PP, Buff, damage modifiers),
+    // active indices, turn parity and whether the battle has ended. Per-pet state is kept
+    // incrementally in PetBattleState, so this is O(roster size). Returns 0 before init().
+    std::uint64_t stateHash() const;
+
   private:
     void onTurnStart(Player& p1, Player& p2);
     void onTurnEnd(Player& p1, Player& p2);
 
-    std::pair<Action*, Action*> decideOrder(Action& action1, Action& action2, Pet& pet1, Pet& pet2);
+    std::pair<Action*, Action*> decideOrder(Action& action1, Action& action2, const PetBattleState& pet1,
+                                            const PetBattleState& pet2);
     static constexpr const char* module() { return "BattleSystem"; }
 
     Player* player1_ = nullptr;
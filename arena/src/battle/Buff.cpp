@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <cmath>
 
+#include <DamageCalc.h>
 #include <Pet.h>
+#include <PetBattleState.h>
 #include <rng/rng.h>
 
 namespace {
@@ -42,15 +44,8 @@ Buff::Buff() {
 }
 
 void Buff::reset() {
-    primary_ = Ailment::None;
-    secondary_ = Ailment::None;
-    trapped_ = false;
-    doubleLoss_ = false;
-    immuneExpel_ = false;
-    stageLocked_ = false;
-    toxicStacks_ = 0;
-    ailmentTurns_.fill(0);
-    statStages_.fill(0);
+    stageWord_ = kNeutralStages;
+    statusWord_ = 0;
 }
 
 bool Buff::applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, const ImmunityProfile& immunity) {
@@ -59,8 +54,8 @@ bool Buff::applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, co
     }
 
     if (status == Ailment::Trapped) {
-        const bool changed = !trapped_;
-        trapped_ = true;
+        const bool changed = !hasFlag(kTrapped);
+        setFlag(kTrapped, true);
         return changed;
     }
 
@@ -77,11 +72,11 @@ bool Buff::applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, co
     }
 
     if (isPrimaryGroup(status)) {
-        const bool changed = primary_ != status;
+        const bool changed = primaryAilment() != status;
         if (changed) {
-            resetCounter(primary_);
+            resetCounter(primaryAilment());
         }
-        primary_ = status;
+        setPrimary(status);
         resetCounter(status);
         if (status == Ailment::Paralysis && changed) {
             applyParalysisSpeedDrop();
@@ -93,14 +88,14 @@ bool Buff::applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, co
     }
 
     if (isSecondaryGroup(status)) {
-        const bool changed = secondary_ != status;
+        const bool changed = secondaryAilment() != status;
         if (changed) {
-            resetCounter(secondary_);
+            resetCounter(secondaryAilment());
         }
-        secondary_ = status;
+        setSecondary(status);
         resetCounter(status);
         if (status == Ailment::Toxic) {
-            toxicStacks_ = 0;
+            setToxicStacks(0);
         }
         return changed;
     }
@@ -108,8 +103,8 @@ bool Buff::applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, co
     return false;
 }
 
-bool Buff::applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>& attrs, Pet& self, Pet* opponent,
-                                   const ImmunityProfile& immunity) {
+bool Buff::applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>& attrs, PetBattleState& self,
+                                   PetBattleState* opponent, const ImmunityProfile& immunity) {
     const bool changed = applyAilment(status, attrs, immunity);
     if (!changed) return false;
 
@@ -121,35 +116,41 @@ bool Buff::applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>
     return true;
 }
 
+bool Buff::applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>& attrs, Pet& self, Pet* opponent,
+                                   const ImmunityProfile& immunity) {
+    return applyAilmentWithEffects(status, attrs, self.battleState(), opponent ? &opponent->battleState() : nullptr,
+                                   immunity);
+}
+
 bool Buff::hasAilment(Ailment status) const {
     switch (status) {
         case Ailment::None:
             return false;
         case Ailment::Trapped:
-            return trapped_;
+            return hasFlag(kTrapped);
         default:
             if (isPrimaryGroup(status)) {
-                return primary_ == status;
+                return primaryAilment() == status;
             }
             if (isSecondaryGroup(status)) {
-                return secondary_ == status;
+                return secondaryAilment() == status;
             }
             return false;
     }
 }
 
 void Buff::clearPrimary() {
-    resetCounter(primary_);
-    primary_ = Ailment::None;
+    resetCounter(primaryAilment());
+    setPrimary(Ailment::None);
 }
 
 void Buff::clearSecondary() {
-    resetCounter(secondary_);
-    secondary_ = Ailment::None;
+    resetCounter(secondaryAilment());
+    setSecondary(Ailment::None);
 }
 
 void Buff::clearTrapped() {
-    trapped_ = false;
+    setFlag(kTrapped, false);
 }
 
 void Buff::clearAilments() {
@@ -159,8 +160,8 @@ void Buff::clearAilments() {
     clearDoubleLoss();
     clearImmuneToExpel();
     clearStageLocked();
-    ailmentTurns_.fill(0);
-    toxicStacks_ = 0;
+    // 异常/标记/计数全部在 statusWord_ 中，能力等级不受影响。
+    statusWord_ = 0;
 }
 
 bool Buff::isControl(Ailment status) {
@@ -198,17 +199,15 @@ bool Buff::isSleepGroup(Ailment status) {
 
 int Buff::changeStage(Stat stat, int delta, const ImmunityProfile* immunity) {
     // 锁定强化：比免疫负面更高优先级，正负变化都被拒绝。
-    if (stageLocked_) {
+    if (stageLocked()) {
         return 0;
     }
     if (delta < 0 && immunity && immunity->ignoreNegativeStages) {
         return 0;
     }
-    const auto idx = static_cast<std::size_t>(stat);
-    const int before = statStages_[idx];
-    const int after = clampStage(before + delta);
-    statStages_[idx] = after;
-    return after - before;
+    const int before = stage(stat);
+    stageWord_ = addStagesClamped(stageWord_, deltaWordFor(stat, delta));
+    return stage(stat) - before;
 }
 
 int Buff::applyStageToStat(Stat stat, int base) const {
@@ -216,6 +215,9 @@ int Buff::applyStageToStat(Stat stat, int base) const {
     if (currentStage == 0 || base <= 0) {
         return base;
     }
+    if constexpr (DamageCalc::kFixedPoint) {
+        return DamageCalc::applyStageFixed(base, currentStage);
+    }
 
     const double factor = static_cast<double>(std::abs(currentStage)) / 2.0 + 1.0;
     const double scaled = currentStage > 0 ? base * factor : base / factor;
@@ -225,9 +227,9 @@ int Buff::applyStageToStat(Stat stat, int base) const {
 ControlTurnResult Buff::onTurnStart() {
     ControlTurnResult res;
 
-    switch (primary_) {
+    switch (primaryAilment()) {
         case Ailment::Sleep:
-            counter(Ailment::Sleep)++;
+            bumpCounter(Ailment::Sleep);
             res.skipAction = true;
             if (counter(Ailment::Sleep) >= 1 && roll(0.2)) {
                 clearPrimary();
@@ -236,7 +238,7 @@ ControlTurnResult Buff::onTurnStart() {
             }
             break;
         case Ailment::DeepSleep:
-            counter(Ailment::DeepSleep)++;
+            bumpCounter(Ailment::DeepSleep);
             res.skipAction = true;
             if (counter(Ailment::DeepSleep) >= 1 && roll(0.2)) {
                 clearPrimary();
@@ -245,33 +247,33 @@ ControlTurnResult Buff::onTurnStart() {
             }
             break;
         case Ailment::Fear:
-            counter(Ailment::Fear)++;
+            bumpCounter(Ailment::Fear);
             res.skipAction = true;
             if (counter(Ailment::Fear) >= 1 && (roll(0.4) || counter(Ailment::Fear) >= 4)) {
                 clearPrimary();
             }
             break;
         case Ailment::Freeze:
-            counter(Ailment::Freeze)++;
+            bumpCounter(Ailment::Freeze);
             res.skipAction = true;
             if (roll(0.2)) {
                 clearPrimary();
             }
             break;
         case Ailment::Bewitch:
-            counter(Ailment::Bewitch)++;
+            bumpCounter(Ailment::Bewitch);
             if (counter(Ailment::Bewitch) >= 1 && roll(0.5)) {
                 res.skipAction = true;
             }
             break;
         case Ailment::Paralysis:
-            counter(Ailment::Paralysis)++;
+            bumpCounter(Ailment::Paralysis);
             if (counter(Ailment::Paralysis) >= 1 && roll(0.5)) {
                 res.skipAction = true;
             }
             break;
         case Ailment::Confusion:
-            counter(Ailment::Confusion)++;
+            bumpCounter(Ailment::Confusion);
             if (counter(Ailment::Confusion) >= 1 && roll(0.4)) {
                 clearPrimary();
             } else if (counter(Ailment::Confusion) >= 4) {
@@ -286,7 +288,7 @@ ControlTurnResult Buff::onTurnStart() {
 }
 
 bool Buff::shouldRedirectConfusion() const {
-    if (primary_ != Ailment::Confusion) return false;
+    if (primaryAilment() != Ailment::Confusion) return false;
     return roll(0.5);
 }
 
@@ -297,17 +299,18 @@ void Buff::onPowerDamageTaken(const std::array<AttrType, 2>& attackerAttrs, bool
 
     const bool monoLight = attackerAttrs[0] == AttrType::Light && attackerAttrs[1] == AttrType::None;
 
-    if (primary_ == Ailment::Sleep && !monoLight) {
+    const Ailment primary = primaryAilment();
+    if (primary == Ailment::Sleep && !monoLight) {
         clearPrimary();
     }
 
-    if (primary_ == Ailment::Freeze) {
+    if (primary == Ailment::Freeze) {
         if (hasAttr(attackerAttrs, AttrType::Fire) || hasAttr(attackerAttrs, AttrType::dFire)) {
             clearPrimary();
         }
     }
 
-    if (primary_ == Ailment::Burn) {
+    if (primary == Ailment::Burn) {
         if (hasAttr(attackerAttrs, AttrType::Water) || hasAttr(attackerAttrs, AttrType::dWater)) {
             clearPrimary();
         }
@@ -316,17 +319,30 @@ void Buff::onPowerDamageTaken(const std::array<AttrType, 2>& attackerAttrs, bool
 
 void Buff::resetCounter(Ailment status) {
     if (status == Ailment::Toxic) {
-        toxicStacks_ = 0;
+        setToxicStacks(0);
+    }
+    if (const int shift = counterShift(status); shift >= 0) {
+        setField(shift, 0xFF, 0);
     }
-    counter(status) = 0;
 }
 
-int& Buff::counter(Ailment status) {
-    return ailmentTurns_[static_cast<std::size_t>(status)];
+int Buff::counterShift(Ailment status) {
+    if (isPrimaryGroup(status)) return kPrimaryTurnsShift;
+    if (isSecondaryGroup(status)) return kSecondaryTurnsShift;
+    return -1;
+}
+
+int Buff::counter(Ailment status) const {
+    const int shift = counterShift(status);
+    return shift >= 0 ? field(shift, 0xFF) : 0;
 }
 
-const int& Buff::counter(Ailment status) const {
-    return ailmentTurns_[static_cast<std::size_t>(status)];
+int Buff::bumpCounter(Ailment status) {
+    const int shift = counterShift(status);
+    if (shift < 0) return 0;
+    const int turns = std::min(field(shift, 0xFF) + 1, kMaxCounter);
+    setField(shift, 0xFF, turns);
+    return turns;
 }
 
 bool Buff::roll(double probability) const {
@@ -336,8 +352,7 @@ bool Buff::roll(double probability) const {
 }
 
 void Buff::applyParalysisSpeedDrop() {
-    const auto idx = static_cast<std::size_t>(Stat::Spe);
-    statStages_[idx] = clampStage(statStages_[idx] - 1);
+    forceStageDelta(Stat::Spe, -1);
 }
 
 void Buff::applyBurnAttackDrop() {
@@ -345,21 +360,21 @@ void Buff::applyBurnAttackDrop() {
 }
 
 void Buff::forceStageDelta(Stat stat, int delta) {
-    const auto idx = static_cast<std::size_t>(stat);
-    statStages_[idx] = clampStage(statStages_[idx] + delta);
+    stageWord_ = addStagesClamped(stageWord_, deltaWordFor(stat, delta));
 }
 
-void Buff::onEndTurnNonControl(Pet& self, Pet* opponent) {
+void Buff::onEndTurnNonControl(PetBattleState& self, PetBattleState* opponent) {
     auto damageCap = [](int dmg, int cap) { return (dmg > cap) ? cap : dmg; };
     const int maxHp = self.maxHP();
 
-    if (secondary_ == Ailment::Curse) {
+    const Ailment secondary = secondaryAilment();
+    if (secondary == Ailment::Curse) {
         const int dmg = damageCap(maxHp / 4, 500);
         self.takeDamage(dmg);
     }
 
-    if (secondary_ == Ailment::Parasite) {
-        counter(Ailment::Parasite)++;
+    if (secondary == Ailment::Parasite) {
+        bumpCounter(Ailment::Parasite);
         const int dmg = static_cast<int>(maxHp * 0.125);
         self.takeDamage(dmg);
         if (opponent) {
@@ -370,35 +385,36 @@ void Buff::onEndTurnNonControl(Pet& self, Pet* opponent) {
         }
     }
 
-    if (secondary_ == Ailment::Toxic) {
-        toxicStacks_++;
-        const double raw = maxHp * 0.0625 * static_cast<double>(toxicStacks_);
+    if (secondary == Ailment::Toxic) {
+        const int stacks = std::min(toxicStacks() + 1, kMaxCounter);
+        setToxicStacks(stacks);
+        const double raw = maxHp * 0.0625 * static_cast<double>(stacks);
         const int dmg = damageCap(static_cast<int>(raw), 500);
         self.takeDamage(dmg);
     }
 
-    if (secondary_ == Ailment::Poison) {
+    if (secondary == Ailment::Poison) {
         const int dmg = damageCap(static_cast<int>(maxHp * 0.125), 200);
         self.takeDamage(dmg);
     }
 
-    if (primary_ == Ailment::Burn) {
+    if (primaryAilment() == Ailment::Burn) {
         const int dmg = damageCap(static_cast<int>(maxHp * 0.125), 200);
         self.takeDamage(dmg);
     }
 }
 
+void Buff::onEndTurnNonControl(Pet& self, Pet* opponent) {
+    onEndTurnNonControl(self.battleState(), opponent ? &opponent->battleState() : nullptr);
+}
+
 void Buff::onSwitchOut() {
-    toxicStacks_ = 0;
-    if (secondary_ == Ailment::Curse) {
+    setToxicStacks(0);
+    if (secondaryAilment() == Ailment::Curse) {
         clearSecondary();
     }
 }
 
-void Buff::resetStages() {
-    statStages_.fill(0);
-}
-
 bool Buff::isPrimaryGroup(Ailment status) {
     switch (status) {
         case Ailment::Confusion:
@@ -427,12 +443,43 @@ bool Buff::isSecondaryGroup(Ailment status) {
     }
 }
 
-int Buff::clampStage(int value) const {
-    if (value < kMinStage) {
-        return kMinStage;
-    }
-    if (value > kMaxStage) {
-        return kMaxStage;
+std::uint64_t Buff::deltaWordFor(Stat stat, int delta) {
+    // 其余 lane 填 kDeltaBias，即增量 0。
+    const int clamped = std::clamp(delta, kMinStage - kMaxStage, kMaxStage - kMinStage);
+    const int shift = laneShift(stat);
+    const std::uint64_t neutral = kLaneOnes * kDeltaBias;
+    return (neutral & ~(kLaneMask << shift)) | (static_cast<std::uint64_t>(clamped + kDeltaBias) << shift);
+}
+
+std::uint64_t Buff::deltaWordFor(const std::array<int, kStatCount>& deltas) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < kStatCount; ++i) {
+        const int clamped = std::clamp(deltas[i], kMinStage - kMaxStage, kMaxStage - kMinStage);
+        word |= static_cast<std::uint64_t>(clamped + kDeltaBias) << laneShift(static_cast<Stat>(i));
     }
-    return value;
+    return word;
+}
+
+std::uint64_t Buff::addStagesClamped(std::uint64_t stageWord, std::uint64_t deltaWord) {
+    // 每条 lane：(stage+6) + (delta+16) ∈ [4, 40]，不会溢出到最高位，也不会向相邻 lane 进位。
+    const std::uint64_t sum = stageWord + deltaWord;
+    // 下限：sum >= 16 (即 stage >= -6)。借助每条 lane 的最高位做无借位比较。
+    constexpr std::uint64_t kLow = kLaneOnes * kDeltaBias;
+    const std::uint64_t geLow = (((sum | kLaneHigh) - kLow) & kLaneHigh) >> (kLaneBits - 1);
+    const std::uint64_t geLowMask = geLow * kLaneMask;
+    const std::uint64_t lowered = (sum & geLowMask) | (kLow & ~geLowMask);
+    // 上限：lowered <= 16 + 12 (即 stage <= +6)。
+    constexpr std::uint64_t kHigh = kLaneOnes * (kDeltaBias + kMaxStage - kMinStage);
+    const std::uint64_t gtHigh = (((lowered | kLaneHigh) - (kHigh + kLaneOnes)) & kLaneHigh) >> (kLaneBits - 1);
+    const std::uint64_t gtHighMask = gtHigh * kLaneMask;
+    const std::uint64_t clamped = (lowered & ~gtHighMask) | (kHigh & gtHighMask);
+    return clamped - kLow;
+}
+
+std::size_t Buff::hash() const {
+    // splitmix64 末端混合
+    std::uint64_t h = stageWord_ ^ (statusWord_ * 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<std::size_t>(h ^ (h >> 31));
 }
@@ -3,6 +3,8 @@
 #include <array>
 #include <cstdint>
 #include <cstddef>
+#include <functional>
+#include <type_traits>
 
 #include <entity/Attr.h>
 #include <entity/Stat.h>
@@ -45,6 +47,8 @@ struct ControlTurnResult {
 };
 
 // 记录战斗时宠物的异常状态与能力等级。
+// 全部状态压在两个 64 位字里：stageWord_ 存能力等级，statusWord_ 存异常/标记/计数，
+// 拷贝、比较、哈希都只是几次整数运算，适合搜索时大量克隆。
 class Buff {
   public:
     Buff();
@@ -55,12 +59,14 @@ class Buff {
     // 结合属性免疫 + 技能/组件免疫，忽略 respectImmunity 的旧语义。
     bool applyAilment(Ailment status, const std::array<AttrType, 2>& attrs, const ImmunityProfile& immunity = {});
     // 便捷接口：施加时处理即时效果（诅咒返伤、烧伤/麻醉首回合强化变更等）。
+    bool applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>& attrs, PetBattleState& self,
+                                 PetBattleState* opponent = nullptr, const ImmunityProfile& immunity = {});
     bool applyAilmentWithEffects(Ailment status, const std::array<AttrType, 2>& attrs, Pet& self,
                                  Pet* opponent = nullptr, const ImmunityProfile& immunity = {});
     // 控制异常与非控制异常
-    Ailment primaryAilment() const { return primary_; } // 互斥组：混乱/冰冻/恐惧/睡眠/沉睡/迷惑/麻醉/烧伤
-    Ailment secondaryAilment() const { return secondary_; } // 互斥组：中毒/剧毒/诅咒/寄生
-    bool isTrapped() const { return trapped_; }
+    Ailment primaryAilment() const { return static_cast<Ailment>(field(kPrimaryShift, 0xF)); } // 互斥组：混乱/冰冻/恐惧/睡眠/沉睡/迷惑/麻醉/烧伤
+    Ailment secondaryAilment() const { return static_cast<Ailment>(field(kSecondaryShift, 0xF)); } // 互斥组：中毒/剧毒/诅咒/寄生
+    bool isTrapped() const { return hasFlag(kTrapped); }
     bool hasAilment(Ailment status) const;
     void clearPrimary();
     void clearSecondary();
@@ -73,6 +79,7 @@ class Buff {
     // 受到威力伤害时的异常处理（解除睡眠/沉睡/冰冻等）。
     void onPowerDamageTaken(const std::array<AttrType, 2>& attackerAttrs, bool isPowerDamage = true);
     // 回合结束时处理非控制异常（固伤/治疗/计数清除等）。
+    void onEndTurnNonControl(PetBattleState& self, PetBattleState* opponent = nullptr);
     void onEndTurnNonControl(Pet& self, Pet* opponent = nullptr);
     // 换下时需要的状态维护（如诅咒解除、剧毒层数重置）。
     void onSwitchOut();
@@ -83,50 +90,116 @@ class Buff {
 
     // —— 其他标记 —— //
     // 双损
-    bool hasDoubleLoss() const { return doubleLoss_; }
-    void setDoubleLoss(bool enable = true) { doubleLoss_ = enable; }
-    void clearDoubleLoss() { doubleLoss_ = false; }
+    bool hasDoubleLoss() const { return hasFlag(kDoubleLoss); }
+    void setDoubleLoss(bool enable = true) { setFlag(kDoubleLoss, enable); }
+    void clearDoubleLoss() { setFlag(kDoubleLoss, false); }
 
     // 防踢
-    bool immuneToExpel() const { return immuneExpel_; }
-    void setImmuneToExpel(bool enable = true) { immuneExpel_ = enable; }
-    void clearImmuneToExpel() { immuneExpel_ = false; }
+    bool immuneToExpel() const { return hasFlag(kImmuneExpel); }
+    void setImmuneToExpel(bool enable = true) { setFlag(kImmuneExpel, enable); }
+    void clearImmuneToExpel() { setFlag(kImmuneExpel, false); }
 
     // 🔒强
-    bool stageLocked() const { return stageLocked_; }
-    void setStageLocked(bool enable = true) { stageLocked_ = enable; }
-    void clearStageLocked() { stageLocked_ = false; }
+    bool stageLocked() const { return hasFlag(kStageLocked); }
+    void setStageLocked(bool enable = true) { setFlag(kStageLocked, enable); }
+    void clearStageLocked() { setFlag(kStageLocked, false); }
 
     // —— 能力等级（-6 ~ +6） —— //
-    int stage(Stat stat) const { return statStages_[static_cast<std::size_t>(stat)]; }
+    int stage(Stat stat) const {
+        return static_cast<int>((stageWord_ >> laneShift(stat)) & kLaneMask) - kStageBias;
+    }
     int applyStageToStat(Stat stat, int base) const;
     int changeStage(Stat stat, int delta, const ImmunityProfile* immunity = nullptr);
-    void resetStages();
+    void resetStages() { stageWord_ = kNeutralStages; }
+
+    // —— 打包表示 —— //
+    std::uint64_t stageWord() const { return stageWord_; }
+    std::uint64_t statusWord() const { return statusWord_; }
+    std::size_t hash() const;
+    friend bool operator==(const Buff& a, const Buff& b) {
+        return a.stageWord_ == b.stageWord_ && a.statusWord_ == b.statusWord_;
+    }
+    friend bool operator!=(const Buff& a, const Buff& b) { return !(a == b); }
+
+    // SWAR：对 stageWord 的每条 lane 加上 deltaWord 对应 lane 的增量并截断到 [-6, +6]。
+    // deltaWord 每条 lane 存 delta + kDeltaBias（delta 需先截断到 [-12, 12]）。
+    static std::uint64_t addStagesClamped(std::uint64_t stageWord, std::uint64_t deltaWord);
+    static std::uint64_t deltaWordFor(Stat stat, int delta);
+    static std::uint64_t deltaWordFor(const std::array<int, kStatCount>& deltas);
 
   private:
     static constexpr int kMinStage = -6;
     static constexpr int kMaxStage = 6;
+    // 回合计数 / 剧毒层数用单字节存储，达到上限后饱和不再增长。
+    static constexpr int kMaxCounter = 0xFF;
+
+    // stageWord_：每个 Stat 占 7 位 lane，存 stage + 6（0..12）。9 条 lane 共 63 位；
+    // 多出的位数给 SWAR 加法留余量，lane 之间不会进位。
+    static constexpr int kLaneBits = 7;
+    static constexpr std::uint64_t kLaneMask = (1u << kLaneBits) - 1;
+    static constexpr int kStageBias = -kMinStage;
+    static constexpr int kDeltaBias = 16;
+    // 每条 lane 最低位为 1：∑ 2^(7i)，i ∈ [0, kStatCount)。
+    static constexpr std::uint64_t kLaneOnes = ((std::uint64_t{ 1 } << (kStatCount * kLaneBits)) - 1) / kLaneMask;
+    static constexpr std::uint64_t kLaneHigh = kLaneOnes << (kLaneBits - 1);
+    static constexpr std::uint64_t kNeutralStages = kLaneOnes * kStageBias;
+    static constexpr int laneShift(Stat stat) { return static_cast<int>(stat) * kLaneBits; }
+    static_assert(kStatCount * kLaneBits <= 64, "stage lanes must fit in one word");
+
+    // statusWord_ 位布局。
+    // 同一时刻只有当前主/副异常的回合计数可能非零（切换异常时都会清零），因此只需两个计数字段。
+    static constexpr int kPrimaryShift = 0;     // 4 位 Ailment
+    static constexpr int kSecondaryShift = 4;   // 4 位 Ailment
+    static constexpr int kFlagsShift = 8;       // 8 位 Flag
+    static constexpr int kToxicShift = 16;      // 8 位剧毒层数
+    static constexpr int kPrimaryTurnsShift = 24;   // 8 位主异常回合计数
+    static constexpr int kSecondaryTurnsShift = 32; // 8 位副异常回合计数
+    static_assert(static_cast<int>(Ailment::Count) <= 0xF, "Ailment must fit in 4 bits");
+
+    // 布尔标记压成一个字节。
+    enum Flag : std::uint8_t {
+        kTrapped = 1u << 0,
+        kDoubleLoss = 1u << 1,
+        kImmuneExpel = 1u << 2,
+        kStageLocked = 1u << 3,
+    };
+    int field(int shift, std::uint64_t mask) const { return static_cast<int>((statusWord_ >> shift) & mask); }
+    void setField(int shift, std::uint64_t mask, int value) {
+        statusWord_ = (statusWord_ & ~(mask << shift)) | ((static_cast<std::uint64_t>(value) & mask) << shift);
+    }
+    bool hasFlag(Flag flag) const { return (statusWord_ >> kFlagsShift) & flag; }
+    void setFlag(Flag flag, bool enable) {
+        const std::uint64_t bit = static_cast<std::uint64_t>(flag) << kFlagsShift;
+        statusWord_ = enable ? (statusWord_ | bit) : (statusWord_ & ~bit);
+    }
+    void setPrimary(Ailment status) { setField(kPrimaryShift, 0xF, static_cast<int>(status)); }
+    void setSecondary(Ailment status) { setField(kSecondaryShift, 0xF, static_cast<int>(status)); }
+    int toxicStacks() const { return field(kToxicShift, 0xFF); }
+    void setToxicStacks(int value) { setField(kToxicShift, 0xFF, value); }
+    // 回合计数所在字段；非主/副异常组返回 -1。
+    static int counterShift(Ailment status);
 
     static bool isPrimaryGroup(Ailment status);
     static bool isSecondaryGroup(Ailment status);
 
     void resetCounter(Ailment status);
-    int& counter(Ailment status);
-    const int& counter(Ailment status) const;
+    int counter(Ailment status) const;
+    // 计数 +1（饱和），返回新值。
+    int bumpCounter(Ailment status);
     bool roll(double probability) const;
     void applyParalysisSpeedDrop();
     void applyBurnAttackDrop();
     void forceStageDelta(Stat stat, int delta);
 
-    int clampStage(int value) const;
-
-    Ailment primary_;
-    Ailment secondary_;
-    bool trapped_;
-    bool doubleLoss_;
-    bool immuneExpel_;
-    bool stageLocked_;
-    std::array<int, static_cast<std::size_t>(Ailment::Count)> ailmentTurns_;
-    int toxicStacks_ = 0;
-    std::array<int, kStatCount> statStages_;
+    std::uint64_t stageWord_ = kNeutralStages;
+    std::uint64_t statusWord_ = 0;
 };
+
+static_assert(std::is_trivially_copyable_v<Buff>, "Buff should be cheap to clone");
+static_assert(sizeof(Buff) == 2 * sizeof(std::uint64_t), "Buff should pack into two words");
+
+namespace std {
+template <> struct hash<Buff> {
+    std::size_t operator()(const Buff& buff) const noexcept { return buff.hash(); }
+};
+} // namespace std
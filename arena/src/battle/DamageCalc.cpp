@@ -0,0 +1,93 @@
+#include "DamageCalc.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <rng/rng.h>
+
+namespace {
+int clampDamage(std::int64_t value) {
+    if (value < 0) return 0;
+    if (value > DamageCalc::kMaxDamage) return DamageCalc::kMaxDamage;
+    return static_cast<int>(value);
+}
+
+int safeDefense(int defense) {
+    return defense <= 0 ? 1 : defense;
+}
+} // namespace
+
+int DamageCalc::baseDamageFloat(const PowerDamageInput& in) {
+    const double level = in.level;
+    return static_cast<int>(((level * 0.4 + 2.0) * in.power * in.attack / safeDefense(in.defense)) / 50.0 + 2.0);
+}
+
+int DamageCalc::finalDamageFloat(const PowerDamageInput& in, int randFactor) {
+    if (in.power <= 0) return 0;
+    const int base = baseDamageFloat(in);
+    const double attrModifier = AttrChart::getAttrAdvantage(in.skillAttr, in.defenderAttrs);
+    const double finalDamage = base * attrModifier * static_cast<double>(randFactor) / 255.0;
+    return std::min(std::max(0, static_cast<int>(finalDamage)), kMaxDamage);
+}
+
+int DamageCalc::baseDamageFixed(const PowerDamageInput& in) {
+    // (level*0.4 + 2) * power * atk / def / 50 + 2  ==  (2*level + 10) * power * atk / (250 * def) + 2
+    const std::int64_t numer = (2LL * in.level + 10) * in.power * in.attack;
+    const std::int64_t denom = 250LL * safeDefense(in.defense);
+    return static_cast<int>(numer / denom + 2);
+}
+
+int DamageCalc::finalDamageFixed(const PowerDamageInput& in, int randFactor) {
+    if (in.power <= 0) return 0;
+    const std::int64_t base = baseDamageFixed(in);
+    const AttrRatio ratio = attrRatio(in.skillAttr, in.defenderAttrs);
+    return clampDamage(base * ratio.num * randFactor / (255LL * ratio.den));
+}
+
+int DamageCalc::rollRandFactor() {
+    if constexpr (kFixedPoint) {
+        return static_cast<int>(RNG::instance().rangePortable(kRandMin, kRandMax));
+    } else {
+        return RNG::instance().range<int>(kRandMin, kRandMax);
+    }
+}
+
+AttrRatio DamageCalc::attrRatio(AttrType atk, const std::array<AttrType, 2>& defs) {
+    // getAttrAdvantage 只会返回有限的几个常量，按值比对即可精确还原，不涉及浮点运算。
+    const double m = AttrChart::getAttrAdvantage(atk, defs);
+    if (m == 3.0) return { 3, 1 };
+    if (m == 2.0) return { 2, 1 };
+    if (m == 1.0 / 2.0) return { 1, 2 };
+    if (m == 1.0 / 3.0) return { 1, 3 };
+    return { 1, 1 };
+}
+
+int DamageCalc::applyStageFixed(int base, int stage) {
+    if (stage == 0 || base <= 0) return base;
+    if (stage > 0) {
+        return static_cast<int>(static_cast<std::int64_t>(base) * (stage + 2) / 2);
+    }
+    return static_cast<int>(static_cast<std::int64_t>(base) * 2 / (2 - stage));
+}
+
+DamageMultiplier DamageCalc::makeMultiplier(double multiplier) {
+    if constexpr (kFixedPoint) {
+        // 乘以 2^16 是精确运算，llround 的结果在所有平台上一致。
+        constexpr double kMax = static_cast<double>(std::numeric_limits<std::int32_t>::max());
+        constexpr double kMin = static_cast<double>(std::numeric_limits<std::int32_t>::min());
+        const double scaled = std::max(kMin, std::min(kMax, multiplier * kQ16One));
+        return static_cast<DamageMultiplier>(std::llround(scaled));
+    } else {
+        return static_cast<DamageMultiplier>(multiplier);
+    }
+}
+
+int DamageCalc::applyMultiplier(int amount, double multiplier) {
+    return static_cast<int>(static_cast<double>(amount) * multiplier);
+}
+
+int DamageCalc::applyMultiplier(int amount, std::int32_t multiplierQ16) {
+    return static_cast<int>(static_cast<std::int64_t>(amount) * multiplierQ16 / kQ16One);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <entity/Attr.h>
+
+// 伤害倍率的存储类型：默认沿用 double；开启 ROCOARENA_FIXED_POINT_DAMAGE 时改为 Q16 定点，
+// 保证不同编译器 / FMA 设置下回放结果逐位一致。
+#ifdef ROCOARENA_FIXED_POINT_DAMAGE
+using DamageMultiplier = std::int32_t;
+#else
+using DamageMultiplier = double;
+#endif
+
+// 属性克制倍率的精确有理数形式（3, 2, 1, 1/2, 1/3）。
+struct AttrRatio {
+    int num = 1;
+    int den = 1;
+};
+
+// 一次威力伤害计算所需的全部输入（已计入能力等级）。
+struct PowerDamageInput {
+    int level = 100;
+    int power = 0;
+    int attack = 0;
+    int defense = 1;
+    AttrType skillAttr = AttrType::None;
+    std::array<AttrType, 2> defenderAttrs{ AttrType::None, AttrType::None };
+};
+
+class DamageCalc {
+  public:
+    static constexpr int kRandMin = 217;
+    static constexpr int kRandMax = 255;
+    static constexpr int kMaxDamage = 99999;
+    static constexpr int kQ16Shift = 16;
+    static constexpr std::int32_t kQ16One = std::int32_t{ 1 } << kQ16Shift;
+
+#ifdef ROCOARENA_FIXED_POINT_DAMAGE
+    static constexpr bool kFixedPoint = true;
+    static constexpr DamageMultiplier kUnitMultiplier = kQ16One;
+#else
+    static constexpr bool kFixedPoint = false;
+    static constexpr DamageMultiplier kUnitMultiplier = 1.0;
+#endif
+
+    // 浮点实现：与历史版本逐行一致，作为对照基准。
+    static int baseDamageFloat(const PowerDamageInput& in);
+    static int finalDamageFloat(const PowerDamageInput& in, int randFactor);
+    // 整数实现：level*0.4+2 化为 (2*level+10)/5，属性倍率化为有理数，全程 int64。
+    static int baseDamageFixed(const PowerDamageInput& in);
+    static int finalDamageFixed(const PowerDamageInput& in, int randFactor);
+
+    // 按编译期开关选择的实现。
+    static int finalDamage(const PowerDamageInput& in, int randFactor) {
+        return kFixedPoint ? finalDamageFixed(in, randFactor) : finalDamageFloat(in, randFactor);
+    }
+    // 随机因子 [217, 255]；定点模式下使用与标准库实现无关的抽样。
+    static int rollRandFactor();
+
+    static AttrRatio attrRatio(AttrType atk, const std::array<AttrType, 2>& defs);
+
+    // 能力等级修正：正等级 base*(s+2)/2，负等级 base*2/(|s|+2)。与浮点截断结果一致。
+    static int applyStageFixed(int base, int stage);
+
+    // 伤害倍率：double 直接相乘截断；Q16 四舍五入换算后整数相乘。
+    static DamageMultiplier makeMultiplier(double multiplier);
+    static int applyMultiplier(int amount, double multiplier);
+    static int applyMultiplier(int amount, std::int32_t multiplierQ16);
+};
@@ -7,6 +7,7 @@
 #include <optional>
 
 #include <BattleSystem.h>
+#include <DamageCalc.h>
 #include <Attr.h>
 #include <logger/logger.h>
 #include <rng/rng.h>
@@ -17,27 +18,20 @@
 namespace {
 namespace fs = std::filesystem;
 
-int calculatePowerDamage(const SkillBase& skill, const Pet& attacker, const Pet& defender) {
+int calculatePowerDamage(const SkillBase& skill, const PetBattleState& attacker, const PetBattleState& defender) {
     if (skill.skillPower() <= 0) {
         return 0;
     }
 
     const bool isPhysical = skill.skillType() == SkillType::Physical;
-    const int effectiveAttack = isPhysical ? attacker.stagedAttack() : attacker.stagedSpecialAttack();
-    int effectiveDefense = isPhysical ? defender.stagedDefense() : defender.stagedSpecialDefense();
-    if (effectiveDefense <= 0) {
-        effectiveDefense = 1;
-    }
-
-    const double level = attacker.level();
-    const int base = static_cast<int>(
-        ((level * 0.4 + 2.0) * skill.skillPower() * effectiveAttack / effectiveDefense) / 50.0 + 2.0);
-    const double attrModifier = AttrChart::getAttrAdvantage(skill.skillAttr(), defender.attrs());
-    const int randFactor = RNG::instance().range<int>(217, 255);
-    const double finalDamage = base * attrModifier * static_cast<double>(randFactor) / 255.0;
-    const int roundedDamage = std::max(0, static_cast<int>(finalDamage));
-
-    return std::min(roundedDamage, 99999);
+    PowerDamageInput input;
+    input.level = attacker.level();
+    input.power = skill.skillPower();
+    input.attack = isPhysical ? attacker.stagedAttack() : attacker.stagedSpecialAttack();
+    input.defense = isPhysical ? defender.stagedDefense() : defender.stagedSpecialDefense();
+    input.skillAttr = skill.skillAttr();
+    input.defenderAttrs = defender.attrs();
+    return DamageCalc::finalDamage(input, DamageCalc::rollRandFactor());
 }
 
 std::string toLower(std::string value) {
@@ -170,8 +164,15 @@ void SkillAction::execute(BattleSystem& /*battle*/, Player& self, Player& oppone
         return;
     }
 
-    Pet& selfPet = self.activePet();
-    Pet& targetPet = opponent.activePet();
+    Pet* selfActive = self.activePetOrNull();
+    Pet* targetActive = opponent.activePetOrNull();
+    if (!selfActive || !targetActive) {
+        LOG_ERROR(module(), "SkillAction has no active pet on one side.");
+        return;
+    }
+    // 技能结算只读写战斗热数据。
+    PetBattleState& selfPet = selfActive->battleState();
+    PetBattleState& targetPet = targetActive->battleState();
 
     LOG_INFO(module(), "Executing skill [", skill_->id(), "] ", skill_->name(), " | priority=", skill_->skillPriority(),
              " | guaranteedHit=", (guaranteedHit() ? "true" : "false"));
@@ -192,7 +193,7 @@ void SkillAction::execute(BattleSystem& /*battle*/, Player& self, Player& oppone
         });
         scripter.registerFunction("deal_power_damage_scaled", [&](double scale) {
             const int base = calculatePowerDamage(*skill_, selfPet, targetPet);
-            targetPet.takeDamage(static_cast<int>(base * scale));
+            targetPet.takeDamage(DamageCalc::applyMultiplier(base, DamageCalc::makeMultiplier(scale)));
         });
         scripter.registerFunction("heal_self", [&](int amount) { selfPet.restoreHP(amount); });
         scripter.registerFunction("heal_target", [&](int amount) { targetPet.restoreHP(amount); });
@@ -343,7 +344,7 @@ void SkillAction::execute(BattleSystem& /*battle*/, Player& self, Player& oppone
         scripter.set("attacker_defense_base", selfPet.defense());
         scripter.set("attacker_sp_attack_base", selfPet.specialAttack());
         scripter.set("attacker_sp_defense_base", selfPet.specialDefense());
-        scripter.set("attacker_speed_base", selfPet.getRS().rSpe);
+        scripter.set("attacker_speed_base", selfPet.speed());
         scripter.set("target_hp", targetPet.currentHP());
         scripter.set("target_max_hp", targetPet.maxHP());
         scripter.set("target_level", targetPet.level());
@@ -358,7 +359,7 @@ void SkillAction::execute(BattleSystem& /*battle*/, Player& self, Player& oppone
         scripter.set("target_defense_base", targetPet.defense());
         scripter.set("target_sp_attack_base", targetPet.specialAttack());
         scripter.set("target_sp_defense_base", targetPet.specialDefense());
-        scripter.set("target_speed_base", targetPet.getRS().rSpe);
+        scripter.set("target_speed_base", targetPet.speed());
 
         auto assetsRoot = findAssetsRoot();
         fs::path resolvedScript = resolveAssetPath(scriptPath, assetsRoot);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist 键：按 (特征, 位置, 取值) 现算的 64 位伪随机数。
+// 用 splitmix64 派生而不是查表，HP 这类取值范围很大的特征也能按精确值入哈希。
+class Zobrist {
+  public:
+    enum class Feature : std::uint8_t {
+        Stats = 1,
+        HP,
+        LastDamage,
+        TurnDamage,
+        Skill,
+        PP,
+        DamageMultiplier,
+        DamageMultiplierTurns,
+        DamageImmunityTurns,
+        FlatDamageReduction,
+        PerHitDamageReduction,
+        PerHitReductionTurns,
+        Buff,
+        RosterSlot,
+        ActiveIndex,
+        Side,
+        TurnParity,
+        BattleEnded,
+    };
+
+    static constexpr std::uint64_t mix(std::uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // 取值先乘奇数常数打散再与 (特征, 位置) 组合，只需一次 mix。
+    static constexpr std::uint64_t key(Feature feature, std::uint64_t pos, std::uint64_t value) {
+        return mix(value * 0xD6E8FEB86659FD93ULL + ((static_cast<std::uint64_t>(feature) << 8 | pos) << 48));
+    }
+
+    // 把一个子状态的哈希绑定到某个位置上（非线性，交换两个位置的内容会得到不同结果）。
+    static constexpr std::uint64_t place(Feature feature, std::uint64_t pos, std::uint64_t hash) {
+        return mix(hash ^ key(feature, pos, 0));
+    }
+};
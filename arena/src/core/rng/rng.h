@@ -46,6 +46,19 @@ public:
         return dist(engine_);
     }
 
+    // 整数闭区间 [min, max]，只依赖引擎原始输出做拒绝采样，
+    // 不同标准库实现（libstdc++/libc++/MSVC）下结果一致，供确定性回放使用。
+    std::int64_t rangePortable(std::int64_t min, std::int64_t max) {
+        if (max <= min) return min;
+        const std::uint64_t span = static_cast<std::uint64_t>(max - min) + 1;
+        const std::uint64_t limit = Engine::max() - Engine::max() % span;
+        std::uint64_t draw = engine_();
+        while (draw >= limit) {
+            draw = engine_();
+        }
+        return min + static_cast<std::int64_t>(draw % span);
+    }
+
     // 实数闭区间 [min, max]。
     template <typename Real>
     Real rangeReal(Real min, Real max) {
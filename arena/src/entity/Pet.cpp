@@ -10,8 +10,8 @@
     就Stat吧！
 */
 void Pet::calcRealStat(BS bs, IVData ivs, EVData evs, NatureType ntype, int levelValue) {
-    level_ = levelValue;
-    const int level = level_;
+    const int level = levelValue;
+    RS rs{};
     //数组以索引
     std::array<int, 6> base = { bs.bEne, bs.bAtk, bs.bDef, bs.bSpA, bs.bSpD, bs.bSpe };
     std::array<int, 6> iv = { ivs.iEne, ivs.iAtk, ivs.iDef, ivs.iSpA, ivs.iSpD, ivs.iSpe };
@@ -34,31 +34,34 @@ void Pet::calcRealStat(BS bs, IVData ivs, EVData evs, NatureType ntype, int leve
         *r[nature.down] = int((*r[nature.down] * 0.9));
     }
 
-    currentHP_ = rs.rEne;
+    profile_.nature = nature;
+    state_.initStats(rs, level, profile_.species ? profile_.species->attrs()
+                                                 : std::array<AttrType, 2>{ AttrType::None, AttrType::None });
 }
 
 void Pet::setLearnableSkills(std::vector<int> skills) {
-    learnableSkillIds_ = std::move(skills);
+    profile_.learnableSkillIds = std::move(skills);
 }
 
-bool Pet::canLearn(int skillId) const {
-    return std::find(learnableSkillIds_.begin(), learnableSkillIds_.end(), skillId) != learnableSkillIds_.end();
+void Pet::resetForBattle(const Pet& prototype) {
+    if (this == &prototype) return;
+    state_ = prototype.state_;
+    profile_ = prototype.profile_; // member-wise: vector and string assignment keep their capacity
 }
 
-Pet::SkillSlot* Pet::findSlotById(int skillId) {
-    for (auto& slot : learnedSkills_) {
-        if (slot.has_value() && slot->base && slot->base->id() == skillId) {
-            return &slot.value();
-        }
-    }
-    return nullptr;
+bool Pet::canLearn(int skillId) const {
+    const auto& ids = profile_.learnableSkillIds;
+    return std::find(ids.begin(), ids.end(), skillId) != ids.end();
 }
 
-std::optional<std::size_t> Pet::firstEmptySlot() {
-    for (std::size_t i = 0; i < learnedSkills_.size(); ++i) {
-        if (!learnedSkills_[i].has_value()) return i;
+std::array<std::optional<Pet::SkillSlot>, Pet::kMaxSkillSlots> Pet::learnedSkills() const {
+    std::array<std::optional<SkillSlot>, kMaxSkillSlots> out{};
+    for (std::size_t i = 0; i < kMaxSkillSlots; ++i) {
+        if (const SkillBase* base = state_.skillAt(i)) {
+            out[i] = SkillSlot{ base, state_.ppAt(i) };
+        }
     }
-    return std::nullopt;
+    return out;
 }
 
 bool Pet::configureSkill(int skillId, const SkillRegistry& registry, int replaceSlotIndex) {
@@ -67,14 +70,13 @@ bool Pet::configureSkill(int skillId, const SkillRegistry& registry, int replace
     if (!base) return false;
 
     // If already learned, refresh PP and base pointer.
-    if (SkillSlot* existing = findSlotById(skillId)) {
-        existing->base = base;
-        existing->currentPP = base->skillMaxPP();
+    if (int existing = state_.findSlot(skillId); existing >= 0) {
+        state_.setSkill(static_cast<std::size_t>(existing), base);
         return true;
     }
 
-    if (auto empty = firstEmptySlot()) {
-        learnedSkills_[*empty] = SkillSlot{ base, base->skillMaxPP() };
+    if (int empty = state_.firstEmptySlot(); empty >= 0) {
+        state_.setSkill(static_cast<std::size_t>(empty), base);
         return true;
     }
 
@@ -82,123 +84,6 @@ bool Pet::configureSkill(int skillId, const SkillRegistry& registry, int replace
         return false; // Full and no valid replacement index.
     }
 
-    learnedSkills_[static_cast<std::size_t>(replaceSlotIndex)] = SkillSlot{ base, base->skillMaxPP() };
-    return true;
-}
-
-bool Pet::consumePP(int skillId, int amount) {
-    if (amount <= 0) return true;
-
-    // Double-loss mark adds 1 extra PP consumption per use.
-    if (buff_.hasDoubleLoss()) {
-        amount += 1;
-    }
-
-    SkillSlot* slot = findSlotById(skillId);
-    if (!slot) return false;
-    if (slot->currentPP < amount) return false;
-    slot->currentPP -= amount;
+    state_.setSkill(static_cast<std::size_t>(replaceSlotIndex), base);
     return true;
 }
-
-int Pet::takeDamage(int amount) {
-    if (amount <= 0) {
-        lastDamageTaken_ = 0;
-        return currentHP_;
-    }
-
-    if (damageImmunityTurns_ > 0) {
-        lastDamageTaken_ = 0;
-        return currentHP_;
-    }
-
-    double scaled = static_cast<double>(amount) * damageMultiplier_;
-    int reduced = static_cast<int>(scaled);
-    reduced = std::max(0, reduced - flatDamageReduction_);
-    if (perHitReductionTurns_ > 0) {
-        reduced = std::max(0, reduced - perHitDamageReduction_);
-    }
-
-    lastDamageTaken_ = reduced;
-    turnDamageTaken_ += reduced;
-    currentHP_ -= reduced;
-    if (currentHP_ < 0) currentHP_ = 0;
-    return currentHP_;
-}
-
-void Pet::restoreHP(int amount) {
-    if (amount <= 0) return;
-    currentHP_ += amount;
-    const int maxHp = maxHP();
-    if (currentHP_ > maxHp) currentHP_ = maxHp;
-}
-
-void Pet::setDamageMultiplier(double multiplier) {
-    if (multiplier < 0.0) {
-        multiplier = 0.0;
-    }
-    damageMultiplier_ = multiplier;
-}
-
-void Pet::setDamageMultiplierTurns(double multiplier, int turns) {
-    if (multiplier < 0.0) {
-        multiplier = 0.0;
-    }
-    if (turns < 0) {
-        turns = 0;
-    }
-    if (turns == 0) {
-        damageMultiplier_ = 1.0;
-        damageMultiplierTurns_ = 0;
-        return;
-    }
-    damageMultiplier_ = multiplier;
-    damageMultiplierTurns_ = turns;
-}
-
-void Pet::setDamageImmunityTurns(int turns) {
-    if (turns < 0) {
-        turns = 0;
-    }
-    damageImmunityTurns_ = turns;
-}
-
-void Pet::setFlatDamageReduction(int amount) {
-    if (amount < 0) {
-        amount = 0;
-    }
-    flatDamageReduction_ = amount;
-}
-
-void Pet::setPerHitDamageReduction(int amount, int turns) {
-    if (amount < 0) {
-        amount = 0;
-    }
-    if (turns < 0) {
-        turns = 0;
-    }
-    perHitDamageReduction_ = amount;
-    perHitReductionTurns_ = turns;
-}
-
-void Pet::tickDamageReductionTurn() {
-    if (perHitReductionTurns_ > 0) {
-        --perHitReductionTurns_;
-        if (perHitReductionTurns_ == 0) {
-            perHitDamageReduction_ = 0;
-        }
-    }
-    if (damageMultiplierTurns_ > 0) {
-        --damageMultiplierTurns_;
-        if (damageMultiplierTurns_ == 0) {
-            damageMultiplier_ = 1.0;
-        }
-    }
-    if (damageImmunityTurns_ > 0) {
-        --damageImmunityTurns_;
-    }
-}
-
-void Pet::resetTurnDamageTaken() {
-    turnDamageTaken_ = 0;
-}
@@ -4,102 +4,86 @@
 #include <string>
 #include <vector>
 
-#include <battle/Buff.h>
-
+#include "PetBattleState.h"
+#include "PetProfile.h"
 #include "Species.h"
 
 class SkillBase;
 class SkillRegistry;
 
+// 宠物实体：热数据 PetBattleState 与冷数据 PetProfile 分离存放。
+// BattleSystem / SkillAction 只通过 battleState() 访问热数据。
 class Pet {
   public:
     struct SkillSlot {
         const SkillBase* base = nullptr;
         int currentPP = 0;
     };
-    static constexpr std::size_t kMaxSkillSlots = 4;
+    static constexpr std::size_t kMaxSkillSlots = PetBattleState::kMaxSkillSlots;
 
     //构造与析构
-    Pet(Species* sp, IVData iv, EVData ev) : species(sp), ivs(iv), evs(ev){};
+    Pet(Species* sp, IVData iv, EVData ev) : profile_{ sp, iv, ev } {};
     ~Pet() = default;
 
+    PetBattleState& battleState() { return state_; }
+    const PetBattleState& battleState() const { return state_; }
+    const PetProfile& profile() const { return profile_; }
+
     //种族值和性格计算
     void calcRealStat(BS bs, IVData ivs, EVData evs, NatureType ntype, int levelValue = 100);
-    RS getRS() const { return rs; }
-    int level() const { return level_; }
-    int attack() const { return rs.rAtk; }
-    int defense() const { return rs.rDef; }
-    int specialAttack() const { return rs.rSpA; }
-    int specialDefense() const { return rs.rSpD; }
-    int stagedAttack() const { return buff_.applyStageToStat(Stat::Atk, rs.rAtk); }
-    int stagedDefense() const { return buff_.applyStageToStat(Stat::Def, rs.rDef); }
-    int stagedSpecialAttack() const { return buff_.applyStageToStat(Stat::SpA, rs.rSpA); }
-    int stagedSpecialDefense() const { return buff_.applyStageToStat(Stat::SpD, rs.rSpD); }
-    const std::array<AttrType, 2>& attrs() const { return species->attrs(); }
-    const std::string& name() const { return species->name(); }
-    int speciesId() const { return species->id(); }
-    Buff& buff() { return buff_; }
-    const Buff& buff() const { return buff_; }
+    RS getRS() const { return state_.stats(); }
+    int level() const { return state_.level(); }
+    int attack() const { return state_.attack(); }
+    int defense() const { return state_.defense(); }
+    int specialAttack() const { return state_.specialAttack(); }
+    int specialDefense() const { return state_.specialDefense(); }
+    int stagedAttack() const { return state_.stagedAttack(); }
+    int stagedDefense() const { return state_.stagedDefense(); }
+    int stagedSpecialAttack() const { return state_.stagedSpecialAttack(); }
+    int stagedSpecialDefense() const { return state_.stagedSpecialDefense(); }
+    const std::array<AttrType, 2>& attrs() const { return profile_.species->attrs(); }
+    const std::string& name() const { return profile_.species->name(); }
+    int speciesId() const { return profile_.species->id(); }
+    Buff& buff() { return state_.buff(); }
+    const Buff& buff() const { return state_.buff(); }
 
     // 属性与当前状态
-    int currentHP() const { return currentHP_; }
-    int maxHP() const { return rs.rEne; }
-    int currentSpeed() const { return buff_.applyStageToStat(Stat::Spe, rs.rSpe); }
-    bool isFainted() const { return currentHP_ <= 0; }
-    int lastDamageTaken() const { return lastDamageTaken_; }
-    int turnDamageTaken() const { return turnDamageTaken_; }
-    void setDamageMultiplier(double multiplier);
-    void setDamageMultiplierTurns(double multiplier, int turns);
-    void setDamageImmunityTurns(int turns);
-    void setFlatDamageReduction(int amount);
-    void setPerHitDamageReduction(int amount, int turns);
-    void tickDamageReductionTurn();
-    void resetTurnDamageTaken();
+    int currentHP() const { return state_.currentHP(); }
+    int maxHP() const { return state_.maxHP(); }
+    int currentSpeed() const { return state_.currentSpeed(); }
+    bool isFainted() const { return state_.isFainted(); }
+    int lastDamageTaken() const { return state_.lastDamageTaken(); }
+    int turnDamageTaken() const { return state_.turnDamageTaken(); }
+    void setDamageMultiplier(double multiplier) { state_.setDamageMultiplier(multiplier); }
+    void setDamageMultiplierTurns(double multiplier, int turns) { state_.setDamageMultiplierTurns(multiplier, turns); }
+    void setDamageImmunityTurns(int turns) { state_.setDamageImmunityTurns(turns); }
+    void setFlatDamageReduction(int amount) { state_.setFlatDamageReduction(amount); }
+    void setPerHitDamageReduction(int amount, int turns) { state_.setPerHitDamageReduction(amount, turns); }
+    void tickDamageReductionTurn() { state_.tickDamageReductionTurn(); }
+    void resetTurnDamageTaken() { state_.resetTurnDamageTaken(); }
 
     // 技能相关
-    const std::vector<int>& learnableSkills() const { return learnableSkillIds_; }
+    const std::vector<int>& learnableSkills() const { return profile_.learnableSkillIds; }
     void setLearnableSkills(std::vector<int> skills);
     bool canLearn(int skillId) const;
     // Add or replace a skill: if there is an empty slot, fill it; if full, replace the given slot.
     // When replacing, caller must provide a valid slot index (0-3).
     bool configureSkill(int skillId, const SkillRegistry& registry, int replaceSlotIndex = -1);
-    bool consumePP(int skillId, int amount = 1);
-    const std::array<std::optional<SkillSlot>, kMaxSkillSlots>& learnedSkills() const { return learnedSkills_; }
+    bool consumePP(int skillId, int amount = 1) { return state_.consumePP(skillId, amount); }
+    // 按槽位拷贝出的快照，便于展示；热路径请直接用 battleState().skillAt()/ppAt()。
+    std::array<std::optional<SkillSlot>, kMaxSkillSlots> learnedSkills() const;
 
     // 战斗数值更新
-    int takeDamage(int amount);
-    void restoreHP(int amount);
+    int takeDamage(int amount) { return state_.takeDamage(amount); }
+    void restoreHP(int amount) { state_.restoreHP(amount); }
 
-  private:
-    SkillSlot* findSlotById(int skillId);
-    std::optional<std::size_t> firstEmptySlot();
+    // Turns this pet back into a copy of `prototype` for a new battle, reusing its own storage
+    // (the learnable-skill buffer is only reallocated if it is too small).
+    void resetForBattle(const Pet& prototype);
 
-    //模板
-    const Species* species;
-    //天赋
-    IVData ivs;
-    //努力值
-    EVData evs;
-    //等级
-    int level_ = 100;
-    //性格
-    Nature nature{};
-    //计算出的实际数值
-    RS rs{};
-    // 当前血量
-    int currentHP_ = 0;
-    int lastDamageTaken_ = 0;
-    int turnDamageTaken_ = 0;
-    double damageMultiplier_ = 1.0;
-    int damageMultiplierTurns_ = 0;
-    int damageImmunityTurns_ = 0;
-    int flatDamageReduction_ = 0;
-    int perHitDamageReduction_ = 0;
-    int perHitReductionTurns_ = 0;
-    //战斗状态
-    Buff buff_{};
-
-    // 技能
-    std::vector<int> learnableSkillIds_{};
-    std::array<std::optional<SkillSlot>, kMaxSkillSlots> learnedSkills_{};
+  private:
+    //战斗热数据
+    PetBattleState state_{};
+    //个体冷数据
+    PetProfile profile_{};
 };
@@ -0,0 +1,214 @@
+#include "PetBattleState.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <skill/SkillBase.h>
+
+namespace {
+using Feature = Zobrist::Feature;
+
+std::uint64_t skillKey(const SkillBase* skill) {
+    return skill ? static_cast<std::uint64_t>(skill->id()) : 0;
+}
+} // namespace
+
+PetBattleState::PetBattleState() {
+    zobrist_ = fieldsHash();
+}
+
+void PetBattleState::initStats(const RS& rs, int level, const std::array<AttrType, 2>& attrs) {
+    stats_ = { rs.rEne, rs.rAtk, rs.rDef, rs.rSpA, rs.rSpD, rs.rSpe };
+    level_ = static_cast<std::uint16_t>(std::clamp(level, 0, static_cast<int>(std::numeric_limits<std::uint16_t>::max())));
+    attrs_ = { static_cast<std::uint8_t>(attrs[0]), static_cast<std::uint8_t>(attrs[1]) };
+    currentHP_ = rs.rEne;
+    zobrist_ = fieldsHash();
+}
+
+RS PetBattleState::stats() const {
+    RS rs;
+    rs.rEne = stats_[Ene];
+    rs.rAtk = stats_[Atk];
+    rs.rDef = stats_[Def];
+    rs.rSpA = stats_[SpA];
+    rs.rSpD = stats_[SpD];
+    rs.rSpe = stats_[Spe];
+    return rs;
+}
+
+int PetBattleState::findSlot(int skillId) const {
+    for (std::size_t i = 0; i < kMaxSkillSlots; ++i) {
+        if (skills_[i] && skills_[i]->id() == skillId) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int PetBattleState::firstEmptySlot() const {
+    for (std::size_t i = 0; i < kMaxSkillSlots; ++i) {
+        if (!skills_[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void PetBattleState::setSkill(std::size_t slot, const SkillBase* base) {
+    zobrist_ ^= Zobrist::key(Feature::Skill, slot, skillKey(skills_[slot])) ^
+                Zobrist::key(Feature::Skill, slot, skillKey(base));
+    skills_[slot] = base;
+    const int maxPP = base ? base->skillMaxPP() : 0;
+    setHashed(pp_[slot],
+              static_cast<std::int16_t>(std::clamp(maxPP, 0, static_cast<int>(std::numeric_limits<std::int16_t>::max()))),
+              Feature::PP, slot);
+}
+
+bool PetBattleState::consumePP(int skillId, int amount) {
+    if (amount <= 0) return true;
+
+    // Double-loss mark adds 1 extra PP consumption per use.
+    if (buff_.hasDoubleLoss()) {
+        amount += 1;
+    }
+
+    const int slot = findSlot(skillId);
+    if (slot < 0) return false;
+    const auto idx = static_cast<std::size_t>(slot);
+    if (pp_[idx] < amount) return false;
+    setHashed(pp_[idx], static_cast<std::int16_t>(pp_[idx] - amount), Feature::PP, idx);
+    return true;
+}
+
+int PetBattleState::takeDamage(int amount) {
+    if (amount <= 0) {
+        setHashed(lastDamageTaken_, 0, Feature::LastDamage);
+        return currentHP_;
+    }
+
+    if (damageImmunityTurns_ > 0) {
+        setHashed(lastDamageTaken_, 0, Feature::LastDamage);
+        return currentHP_;
+    }
+
+    int reduced = DamageCalc::applyMultiplier(amount, damageMultiplier_);
+    reduced = std::max(0, reduced - flatDamageReduction_);
+    if (perHitReductionTurns_ > 0) {
+        reduced = std::max(0, reduced - perHitDamageReduction_);
+    }
+
+    setHashed(lastDamageTaken_, reduced, Feature::LastDamage);
+    setHashed(turnDamageTaken_, turnDamageTaken_ + reduced, Feature::TurnDamage);
+    setHashed(currentHP_, std::max(0, currentHP_ - reduced), Feature::HP);
+    return currentHP_;
+}
+
+void PetBattleState::restoreHP(int amount) {
+    if (amount <= 0) return;
+    setHashed(currentHP_, std::min(currentHP_ + amount, maxHP()), Feature::HP);
+}
+
+void PetBattleState::resetTurnDamageTaken() {
+    setHashed(turnDamageTaken_, 0, Feature::TurnDamage);
+}
+
+std::uint8_t PetBattleState::clampTurns(int turns) {
+    return static_cast<std::uint8_t>(std::clamp(turns, 0, kMaxTurnCounter));
+}
+
+std::uint64_t PetBattleState::multiplierBits(DamageMultiplier multiplier) {
+    // double 模式按位取值；-0.0 与 0.0 在伤害上等价，统一成 0。
+    if (multiplier == DamageMultiplier{}) return 0;
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &multiplier, sizeof(multiplier));
+    return bits;
+}
+
+void PetBattleState::setMultiplier(DamageMultiplier multiplier) {
+    zobrist_ ^= Zobrist::key(Feature::DamageMultiplier, 0, multiplierBits(damageMultiplier_)) ^
+                Zobrist::key(Feature::DamageMultiplier, 0, multiplierBits(multiplier));
+    damageMultiplier_ = multiplier;
+}
+
+void PetBattleState::setDamageMultiplier(double multiplier) {
+    if (multiplier < 0.0) {
+        multiplier = 0.0;
+    }
+    setMultiplier(DamageCalc::makeMultiplier(multiplier));
+}
+
+void PetBattleState::setDamageMultiplierTurns(double multiplier, int turns) {
+    if (multiplier < 0.0) {
+        multiplier = 0.0;
+    }
+    if (turns <= 0) {
+        setMultiplier(DamageCalc::kUnitMultiplier);
+        setHashed(damageMultiplierTurns_, std::uint8_t{ 0 }, Feature::DamageMultiplierTurns);
+        return;
+    }
+    setMultiplier(DamageCalc::makeMultiplier(multiplier));
+    setHashed(damageMultiplierTurns_, clampTurns(turns), Feature::DamageMultiplierTurns);
+}
+
+void PetBattleState::setDamageImmunityTurns(int turns) {
+    setHashed(damageImmunityTurns_, clampTurns(turns), Feature::DamageImmunityTurns);
+}
+
+void PetBattleState::setFlatDamageReduction(int amount) {
+    if (amount < 0) {
+        amount = 0;
+    }
+    setHashed(flatDamageReduction_, amount, Feature::FlatDamageReduction);
+}
+
+void PetBattleState::setPerHitDamageReduction(int amount, int turns) {
+    if (amount < 0) {
+        amount = 0;
+    }
+    setHashed(perHitDamageReduction_, amount, Feature::PerHitDamageReduction);
+    setHashed(perHitReductionTurns_, clampTurns(turns), Feature::PerHitReductionTurns);
+}
+
+void PetBattleState::tickDamageReductionTurn() {
+    if (perHitReductionTurns_ > 0) {
+        setHashed(perHitReductionTurns_, static_cast<std::uint8_t>(perHitReductionTurns_ - 1),
+                  Feature::PerHitReductionTurns);
+        if (perHitReductionTurns_ == 0) {
+            setHashed(perHitDamageReduction_, 0, Feature::PerHitDamageReduction);
+        }
+    }
+    if (damageMultiplierTurns_ > 0) {
+        setHashed(damageMultiplierTurns_, static_cast<std::uint8_t>(damageMultiplierTurns_ - 1),
+                  Feature::DamageMultiplierTurns);
+        if (damageMultiplierTurns_ == 0) {
+            setMultiplier(DamageCalc::kUnitMultiplier);
+        }
+    }
+    if (damageImmunityTurns_ > 0) {
+        setHashed(damageImmunityTurns_, static_cast<std::uint8_t>(damageImmunityTurns_ - 1),
+                  Feature::DamageImmunityTurns);
+    }
+}
+
+std::uint64_t PetBattleState::fieldsHash() const {
+    std::uint64_t h = 0;
+    std::uint64_t statsHash = level_;
+    for (std::int32_t stat : stats_) statsHash = Zobrist::mix(statsHash ^ static_cast<std::uint32_t>(stat));
+    statsHash = Zobrist::mix(statsHash ^ (std::uint64_t{ attrs_[0] } << 8 | attrs_[1]));
+    h ^= Zobrist::key(Feature::Stats, 0, statsHash);
+    h ^= Zobrist::key(Feature::HP, 0, static_cast<std::uint64_t>(currentHP_));
+    h ^= Zobrist::key(Feature::LastDamage, 0, static_cast<std::uint64_t>(lastDamageTaken_));
+    h ^= Zobrist::key(Feature::TurnDamage, 0, static_cast<std::uint64_t>(turnDamageTaken_));
+    for (std::size_t i = 0; i < kMaxSkillSlots; ++i) {
+        h ^= Zobrist::key(Feature::Skill, i, skillKey(skills_[i]));
+        h ^= Zobrist::key(Feature::PP, i, static_cast<std::uint64_t>(pp_[i]));
+    }
+    h ^= Zobrist::key(Feature::DamageMultiplier, 0, multiplierBits(damageMultiplier_));
+    h ^= Zobrist::key(Feature::DamageMultiplierTurns, 0, damageMultiplierTurns_);
+    h ^= Zobrist::key(Feature::DamageImmunityTurns, 0, damageImmunityTurns_);
+    h ^= Zobrist::key(Feature::FlatDamageReduction, 0, static_cast<std::uint64_t>(flatDamageReduction_));
+    h ^= Zobrist::key(Feature::PerHitDamageReduction, 0, static_cast<std::uint64_t>(perHitDamageReduction_));
+    h ^= Zobrist::key(Feature::PerHitReductionTurns, 0, perHitReductionTurns_);
+    return h;
+}
+
+std::uint64_t PetBattleState::zobristFromScratch() const {
+    return fieldsHash() ^ Zobrist::key(Feature::Buff, 0, buff_.hash());
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <battle/Buff.h>
+#include <battle/DamageCalc.h>
+#include <battle/Zobrist.h>
+
+#include "Attr.h"
+#include "RealStatus.h"
+
+class SkillBase;
+
+// 战斗热数据：HP、伤害修正、Buff、技能与 PP 等每回合都会读写的字段。
+// 整体压在两条 cache line 内；个体值、性格、可学技能表等冷数据见 PetProfile。
+class alignas(64) PetBattleState {
+  public:
+    static constexpr std::size_t kMaxSkillSlots = 4;
+    static constexpr int kMaxTurnCounter = 0xFF;
+
+    PetBattleState();
+
+    // 由 Pet::calcRealStat 写入实际数值，并把当前血量回满。
+    void initStats(const RS& rs, int level, const std::array<AttrType, 2>& attrs);
+
+    // —— 数值 —— //
+    int level() const { return level_; }
+    RS stats() const;
+    int attack() const { return stats_[Atk]; }
+    int defense() const { return stats_[Def]; }
+    int specialAttack() const { return stats_[SpA]; }
+    int specialDefense() const { return stats_[SpD]; }
+    int speed() const { return stats_[Spe]; }
+    int stagedAttack() const { return buff_.applyStageToStat(Stat::Atk, stats_[Atk]); }
+    int stagedDefense() const { return buff_.applyStageToStat(Stat::Def, stats_[Def]); }
+    int stagedSpecialAttack() const { return buff_.applyStageToStat(Stat::SpA, stats_[SpA]); }
+    int stagedSpecialDefense() const { return buff_.applyStageToStat(Stat::SpD, stats_[SpD]); }
+    int currentSpeed() const { return buff_.applyStageToStat(Stat::Spe, stats_[Spe]); }
+    std::array<AttrType, 2> attrs() const {
+        return { static_cast<AttrType>(attrs_[0]), static_cast<AttrType>(attrs_[1]) };
+    }
+    Buff& buff() { return buff_; }
+    const Buff& buff() const { return buff_; }
+
+    // —— 血量与伤害修正 —— //
+    int currentHP() const { return currentHP_; }
+    int maxHP() const { return stats_[Ene]; }
+    bool isFainted() const { return currentHP_ <= 0; }
+    int lastDamageTaken() const { return lastDamageTaken_; }
+    int turnDamageTaken() const { return turnDamageTaken_; }
+    int takeDamage(int amount);
+    void restoreHP(int amount);
+    // 回合数超过 kMaxTurnCounter 时按上限截断（等同于“持续整场”）。
+    void setDamageMultiplier(double multiplier);
+    void setDamageMultiplierTurns(double multiplier, int turns);
+    void setDamageImmunityTurns(int turns);
+    void setFlatDamageReduction(int amount);
+    void setPerHitDamageReduction(int amount, int turns);
+    void tickDamageReductionTurn();
+    void resetTurnDamageTaken();
+
+    // —— 技能槽 —— //
+    // 空槽的技能指针为 nullptr。
+    const SkillBase* skillAt(std::size_t slot) const { return skills_[slot]; }
+    int ppAt(std::size_t slot) const { return pp_[slot]; }
+    int findSlot(int skillId) const;
+    int firstEmptySlot() const;
+    // 写入技能并回满 PP。
+    void setSkill(std::size_t slot, const SkillBase* base);
+    bool consumePP(int skillId, int amount = 1);
+
+    // —— Zobrist 哈希 —— //
+    // HP、PP、技能与伤害修正在各自的修改函数里增量维护；Buff 只有两个字，查询时直接并入。
+    std::uint64_t zobrist() const { return zobrist_ ^ Zobrist::key(Zobrist::Feature::Buff, 0, buff_.hash()); }
+    // 从头重算，用于校验增量维护的结果。
+    std::uint64_t zobristFromScratch() const;
+
+  private:
+    static std::uint8_t clampTurns(int turns);
+    static std::uint64_t multiplierBits(DamageMultiplier multiplier);
+    std::uint64_t fieldsHash() const;
+    template <typename T> void setHashed(T& field, T value, Zobrist::Feature feature, std::uint64_t pos = 0) {
+        if (field == value) return;
+        zobrist_ ^= Zobrist::key(feature, pos, static_cast<std::uint64_t>(field)) ^
+                    Zobrist::key(feature, pos, static_cast<std::uint64_t>(value));
+        field = value;
+    }
+    void setMultiplier(DamageMultiplier multiplier);
+
+    // 按对齐从大到小排列，避免填充字节。
+    std::array<const SkillBase*, kMaxSkillSlots> skills_{};
+    DamageMultiplier damageMultiplier_ = DamageCalc::kUnitMultiplier;
+    Buff buff_{};
+    std::uint64_t zobrist_ = 0;
+    std::array<std::int32_t, 6> stats_{}; // 按 Stat 的 Ene..Spe 索引
+    std::int32_t currentHP_ = 0;
+    std::int32_t lastDamageTaken_ = 0;
+    std::int32_t turnDamageTaken_ = 0;
+    std::int32_t flatDamageReduction_ = 0;
+    std::int32_t perHitDamageReduction_ = 0;
+    std::array<std::int16_t, kMaxSkillSlots> pp_{};
+    std::uint16_t level_ = 100;
+    std::uint8_t damageMultiplierTurns_ = 0;
+    std::uint8_t damageImmunityTurns_ = 0;
+    std::uint8_t perHitReductionTurns_ = 0;
+    std::array<std::uint8_t, 2> attrs_{ static_cast<std::uint8_t>(AttrType::None),
+                                        static_cast<std::uint8_t>(AttrType::None) };
+};
+
+static_assert(sizeof(PetBattleState) <= 128, "PetBattleState should fit in two cache lines");
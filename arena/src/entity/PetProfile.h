@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "EVData.h"
+#include "IVData.h"
+#include "Nature.h"
+
+class Species;
+
+// 宠物个体的冷数据：建档/配招时使用，战斗回合中不会访问。
+struct PetProfile {
+    //模板
+    const Species* species = nullptr;
+    //天赋
+    IVData ivs{};
+    //努力值
+    EVData evs{};
+    //性格
+    Nature nature{};
+    //可学技能
+    std::vector<int> learnableSkillIds{};
+};
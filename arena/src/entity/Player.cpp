@@ -1,5 +1,6 @@
 #include "Player.h"
 
+#include <battle/Zobrist.h>
 #include <logger/logger.h>
 
 #include <Pet.h>
@@ -11,23 +12,32 @@ Player::Player(Roster pets, std::size_t activeIndex) : pets_(pets) {
         LOG_WARN("Player", "Initial active index invalid; auto-switching to first usable slot ", idx);
         activeIndex_ = idx;
     } else {
-        LOG_ERROR("Player", "No usable pets provided; active slot remains empty.");
+        // 全员倒下时仍指向某个非空槽位，保证 activePetOrNull() 只在阵容为空时返回 nullptr。
         activeIndex_ = 0;
+        for (std::size_t i = 0; i < kMaxPets; ++i) {
+            if (pets_[i]) {
+                activeIndex_ = i;
+                break;
+            }
+        }
+        if (!pets_[activeIndex_]) {
+            LOG_ERROR("Player", "No usable pets provided; active slot remains empty.");
+        }
     }
 }
 
 Pet& Player::activePet() {
-    if (!pets_[activeIndex_]) {
-        throw std::runtime_error("Active pet is null");
+    if (Pet* pet = activePetOrNull()) {
+        return *pet;
     }
-    return *pets_[activeIndex_];
+    throw std::runtime_error("Active pet is null");
 }
 
 const Pet& Player::activePet() const {
-    if (!pets_[activeIndex_]) {
-        throw std::runtime_error("Active pet is null");
+    if (const Pet* pet = activePetOrNull()) {
+        return *pet;
     }
-    return *pets_[activeIndex_];
+    throw std::runtime_error("Active pet is null");
 }
 
 bool Player::ensureActiveUsable() {
@@ -73,6 +83,16 @@ bool Player::hasUsablePets() const {
     return false;
 }
 
+std::uint64_t Player::stateHash() const {
+    std::uint64_t h = Zobrist::key(Zobrist::Feature::ActiveIndex, 0, activeIndex_);
+    for (std::size_t i = 0; i < kMaxPets; ++i) {
+        if (pets_[i]) {
+            h ^= Zobrist::place(Zobrist::Feature::RosterSlot, i, pets_[i]->battleState().zobrist());
+        }
+    }
+    return h;
+}
+
 bool Player::isValidIndex(std::size_t index) const {
     return index < kMaxPets;
 }
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 
 #include <forward.h>
@@ -14,8 +15,13 @@ class Player {
 
     Player(Roster pets, std::size_t activeIndex = 0);
 
+    // 出战位为空时抛 std::runtime_error；热路径请用 activePetOrNull()。
     Pet& activePet();
     const Pet& activePet() const;
+    // 不抛异常的访问。阵容不变式：activeIndex_ 总是指向非空槽位，
+    // 除非整个阵容为空——只有这种情况下返回 nullptr。
+    Pet* activePetOrNull() { return pets_[activeIndex_]; }
+    const Pet* activePetOrNull() const { return pets_[activeIndex_]; }
 
     bool ensureActiveUsable();
     std::size_t activeIndex() const { return activeIndex_; }
@@ -23,6 +29,9 @@ class Player {
     bool switchTo(std::size_t index);
     bool hasUsablePets() const;
 
+    // 当前出战位 + 各槽位宠物的 Zobrist 哈希（槽位参与混合，交换两只宠物会改变结果）。
+    std::uint64_t stateHash() const;
+
   private:
     bool isValidIndex(std::size_t index) const;
     std::size_t findFirstUsableIndex() const;
@@ -8,6 +8,7 @@ class Buff;
 
 // entity
 class Pet;
+class PetBattleState;
 class AttrChart;
 class Player;
 
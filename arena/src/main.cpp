@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -10,6 +11,8 @@ void printUsage(const char* argv0) {
     std::cout << "Usage:\n";
     std::cout << "  " << argv0 << " local [--pets <db>] [--skills <dir>]\n";
     std::cout << "  " << argv0 << " server --port <port> [--pets <db>] [--skills <dir>]\n";
+    std::cout << "         [--workers <n>] [--max-connections <n>] [--backlog <n>] [--read-timeout-ms <ms>]\n";
+    std::cout << "         [--max-request-bytes <n>] [--max-queued <n>]   (0 lifts a limit)\n";
     std::cout << "  " << argv0 << " client --host <host> --port <port>\n";
 }
 
@@ -43,6 +46,7 @@ int main(int argc, char** argv) {
 
     if (mode == "server") {
         int port = 8080;
+        HttpServerOptions options;
         for (int i = 2; i < argc; ++i) {
             std::string arg = argv[i];
             if (arg == "--port") {
@@ -51,9 +55,21 @@ int main(int argc, char** argv) {
                 petsDb = getArg(i, argc, argv);
             } else if (arg == "--skills") {
                 skillsDir = getArg(i, argc, argv);
+            } else if (arg == "--workers") {
+                options.workerThreads = std::stoul(getArg(i, argc, argv));
+            } else if (arg == "--max-connections") {
+                options.maxConnections = std::stoul(getArg(i, argc, argv));
+            } else if (arg == "--backlog") {
+                options.acceptBacklog = std::stoi(getArg(i, argc, argv));
+            } else if (arg == "--read-timeout-ms") {
+                options.readTimeout = std::chrono::milliseconds(std::stol(getArg(i, argc, argv)));
+            } else if (arg == "--max-request-bytes") {
+                options.maxRequestBytes = std::stoul(getArg(i, argc, argv));
+            } else if (arg == "--max-queued") {
+                options.maxQueuedRequests = std::stoul(getArg(i, argc, argv));
             }
         }
-        return runServer(port, petsDb, skillsDir);
+        return runServer(port, petsDb, skillsDir, options);
     }
 
     if (mode == "client") {
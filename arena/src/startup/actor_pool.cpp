@@ -0,0 +1,62 @@
+#include "actor_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+ActorPool::ActorPool(std::size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+}
+
+ActorPool::~ActorPool() {
+    stop();
+}
+
+void ActorPool::start() {
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (worker->running) continue;
+        worker->running = true;
+        worker->thread = std::thread(&ActorPool::run, std::ref(*worker));
+    }
+}
+
+void ActorPool::stop() {
+    for (auto& worker : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            if (!worker->running) continue;
+            worker->running = false;
+        }
+        worker->wake.notify_one();
+        worker->thread.join();
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.clear();
+    }
+}
+
+void ActorPool::post(std::uint64_t key, Task task) {
+    Worker& worker = *workers_[key % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    worker.wake.notify_one();
+}
+
+// Takes everything queued at once and runs it without the worker's lock held, so tasks may post
+// more work (for their own key or any other).
+void ActorPool::run(Worker& worker) {
+    std::deque<Task> batch;
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (true) {
+        worker.wake.wait(lock, [&worker] { return !worker.running || !worker.tasks.empty(); });
+        if (!worker.running) return;
+        batch.swap(worker.tasks);
+        lock.unlock();
+        for (auto& task : batch) task();
+        batch.clear();
+        lock.lock();
+    }
+}
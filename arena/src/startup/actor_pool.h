@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads that each own a share of the keys posted to them: every task for a key runs on
+// the same worker, one at a time and in the order posted, while tasks for keys owned by different
+// workers run in parallel. The server keys rooms by id, so each room behaves like an actor whose
+// ticks and actions never overlap. Thread-safe.
+class ActorPool {
+  public:
+    using Task = std::function<void()>;
+
+    // 0 threads = std::thread::hardware_concurrency().
+    explicit ActorPool(std::size_t threads = 0);
+    ~ActorPool();
+
+    ActorPool(const ActorPool&) = delete;
+    ActorPool& operator=(const ActorPool&) = delete;
+
+    void start();
+    // Joins the workers; tasks still queued are dropped without running.
+    void stop();
+
+    void post(std::uint64_t key, Task task);
+
+    std::size_t size() const { return workers_.size(); }
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Task> tasks;
+        bool running = false;
+        std::thread thread;
+    };
+
+    static void run(Worker& worker);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
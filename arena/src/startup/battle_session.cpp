@@ -9,41 +9,85 @@ namespace {
 constexpr std::chrono::seconds kForceSwitchTimeout{10};
 constexpr std::chrono::seconds kChooseActionTimeout{10};
 
-std::vector<std::size_t> usableIndices(const std::vector<std::unique_ptr<Pet>>& roster) {
-    std::vector<std::size_t> out;
-    for (std::size_t i = 0; i < roster.size(); ++i) {
+// Fills `out` with the slots holding a pet that can still fight; returns how many.
+std::size_t usableIndices(const std::vector<std::unique_ptr<Pet>>& roster,
+                          std::array<std::size_t, Player::kMaxPets>& out) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < roster.size() && i < Player::kMaxPets; ++i) {
         if (roster[i] && !roster[i]->isFainted()) {
-            out.push_back(i);
+            out[count++] = i;
         }
     }
-    return out;
+    return count;
+}
+
+Player::Roster seatRoster(const std::vector<std::unique_ptr<Pet>>& pets) {
+    Player::Roster roster{};
+    roster.fill(nullptr);
+    for (std::size_t i = 0; i < pets.size() && i < Player::kMaxPets; ++i) {
+        roster[i] = pets[i].get();
+    }
+    return roster;
+}
+
+// Makes `pets` a copy of the prototypes, resetting the pets it already has instead of replacing them.
+void refillRoster(std::vector<std::unique_ptr<Pet>>& pets, const BattleSession::PrototypeRoster& prototypes) {
+    std::size_t count = 0;
+    for (const Pet* prototype : prototypes) {
+        if (!prototype) continue;
+        if (count < pets.size() && pets[count]) {
+            pets[count]->resetForBattle(*prototype);
+        } else if (count < pets.size()) {
+            pets[count] = std::make_unique<Pet>(*prototype);
+        } else {
+            pets.push_back(std::make_unique<Pet>(*prototype));
+        }
+        ++count;
+    }
+    pets.resize(count);
+}
+
+std::vector<std::unique_ptr<Pet>> copyRoster(const BattleSession::PrototypeRoster& prototypes) {
+    std::vector<std::unique_ptr<Pet>> pets;
+    pets.reserve(Player::kMaxPets);
+    refillRoster(pets, prototypes);
+    return pets;
 }
 } // namespace
 
 BattleSession::BattleSession(std::vector<std::unique_ptr<Pet>> roster1, std::vector<std::unique_ptr<Pet>> roster2,
                              const SkillRegistry& registry)
     : roster1_(std::move(roster1)), roster2_(std::move(roster2)),
-      player1_([&]() {
-          Player::Roster roster{};
-          roster.fill(nullptr);
-          for (std::size_t i = 0; i < roster1_.size() && i < Player::kMaxPets; ++i) {
-              roster[i] = roster1_[i].get();
-          }
-          return roster;
-      }()),
-      player2_([&]() {
-          Player::Roster roster{};
-          roster.fill(nullptr);
-          for (std::size_t i = 0; i < roster2_.size() && i < Player::kMaxPets; ++i) {
-              roster[i] = roster2_[i].get();
-          }
-          return roster;
-      }()),
-      registry_(&registry) {
+      player1_(seatRoster(roster1_)), player2_(seatRoster(roster2_)), registry_(&registry) {
     battle_.init(player1_, player2_);
     forcePending_.fill(false);
 }
 
+BattleSession::BattleSession(const PrototypeRoster& roster1, const PrototypeRoster& roster2,
+                             const SkillRegistry& registry)
+    : BattleSession(copyRoster(roster1), copyRoster(roster2), registry) {}
+
+void BattleSession::reset(const PrototypeRoster& roster1, const PrototypeRoster& roster2,
+                          const SkillRegistry& registry) {
+    refillRoster(roster1_, roster1);
+    refillRoster(roster2_, roster2);
+    player1_ = Player(seatRoster(roster1_));
+    player2_ = Player(seatRoster(roster2_));
+    registry_ = &registry;
+    battle_.init(player1_, player2_);
+
+    actions_.fill(std::nullopt);
+    forcePending_.fill(false);
+    forceDeadline_.fill(Clock::time_point{});
+    turnDeadline_.reset();
+    lastFlee_.reset();
+    lastResolved_.reset();
+    outcome_.ended = false;
+    outcome_.winner = 0;
+    outcome_.reason.clear(); // keeps its buffer for the next battle's end reason
+    stateVersion_ = 1;
+}
+
 PendingType BattleSession::pendingForPlayer(int index) const {
     if (outcome_.ended) return PendingType::BattleOver;
     if (index < 0 || index > 1) return PendingType::BattleOver;
@@ -55,11 +99,8 @@ PendingType BattleSession::pendingForPlayer(int index) const {
 bool BattleSession::needsForceSwitch(int index) const {
     const Player& player = (index == 0) ? player1_ : player2_;
     if (!player.hasUsablePets()) return false;
-    try {
-        return player.activePet().isFainted();
-    } catch (...) {
-        return false;
-    }
+    const Pet* pet = player.activePetOrNull();
+    return pet && pet->isFainted();
 }
 
 void BattleSession::scheduleForceSwitch(int index) {
@@ -104,15 +145,8 @@ bool BattleSession::validateAction(int index, const ActionData& action, std::str
     }
 
     if (action.type == ActionType::Skill) {
-        const Pet& pet = player.activePet();
-        bool canUse = false;
-        for (const auto& slot : pet.learnedSkills()) {
-            if (slot.has_value() && slot->base && slot->base->id() == action.skillId) {
-                canUse = true;
-                break;
-            }
-        }
-        if (!canUse) {
+        const Pet* pet = player.activePetOrNull();
+        if (!pet || pet->battleState().findSlot(action.skillId) < 0) {
             if (error) *error = "skill not learned";
             return false;
         }
@@ -150,63 +184,70 @@ bool BattleSession::submitAction(int index, const ActionData& action, std::strin
         }
         forcePending_[index] = false;
         actions_[index].reset();
+        bumpVersion();
         return true;
     }
 
     if (!validateAction(index, action, error)) return false;
     actions_[index] = action;
+    bumpVersion();
     return true;
 }
 
-std::unique_ptr<Action> BattleSession::buildAction(const ActionData& action) const {
+Action& BattleSession::buildAction(const ActionData& action, ActionStorage& storage) const {
     switch (action.type) {
         case ActionType::Skill: {
             const SkillBase* skill = registry_->get(action.skillId);
             if (!skill) {
-                return std::make_unique<StayAction>();
+                return storage.emplace<StayAction>();
             }
-            return std::make_unique<SkillAction>(*skill);
+            return storage.emplace<SkillAction>(*skill);
         }
         case ActionType::Switch:
-            return std::make_unique<SwitchAction>(action.switchIndex);
+            return storage.emplace<SwitchAction>(action.switchIndex);
         case ActionType::Flee:
-            return std::make_unique<FleeAction>();
+            return storage.emplace<FleeAction>();
         case ActionType::Stay:
         default:
-            return std::make_unique<StayAction>();
+            return storage.emplace<StayAction>();
     }
 }
 
 void BattleSession::applyRandomSwitch(int index) {
-    auto indices = usableIndices(index == 0 ? roster1_ : roster2_);
-    if (indices.empty()) return;
-    std::uniform_int_distribution<std::size_t> dist(0, indices.size() - 1);
+    std::array<std::size_t, Player::kMaxPets> indices{};
+    const std::size_t count = usableIndices(index == 0 ? roster1_ : roster2_, indices);
+    if (count == 0) return;
+    std::uniform_int_distribution<std::size_t> dist(0, count - 1);
     std::size_t pick = indices[dist(rng_)];
 
     Player& player = (index == 0) ? player1_ : player2_;
     if (player.switchTo(pick)) {
         forcePending_[index] = false;
         actions_[index].reset();
+        bumpVersion();
     }
 }
 
 ActionData BattleSession::buildRandomSkillAction(int index) const {
     const Player& player = (index == 0) ? player1_ : player2_;
-    std::vector<int> skills;
-    try {
-        for (const auto& slot : player.activePet().learnedSkills()) {
-            if (slot.has_value() && slot->base) {
-                skills.push_back(slot->base->id());
-            }
-        }
-    } catch (...) {
+    const Pet* pet = player.activePetOrNull();
+    if (!pet) {
         return ActionData{ ActionType::Stay, 0, 0 };
     }
 
-    if (skills.empty()) {
+    std::array<int, PetBattleState::kMaxSkillSlots> skills{};
+    std::size_t count = 0;
+    const PetBattleState& state = pet->battleState();
+    for (std::size_t i = 0; i < PetBattleState::kMaxSkillSlots; ++i) {
+        if (const SkillBase* base = state.skillAt(i)) {
+            skills[count++] = base->id();
+        }
+    }
+
+    if (count == 0) {
         return ActionData{ ActionType::Stay, 0, 0 };
     }
-    std::uniform_int_distribution<std::size_t> dist(0, skills.size() - 1);
+    std::uniform_int_distribution<std::size_t> dist(0, count - 1);
     return ActionData{ ActionType::Skill, skills[dist(rng_)], 0 };
 }
 
@@ -214,6 +255,7 @@ void BattleSession::applyRandomSkill(int index) {
     if (actions_[index].has_value()) return;
     ActionData action = buildRandomSkillAction(index);
     actions_[index] = action;
+    bumpVersion();
     if (action.type == ActionType::Skill) {
         LOG_INFO("BattleSession", "Action timeout: auto skill for player ", index + 1, " skillId=", action.skillId);
     } else {
@@ -230,11 +272,11 @@ void BattleSession::resolveTurn() {
     if (a1.type == ActionType::Flee) lastFlee_ = 0;
     if (a2.type == ActionType::Flee) lastFlee_ = 1;
 
-    auto act1 = buildAction(a1);
-    auto act2 = buildAction(a2);
-
-    battle_.takeTurn(*act1, *act2);
+    ActionStorage storage1;
+    ActionStorage storage2;
+    battle_.takeTurn(buildAction(a1, storage1), buildAction(a2, storage2));
     lastResolved_ = ResolvedActions{ battle_.currentTurn(), a1, a2 };
+    bumpVersion();
 
     actions_[0].reset();
     actions_[1].reset();
@@ -252,6 +294,7 @@ void BattleSession::updateOutcome() {
     if (battle_.isBattleOver()) {
         outcome_.ended = true;
         outcome_.reason = battle_.endReason();
+        bumpVersion();
         if (lastFlee_.has_value()) {
             outcome_.winner = (*lastFlee_ == 0) ? 2 : 1;
             return;
@@ -272,6 +315,7 @@ void BattleSession::forfeit(int index) {
     if (outcome_.ended) return;
     outcome_.ended = true;
     outcome_.reason = "player left";
+    bumpVersion();
     if (index == 0) {
         outcome_.winner = 2;
     } else if (index == 1) {
@@ -305,9 +349,6 @@ void BattleSession::tick() {
     }
 
     if (!forcePending_[0] && !forcePending_[1]) {
-        if (!actions_[0].has_value() || !actions_[1].has_value()) {
-            scheduleTurnDeadline();
-        }
         if (turnDeadline_.has_value() && Clock::now() >= *turnDeadline_) {
             if (!actions_[0].has_value()) {
                 applyRandomSkill(0);
@@ -322,6 +363,22 @@ void BattleSession::tick() {
     }
 
     updateOutcome();
+    // Start the clock for the next choice right away, so nextDeadline() covers it.
+    if (!outcome_.ended && !forcePending_[0] && !forcePending_[1] &&
+        (!actions_[0].has_value() || !actions_[1].has_value())) {
+        scheduleTurnDeadline();
+    }
+}
+
+std::optional<BattleSession::Clock::time_point> BattleSession::nextDeadline() const {
+    if (outcome_.ended) return std::nullopt;
+    std::optional<Clock::time_point> next = turnDeadline_;
+    for (int i = 0; i < 2; ++i) {
+        if (forcePending_[i] && (!next || forceDeadline_[i] < *next)) {
+            next = forceDeadline_[i];
+        }
+    }
+    return next;
 }
 
 nlohmann::json BattleSession::actionToJson(const ActionData& action) const {
@@ -378,13 +435,15 @@ nlohmann::json BattleSession::stateForPlayer(int index) const {
         j["attrs"] = { static_cast<int>(pet.attrs()[0]), static_cast<int>(pet.attrs()[1]) };
         if (includeSkills) {
             j["skills"] = nlohmann::json::array();
-            for (const auto& slot : pet.learnedSkills()) {
-                if (!slot.has_value() || !slot->base) continue;
+            const PetBattleState& state = pet.battleState();
+            for (std::size_t i = 0; i < PetBattleState::kMaxSkillSlots; ++i) {
+                const SkillBase* base = state.skillAt(i);
+                if (!base) continue;
                 nlohmann::json sk;
-                sk["id"] = slot->base->id();
-                sk["name"] = slot->base->name();
-                sk["pp"] = slot->currentPP;
-                sk["maxPP"] = slot->base->skillMaxPP();
+                sk["id"] = base->id();
+                sk["name"] = base->name();
+                sk["pp"] = state.ppAt(i);
+                sk["maxPP"] = base->skillMaxPP();
                 j["skills"].push_back(std::move(sk));
             }
         }
@@ -409,11 +468,11 @@ nlohmann::json BattleSession::stateForPlayer(int index) const {
 
     nlohmann::json oppJson;
     oppJson["activeIndex"] = opponent.activeIndex();
-    try {
-        nlohmann::json activeJson = buildPetJson(opponent.activePet(), true);
-        activeJson["name"] = opponent.activePet().name();
+    if (const Pet* active = opponent.activePetOrNull()) {
+        nlohmann::json activeJson = buildPetJson(*active, true);
+        activeJson["name"] = active->name();
         oppJson["active"] = std::move(activeJson);
-    } catch (...) {
+    } else {
         oppJson["active"] = nlohmann::json::object();
     }
 
@@ -2,10 +2,12 @@
 
 #include <array>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <battle/BattleSystem.h>
@@ -43,16 +45,34 @@ struct ResolvedActions {
 
 class BattleSession {
   public:
+    using Clock = std::chrono::steady_clock;
+
+    // Prototypes to deal a roster from; empty slots are nullptr.
+    using PrototypeRoster = std::array<const Pet*, Player::kMaxPets>;
+
     BattleSession(std::vector<std::unique_ptr<Pet>> roster1, std::vector<std::unique_ptr<Pet>> roster2,
                   const SkillRegistry& registry);
+    // Copies of the prototypes, as reset() deals them.
+    BattleSession(const PrototypeRoster& roster1, const PrototypeRoster& roster2, const SkillRegistry& registry);
+
+    // Starts a new battle on this session, as if it had just been constructed from copies of the
+    // prototypes. The pets already owned are reset in place, so a session reused for a battle of
+    // the same roster sizes does not allocate.
+    void reset(const PrototypeRoster& roster1, const PrototypeRoster& roster2, const SkillRegistry& registry);
 
     PendingType pendingForPlayer(int index) const;
     bool submitAction(int index, const ActionData& action, std::string* error = nullptr);
     void tick();
     void forfeit(int index);
 
-    BattleOutcome outcome() const { return outcome_; }
+    const BattleOutcome& outcome() const { return outcome_; }
     int currentTurn() const { return battle_.currentTurn(); }
+    // Bumped whenever something visible through stateForPlayer / spectatorState changes
+    // (action submitted, turn resolved, switch, battle over). Starts at 1.
+    std::uint64_t stateVersion() const { return stateVersion_; }
+    // Earliest force-switch or choose-action deadline; tick() has nothing to do before then.
+    // Empty once the battle is over.
+    std::optional<Clock::time_point> nextDeadline() const;
 
     nlohmann::json stateForPlayer(int index) const;
     nlohmann::json spectatorState() const;
@@ -63,8 +83,6 @@ class BattleSession {
     const std::vector<std::unique_ptr<Pet>>& roster2() const { return roster2_; }
 
   private:
-    using Clock = std::chrono::steady_clock;
-
     bool needsForceSwitch(int index) const;
     void scheduleForceSwitch(int index);
     void scheduleTurnDeadline();
@@ -74,9 +92,12 @@ class BattleSession {
     void applyRandomSkill(int index);
     void resolveTurn();
     bool validateAction(int index, const ActionData& action, std::string* error) const;
-    std::unique_ptr<Action> buildAction(const ActionData& action) const;
+    // Every concrete action a turn can be built from, so resolveTurn keeps both on the stack.
+    using ActionStorage = std::variant<StayAction, SkillAction, SwitchAction, FleeAction>;
+    Action& buildAction(const ActionData& action, ActionStorage& storage) const;
 
     void updateOutcome();
+    void bumpVersion() { ++stateVersion_; }
     nlohmann::json actionToJson(const ActionData& action) const;
 
     std::vector<std::unique_ptr<Pet>> roster1_;
@@ -94,6 +115,7 @@ class BattleSession {
     std::optional<int> lastFlee_;
     std::optional<ResolvedActions> lastResolved_;
     BattleOutcome outcome_{};
+    std::uint64_t stateVersion_ = 1;
 
     mutable std::mt19937 rng_{ std::random_device{}() };
 };
@@ -1,8 +1,12 @@
 #include "client.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <random>
 #include <sstream>
@@ -21,6 +25,8 @@
 #include "battle_session.h"
 #include "cli_helpers.h"
 #include "http_client.h"
+#include "http_request.h"
+#include "state_delta.h"
 
 namespace {
 constexpr const char *kRed = "\033[31m";
@@ -612,6 +618,179 @@ void printLastActions(const nlohmann::json &lastActions) {
   std::cout << "\n";
 }
 
+constexpr int kStateLongPollMs = 25000;
+
+// Follows the room over a WebSocket (/ws) on its own connection, so the UI loop only receives a
+// payload when the room actually changed, and actions can go out over the same socket. Falls
+// back to the /events stream and then to long-polling /state/delta?since=<version> (or plain
+// /state on servers without it) when the server lacks those routes or the connection drops
+// early. Stops after an error or once the battle is over. The thread is detached on destruction
+// and leaves at the next event, keep-alive or long-poll reply, so leaving a screen never blocks
+// on it.
+class StatePoller {
+public:
+  // query is the room selector without the path, e.g. "room=r1&playerId=1".
+  StatePoller(const HttpClient &client, std::string query)
+      : shared_(std::make_shared<Shared>(client.host(), client.port(),
+                                         std::move(query))) {
+    shared_->client.setBinary(client.binary());
+    std::thread([shared = shared_] { run(*shared); }).detach();
+  }
+  ~StatePoller() {
+    shared_->running = false;
+    shared_->socket.close();
+  }
+
+  StatePoller(const StatePoller &) = delete;
+  StatePoller &operator=(const StatePoller &) = delete;
+
+  // Moves the newest unseen response into out; false if nothing new arrived.
+  bool take(HttpClientResponse &out) {
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    if (!shared_->latest)
+      return false;
+    out = std::move(*shared_->latest);
+    shared_->latest.reset();
+    return true;
+  }
+
+  // Sends an action (the fields of POST /action) over the WebSocket. Returns false when the
+  // socket is not open, in which case the caller should POST it instead.
+  bool submit(const nlohmann::json &action) {
+    if (!shared_->socket.isOpen())
+      return false;
+    nlohmann::json message = action;
+    message["op"] = "action";
+    message["id"] = ++shared_->nextActionId;
+    return shared_->socket.send(message.dump());
+  }
+
+private:
+  struct Shared {
+    Shared(const std::string &host, int port, std::string q)
+        : client(host, port), socket(host, port), query(std::move(q)) {}
+    HttpClient client;
+    WebSocketClient socket;
+    std::string query;
+    std::atomic<int> nextActionId{0};
+    std::atomic<bool> running{true};
+    std::mutex mutex;
+    std::optional<HttpClientResponse> latest;
+  };
+
+  static void publish(Shared &shared, HttpClientResponse resp) {
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.latest = std::move(resp);
+  }
+
+  static void run(Shared &shared) {
+    std::uint64_t version = 0;
+    nlohmann::json current; // full state at `version`, patched by /state/delta
+    bool over = false;
+    auto onState = [&](const nlohmann::json &body, std::string raw) {
+      version = body.value("version", version);
+      current = body;
+      over = body.value("battleOver", false);
+      publish(shared, HttpClientResponse{200, std::move(raw)});
+    };
+
+    if (shared.socket.connect("/ws?" + shared.query)) {
+      std::string message;
+      while (shared.running && !over && shared.socket.receive(message)) {
+        auto msg = nlohmann::json::parse(message, nullptr, false);
+        // Action results are not needed: the state push that follows carries the outcome.
+        if (msg.is_discarded() || msg.value("op", "") != "state")
+          continue;
+        onState(msg["state"], msg["state"].dump());
+      }
+      shared.socket.close();
+      if (over || !shared.running)
+        return;
+    }
+
+    shared.client.subscribe(
+        "/events?" + shared.query,
+        [&](const std::string &event, const std::string &data) {
+          if (!shared.running)
+            return false;
+          if (event != "state")
+            return true; // keep-alive
+          auto body = nlohmann::json::parse(data, nullptr, false);
+          if (body.is_discarded())
+            return true;
+          onState(body, data);
+          return !over;
+        });
+    if (over)
+      return;
+
+    bool deltas = true;
+    while (shared.running) {
+      if (deltas && version != 0) {
+        auto resp = shared.client.get("/state/delta?" + shared.query +
+                                      "&since=" + std::to_string(version) +
+                                      "&timeout=" +
+                                      std::to_string(kStateLongPollMs));
+        auto body = resp.json();
+        if (resp.status == 404 && !body.is_discarded() &&
+            body.value("error", "") == "not found") {
+          deltas = false; // older server: long-poll full states instead
+          continue;
+        }
+        if (resp.status != 200 || body.is_discarded()) {
+          publish(shared, std::move(resp));
+          return;
+        }
+        auto next = body.value("version", version);
+        if (next == version)
+          continue; // long-poll timed out with nothing new
+        if (body.value("full", true)) {
+          current = body["state"];
+        } else {
+          applyStateDelta(current, body["patch"]);
+        }
+        version = next;
+        over = current.value("battleOver", false);
+        publish(shared, HttpClientResponse{200, current.dump()});
+        if (over)
+          return;
+        continue;
+      }
+      auto resp = shared.client.get("/state?" + shared.query + "&since=" +
+                                    std::to_string(version) + "&timeout=" +
+                                    std::to_string(kStateLongPollMs));
+      if (resp.notModified)
+        continue; // long-poll timed out and the ETag still matches
+      bool stop = resp.status != 200;
+      bool legacyServer = false;
+      if (!stop) {
+        auto body = resp.json();
+        if (body.is_discarded()) {
+          stop = true;
+        } else if (!body.contains("version")) {
+          // Server without long-poll support answers immediately; fall back to polling.
+          legacyServer = true;
+          stop = body.value("battleOver", false);
+        } else {
+          auto next = body["version"].get<std::uint64_t>();
+          stop = body.value("battleOver", false);
+          if (next == version && !stop)
+            continue; // long-poll timed out with nothing new
+          version = next;
+          current = std::move(body);
+        }
+      }
+      publish(shared, std::move(resp));
+      if (stop)
+        return;
+      if (legacyServer)
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    }
+  }
+
+  std::shared_ptr<Shared> shared_;
+};
+
 int runBattle(HttpClient &client, const std::string &room, int playerId) {
 #ifndef _WIN32
   TermiosGuard guard;
@@ -632,7 +811,13 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
   std::string message;
   int lastRemaining = -1;
   nlohmann::json state = nlohmann::json::object();
-  auto lastFetch = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+  StatePoller poller(client, "room=" + encodeQueryComponent(room) +
+                                 "&playerId=" + std::to_string(playerId));
+  // Over the room WebSocket when it is up, otherwise a plain POST.
+  auto submitAction = [&](const nlohmann::json &payload) {
+    if (!poller.submit(payload))
+      client.post("/action", payload);
+  };
 
   std::vector<std::string> rightItems = {"技能", "更换宠物", "逃跑", "战术挂机"};
 
@@ -651,21 +836,17 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
   };
 
   while (true) {
-    auto now = std::chrono::steady_clock::now();
     bool needRender = false;
 
-    if (now - lastFetch >= std::chrono::milliseconds(300)) {
-      lastFetch = now;
-      auto stateResp = client.get("/state?room=" + room +
-                                  "&playerId=" + std::to_string(playerId));
+    HttpClientResponse stateResp;
+    if (poller.take(stateResp)) {
       if (stateResp.status != 200) {
-        std::cerr << "State error: " << stateResp.body << "\n";
+        std::cerr << "State error: " << stateResp.text() << "\n";
         exitAltScreen();
         disableRawMode(guard);
         return 1;
       }
-      nlohmann::json next =
-          nlohmann::json::parse(stateResp.body, nullptr, false);
+      nlohmann::json next = stateResp.json();
       if (next.is_discarded()) {
         std::cerr << "Invalid state response.\n";
         exitAltScreen();
@@ -730,10 +911,10 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
     if (actionActive && !actionSubmitted && remaining == 0) {
       if (pending == "force_switch") {
         std::size_t idx = chooseAutoSwitch(state);
-        client.post("/action", {{"room", room},
-                                {"playerId", playerId},
-                                {"type", "switch"},
-                                {"index", idx}});
+        submitAction({{"room", room},
+                      {"playerId", playerId},
+                      {"type", "switch"},
+                      {"index", idx}});
       } else {
         ActionData action = randomSkillFromState(state);
         nlohmann::json payload;
@@ -745,7 +926,7 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
         } else {
           payload["type"] = "stay";
         }
-        client.post("/action", payload);
+        submitAction(payload);
       }
       actionSubmitted = true;
       message = "已提交，等待对手...";
@@ -792,10 +973,10 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
             message = "当前宠物不可替换";
             needRender = true;
           } else {
-            client.post("/action", {{"room", room},
-                                    {"playerId", playerId},
-                                    {"type", "switch"},
-                                    {"index", items[static_cast<std::size_t>(leftIdx)].switchIndex}});
+            submitAction({{"room", room},
+                          {"playerId", playerId},
+                          {"type", "switch"},
+                          {"index", items[static_cast<std::size_t>(leftIdx)].switchIndex}});
             actionSubmitted = true;
             message = "已提交，等待对手...";
             needRender = true;
@@ -810,16 +991,16 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
             leftIdx = 0;
             needRender = true;
           } else if (rightIdx == 2) {
-            client.post("/action", {{"room", room},
-                                    {"playerId", playerId},
-                                    {"type", "flee"}});
+            submitAction({{"room", room},
+                          {"playerId", playerId},
+                          {"type", "flee"}});
             actionSubmitted = true;
             message = "已提交，等待对手...";
             needRender = true;
           } else if (rightIdx == 3) {
-            client.post("/action", {{"room", room},
-                                    {"playerId", playerId},
-                                    {"type", "stay"}});
+            submitAction({{"room", room},
+                          {"playerId", playerId},
+                          {"type", "stay"}});
             actionSubmitted = true;
             message = "已提交，等待对手...";
             needRender = true;
@@ -834,10 +1015,10 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
               message = "该技能不可用";
               needRender = true;
             } else {
-              client.post("/action", {{"room", room},
-                                      {"playerId", playerId},
-                                      {"type", "skill"},
-                                      {"skillId", items[static_cast<std::size_t>(leftIdx)].skillId}});
+              submitAction({{"room", room},
+                            {"playerId", playerId},
+                            {"type", "skill"},
+                            {"skillId", items[static_cast<std::size_t>(leftIdx)].skillId}});
               actionSubmitted = true;
               message = "已提交，等待对手...";
               needRender = true;
@@ -851,10 +1032,10 @@ int runBattle(HttpClient &client, const std::string &room, int playerId) {
               message = "当前宠物不可替换";
               needRender = true;
             } else {
-              client.post("/action", {{"room", room},
-                                      {"playerId", playerId},
-                                      {"type", "switch"},
-                                      {"index", items[static_cast<std::size_t>(leftIdx)].switchIndex}});
+              submitAction({{"room", room},
+                            {"playerId", playerId},
+                            {"type", "switch"},
+                            {"index", items[static_cast<std::size_t>(leftIdx)].switchIndex}});
               actionSubmitted = true;
               message = "已提交，等待对手...";
               needRender = true;
@@ -895,13 +1076,12 @@ int runRoomLobby(HttpClient &client, const std::string &room, int playerId) {
   if (!enableRawMode(guard)) {
     std::vector<std::string> options = {"ready", "unready", "leave", "refresh"};
     while (true) {
-      auto roomResp = client.get("/room?name=" + room);
+      auto roomResp = client.get("/room?name=" + encodeQueryComponent(room));
       if (roomResp.status != 200) {
-        std::cerr << "Room error: " << roomResp.body << "\n";
+        std::cerr << "Room error: " << roomResp.text() << "\n";
         return 0;
       }
-      nlohmann::json roomJson =
-          nlohmann::json::parse(roomResp.body, nullptr, false);
+      nlohmann::json roomJson = roomResp.json();
       if (roomJson.is_discarded()) {
         std::cerr << "Room response invalid.\n";
         return 0;
@@ -945,17 +1125,20 @@ int runRoomLobby(HttpClient &client, const std::string &room, int playerId) {
     bool needRender = false;
     std::vector<std::string> messages;
 
+    HttpClientResponse roomResp;
     if (now - lastFetch >= std::chrono::milliseconds(500)) {
       lastFetch = now;
-      auto roomResp = client.get("/room?name=" + room);
+      roomResp = client.get("/room?name=" + encodeQueryComponent(room));
       if (roomResp.status != 200) {
-        std::cerr << "Room error: " << roomResp.body << "\n";
+        std::cerr << "Room error: " << roomResp.text() << "\n";
         exitAltScreen();
         disableRawMode(guard);
         return 0;
       }
-      nlohmann::json nextRoom =
-          nlohmann::json::parse(roomResp.body, nullptr, false);
+    }
+    // A 304 (notModified) leaves roomJson and the screen as they are.
+    if (roomResp.status == 200 && !roomResp.notModified) {
+      nlohmann::json nextRoom = roomResp.json();
       if (nextRoom.is_discarded()) {
         std::cerr << "Room response invalid.\n";
         exitAltScreen();
@@ -1057,46 +1240,49 @@ int runRoomLobby(HttpClient &client, const std::string &room, int playerId) {
 int runSpectator(HttpClient &client, const std::string &room,
                  const std::string &name) {
 #ifndef _WIN32
+  StatePoller poller(client, "room=" + encodeQueryComponent(room) +
+                                 "&spectator=1&name=" +
+                                 encodeQueryComponent(name));
   TermiosGuard guard;
   if (!enableRawMode(guard)) {
     std::cout << "Spectating room " << room << ". Type 'leave' to exit.\n";
     int lastTurnShown = -1;
     bool printedWaiting = false;
     while (true) {
-      auto stateResp =
-          client.get("/state?room=" + room + "&spectator=1&name=" + name);
-      if (stateResp.status != 200) {
-        std::cerr << "Spectate error: " << stateResp.body << "\n";
-        break;
-      }
-      nlohmann::json state =
-          nlohmann::json::parse(stateResp.body, nullptr, false);
-      if (state.is_discarded()) {
-        std::cerr << "Invalid spectator state.\n";
-        break;
-      }
-
-      if (state.value("status", "") == "waiting") {
-        if (!printedWaiting) {
-          std::cout << "Waiting for battle to start...\n";
-          printedWaiting = true;
+      HttpClientResponse stateResp;
+      if (poller.take(stateResp)) {
+        if (stateResp.status != 200) {
+          std::cerr << "Spectate error: " << stateResp.text() << "\n";
+          break;
         }
-        if (state.contains("room")) {
-          printRoomInfo(state["room"]);
+        nlohmann::json state = stateResp.json();
+        if (state.is_discarded()) {
+          std::cerr << "Invalid spectator state.\n";
+          break;
         }
-      } else {
-        printedWaiting = false;
-        if (state.contains("lastActions") && state["lastActions"].is_object()) {
-          int turn = state["lastActions"].value("turn", -1);
-          if (turn != lastTurnShown) {
-            lastTurnShown = turn;
-            printLastActions(state["lastActions"]);
+
+        if (state.value("status", "") == "waiting") {
+          if (!printedWaiting) {
+            std::cout << "Waiting for battle to start...\n";
+            printedWaiting = true;
+          }
+          if (state.contains("room")) {
+            printRoomInfo(state["room"]);
+          }
+        } else {
+          printedWaiting = false;
+          if (state.contains("lastActions") && state["lastActions"].is_object()) {
+            int turn = state["lastActions"].value("turn", -1);
+            if (turn != lastTurnShown) {
+              lastTurnShown = turn;
+              printLastActions(state["lastActions"]);
+            }
+          }
+          if (state.value("battleOver", false)) {
+            std::cout << "Battle ended. Winner=" << state.value("winner", 0)
+                      << " Reason=" << state.value("reason", "") << "\n";
+            break;
           }
-        }
-        if (state.value("battleOver", false)) {
-          std::cout << "Battle ended. Winner=" << state.value("winner", 0)
-                    << " Reason=" << state.value("reason", "") << "\n";
-          break;
         }
       }
 
@@ -1117,25 +1303,20 @@ int runSpectator(HttpClient &client, const std::string &room,
   bool seenSnapshot = false;
   std::vector<std::string> messageLog;
   nlohmann::json roomInfo = nlohmann::json::object();
-  auto lastFetch = std::chrono::steady_clock::now() - std::chrono::seconds(1);
 
   while (true) {
-    auto now = std::chrono::steady_clock::now();
     bool needRender = false;
     std::vector<std::string> messages;
 
-    if (now - lastFetch >= std::chrono::milliseconds(500)) {
-      lastFetch = now;
-      auto stateResp =
-          client.get("/state?room=" + room + "&spectator=1&name=" + name);
+    HttpClientResponse stateResp;
+    if (poller.take(stateResp)) {
       if (stateResp.status != 200) {
-        std::cerr << "Spectate error: " << stateResp.body << "\n";
+        std::cerr << "Spectate error: " << stateResp.text() << "\n";
         exitAltScreen();
         disableRawMode(guard);
         break;
       }
-      nlohmann::json state =
-          nlohmann::json::parse(stateResp.body, nullptr, false);
+      nlohmann::json state = stateResp.json();
       if (state.is_discarded()) {
         std::cerr << "Invalid spectator state.\n";
         exitAltScreen();
@@ -1270,16 +1451,61 @@ int runSpectator(HttpClient &client, const std::string &room,
   return 0;
 #endif
 }
+
+// Queues for an opponent with POST /queue and polls the ticket until the
+// server pairs it by rating; the room it returns has the battle started. Returns false if the player cancelled (q) or the ticket
+// was lost.
+bool waitForMatch(HttpClient &client, const std::string &name,
+                  std::string &room, int &playerId) {
+  auto resp = client.post("/queue", {{"name", name}});
+  nlohmann::json data = resp.json();
+  if (resp.status != 200 || data.is_discarded()) {
+    std::cerr << "Queue failed: " << resp.text() << "\n";
+    return false;
+  }
+  const std::string ticket = data.value("ticket", "");
+#ifndef _WIN32
+  TermiosGuard guard;
+  const bool raw = enableRawMode(guard);
+#endif
+  if (data.value("status", "") == "waiting")
+    std::cout << "Waiting for an opponent near rating "
+              << static_cast<int>(data.value("rating", 0.0))
+              << " (q to cancel)...\n";
+  while (data.value("status", "") == "waiting") {
+#ifndef _WIN32
+    int c = raw ? readCharWithTimeout(500) : -1;
+    if (!raw)
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (c == 'q' || c == 'Q') {
+      client.post("/queue/leave", {{"ticket", ticket}});
+      return false;
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+#endif
+    resp = client.get("/queue?ticket=" + encodeQueryComponent(ticket));
+    data = resp.json();
+    if (resp.status != 200 || data.is_discarded()) {
+      std::cerr << "Queue failed: " << resp.text() << "\n";
+      return false;
+    }
+  }
+  room = data.value("room", "");
+  playerId = data.value("playerId", 0);
+  return !room.empty() && playerId > 0;
+}
 } // namespace
 
 int runClient(const std::string &host, int port) {
   HttpClient client(host, port);
+  client.setBinary(true);
 
   std::string name = promptLine("Enter your name: ");
 
   while (true) {
     std::vector<std::string> lobbyOptions = {"list", "create", "join", "random",
-                                             "spectate", "quit"};
+                                             "match", "spectate", "quit"};
     int choice = selectMenu("Lobby (Up/Down + Enter, q to cancel)", lobbyOptions, 0);
     if (choice < 0)
       continue;
@@ -1288,10 +1514,10 @@ int runClient(const std::string &host, int port) {
     if (cmd == "list") {
       auto resp = client.get("/rooms");
       if (resp.status != 200) {
-        std::cerr << "List failed: " << resp.body << "\n";
+        std::cerr << "List failed: " << resp.text() << "\n";
         continue;
       }
-      nlohmann::json data = nlohmann::json::parse(resp.body, nullptr, false);
+      nlohmann::json data = resp.json();
       if (data.is_discarded()) {
         std::cerr << "Invalid list response.\n";
         continue;
@@ -1308,11 +1534,10 @@ int runClient(const std::string &host, int port) {
         continue;
       }
       if (resp.status != 200) {
-        std::cerr << "Create failed: " << resp.body << "\n";
+        std::cerr << "Create failed: " << resp.text() << "\n";
         continue;
       }
-      nlohmann::json joinJson =
-          nlohmann::json::parse(resp.body, nullptr, false);
+      nlohmann::json joinJson = resp.json();
       if (joinJson.is_discarded()) {
         std::cerr << "Create response invalid.\n";
         continue;
@@ -1320,7 +1545,7 @@ int runClient(const std::string &host, int port) {
       int playerId = joinJson.value("playerId", 0);
       std::string roomName = joinJson.value("room", "");
       if (playerId <= 0 || roomName.empty()) {
-        std::cerr << "Create failed: " << resp.body << "\n";
+        std::cerr << "Create failed: " << resp.text() << "\n";
         continue;
       }
       std::cout << "Created room " << roomName << " as player " << playerId
@@ -1332,11 +1557,10 @@ int runClient(const std::string &host, int port) {
     if (cmd == "join") {
       auto listResp = client.get("/rooms");
       if (listResp.status != 200) {
-        std::cerr << "List failed: " << listResp.body << "\n";
+        std::cerr << "List failed: " << listResp.text() << "\n";
         continue;
       }
-      nlohmann::json listJson =
-          nlohmann::json::parse(listResp.body, nullptr, false);
+      nlohmann::json listJson = listResp.json();
       if (listJson.is_discarded()) {
         std::cerr << "Invalid list response.\n";
         continue;
@@ -1349,11 +1573,10 @@ int runClient(const std::string &host, int port) {
       std::string room = *roomOpt;
       auto resp = client.post("/join", {{"room", room}, {"name", name}});
       if (resp.status != 200) {
-        std::cerr << "Join failed: " << resp.body << "\n";
+        std::cerr << "Join failed: " << resp.text() << "\n";
         continue;
       }
-      nlohmann::json joinJson =
-          nlohmann::json::parse(resp.body, nullptr, false);
+      nlohmann::json joinJson = resp.json();
       if (joinJson.is_discarded()) {
         std::cerr << "Join response invalid.\n";
         continue;
@@ -1361,7 +1584,7 @@ int runClient(const std::string &host, int port) {
       int playerId = joinJson.value("playerId", 0);
       std::string roomName = joinJson.value("room", "");
       if (playerId <= 0 || roomName.empty()) {
-        std::cerr << "Join failed: " << resp.body << "\n";
+        std::cerr << "Join failed: " << resp.text() << "\n";
         continue;
       }
       std::cout << "Joined room " << roomName << " as player " << playerId
@@ -1373,11 +1596,10 @@ int runClient(const std::string &host, int port) {
     if (cmd == "random") {
       auto resp = client.post("/join_random", {{"name", name}});
       if (resp.status != 200) {
-        std::cerr << "Random join failed: " << resp.body << "\n";
+        std::cerr << "Random join failed: " << resp.text() << "\n";
         continue;
       }
-      nlohmann::json joinJson =
-          nlohmann::json::parse(resp.body, nullptr, false);
+      nlohmann::json joinJson = resp.json();
       if (joinJson.is_discarded()) {
         std::cerr << "Random join response invalid.\n";
         continue;
@@ -1385,7 +1607,7 @@ int runClient(const std::string &host, int port) {
       int playerId = joinJson.value("playerId", 0);
       std::string roomName = joinJson.value("room", "");
       if (playerId <= 0 || roomName.empty()) {
-        std::cerr << "Random join failed: " << resp.body << "\n";
+        std::cerr << "Random join failed: " << resp.text() << "\n";
         continue;
       }
       std::cout << "Joined room " << roomName << " as player " << playerId
@@ -1394,14 +1616,24 @@ int runClient(const std::string &host, int port) {
       continue;
     }
 
+    if (cmd == "match") {
+      std::string roomName;
+      int playerId = 0;
+      if (!waitForMatch(client, name, roomName, playerId))
+        continue;
+      std::cout << "Matched into room " << roomName << " as player "
+                << playerId << "\n";
+      runRoomLobby(client, roomName, playerId);
+      continue;
+    }
+
     if (cmd == "spectate") {
       auto listResp = client.get("/rooms");
       if (listResp.status != 200) {
-        std::cerr << "List failed: " << listResp.body << "\n";
+        std::cerr << "List failed: " << listResp.text() << "\n";
         continue;
       }
-      nlohmann::json listJson =
-          nlohmann::json::parse(listResp.body, nullptr, false);
+      nlohmann::json listJson = listResp.json();
       if (listJson.is_discarded()) {
         std::cerr << "Invalid list response.\n";
         continue;
@@ -1414,18 +1646,17 @@ int runClient(const std::string &host, int port) {
       std::string room = *roomOpt;
       auto resp = client.post("/spectate", {{"room", room}, {"name", name}});
       if (resp.status != 200) {
-        std::cerr << "Spectate failed: " << resp.body << "\n";
+        std::cerr << "Spectate failed: " << resp.text() << "\n";
         continue;
       }
-      nlohmann::json specJson =
-          nlohmann::json::parse(resp.body, nullptr, false);
+      nlohmann::json specJson = resp.json();
       if (specJson.is_discarded()) {
         std::cerr << "Spectate response invalid.\n";
         continue;
       }
       std::string roomName = specJson.value("room", "");
       if (roomName.empty()) {
-        std::cerr << "Spectate failed: " << resp.body << "\n";
+        std::cerr << "Spectate failed: " << resp.text() << "\n";
         continue;
       }
       runSpectator(client, roomName, name);
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <filesystem>
+#include <numeric>
 #include <optional>
 #include <sstream>
 
@@ -153,6 +154,7 @@ bool loadDataStore(const std::string& petsDbPath, const std::string& skillsDir,
         return false;
     }
 
+    buildPetPrototypes(out);
     return true;
 }
 
@@ -174,3 +176,56 @@ std::unique_ptr<Pet> createPetFromTemplate(const PetTemplate& templ, const Skill
 
     return pet;
 }
+
+void buildPetPrototypes(DataStore& store) {
+    std::vector<int> ids;
+    ids.reserve(store.pets.size());
+    for (const auto& it : store.pets) {
+        ids.push_back(it.first);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    store.prototypes.clear();
+    store.prototypes.reserve(ids.size());
+    for (int id : ids) {
+        if (auto pet = createPetFromTemplate(store.pets.at(id), store.skills, 100)) {
+            store.prototypes.push_back(std::move(*pet));
+        }
+    }
+}
+
+std::size_t RosterSampler::shuffleFront(const DataStore& store, std::mt19937& rng, std::size_t count) {
+    const std::size_t total = store.prototypes.size();
+    if (order_.size() != total) {
+        order_.resize(total);
+        std::iota(order_.begin(), order_.end(), std::size_t{ 0 });
+    }
+    count = std::min(count, total);
+
+    // The first `count` steps of a Fisher–Yates shuffle: order_[0, count) becomes a uniform
+    // sample, and order_ stays a permutation for the next draw.
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uniform_int_distribution<std::size_t> pick(i, total - 1);
+        std::swap(order_[i], order_[pick(rng)]);
+    }
+    return count;
+}
+
+std::vector<std::unique_ptr<Pet>> RosterSampler::draw(const DataStore& store, std::mt19937& rng, std::size_t count) {
+    count = shuffleFront(store, rng, count);
+    std::vector<std::unique_ptr<Pet>> roster;
+    roster.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        roster.push_back(std::make_unique<Pet>(store.prototypes[order_[i]]));
+    }
+    return roster;
+}
+
+std::size_t RosterSampler::sample(const DataStore& store, std::mt19937& rng,
+                                  std::array<const Pet*, Player::kMaxPets>& out) {
+    const std::size_t count = shuffleFront(store, rng, out.size());
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        out[i] = i < count ? &store.prototypes[order_[i]] : nullptr;
+    }
+    return count;
+}
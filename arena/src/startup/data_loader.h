@@ -1,15 +1,18 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <entity/Pet.h>
+#include <entity/Player.h>
 #include <entity/Species.h>
 #include <skill/SkillRegistry.h>
 
-class Pet;
-
 struct PetTemplate {
     Species::Ptr species;
     std::vector<int> learnableSkillIds;
@@ -18,9 +21,33 @@ struct PetTemplate {
 struct DataStore {
     SkillRegistry skills;
     std::unordered_map<int, PetTemplate> pets;
+    // createPetFromTemplate() of every template at level 100, in ascending template id order.
+    // Battle pets are copies of these (see RosterSampler).
+    std::vector<Pet> prototypes;
 };
 
 bool loadDataStore(const std::string& petsDbPath, const std::string& skillsDir, DataStore& out, std::string* error);
 
 std::unique_ptr<Pet> createPetFromTemplate(const PetTemplate& templ, const SkillRegistry& registry,
                                            int level = 100);
+
+// Rebuilds store.prototypes from store.pets and store.skills; loadDataStore calls it.
+void buildPetPrototypes(DataStore& store);
+
+// Draws rosters of distinct pets from a store's prototypes. The indices are a permutation kept
+// from draw to draw, so a roster of k pets costs k steps of a Fisher–Yates shuffle and k copies,
+// however many templates there are. Not thread-safe; use one per random engine.
+class RosterSampler {
+  public:
+    std::vector<std::unique_ptr<Pet>> draw(const DataStore& store, std::mt19937& rng, std::size_t count);
+    // The same draw of a full roster without copying: points `out` at the chosen prototypes
+    // (nullptr past the last one) for BattleSession::reset. Returns how many were chosen.
+    std::size_t sample(const DataStore& store, std::mt19937& rng, std::array<const Pet*, Player::kMaxPets>& out);
+
+  private:
+    // Moves a uniform sample of `count` prototype indices to order_[0, count); returns the count
+    // actually drawn.
+    std::size_t shuffleFront(const DataStore& store, std::mt19937& rng, std::size_t count);
+
+    std::vector<std::size_t> order_;
+};
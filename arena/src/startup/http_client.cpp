@@ -1,8 +1,13 @@
 #include "http_client.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <random>
 #include <sstream>
 
+#include "wire_format.h"
+
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -10,6 +15,8 @@
 #else
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
@@ -23,6 +30,18 @@ using SocketType = int;
 constexpr SocketType kInvalidSocket = -1;
 #endif
 
+#ifdef _WIN32
+constexpr int kShutdownBoth = SD_BOTH;
+#else
+constexpr int kShutdownBoth = SHUT_RDWR;
+#endif
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
 void closeSocket(SocketType fd) {
 #ifdef _WIN32
     closesocket(fd);
@@ -30,8 +49,71 @@ void closeSocket(SocketType fd) {
     close(fd);
 #endif
 }
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+std::vector<HttpClientResponse> failAll(std::size_t count, const std::string& reason) {
+    std::vector<HttpClientResponse> responses(count);
+    for (auto& resp : responses) resp.body = reason;
+    return responses;
+}
+
+// IPv4 address of `host` in network byte order.
+bool resolveHost(const std::string& host, std::uint32_t& address) {
+    struct hostent* server = gethostbyname(host.c_str());
+    if (!server) return false;
+    std::memcpy(&address, server->h_addr, sizeof(address));
+    return true;
+}
+
+// Connected TCP socket with Nagle disabled, or kInvalidSocket.
+SocketType connectTo(std::uint32_t address, int port) {
+    SocketType sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == kInvalidSocket) return kInvalidSocket;
+
+    sockaddr_in servAddr{};
+    servAddr.sin_family = AF_INET;
+    servAddr.sin_port = htons(static_cast<uint16_t>(port));
+    servAddr.sin_addr.s_addr = address;
+    if (connect(sock, reinterpret_cast<sockaddr*>(&servAddr), sizeof(servAddr)) < 0) {
+        closeSocket(sock);
+        return kInvalidSocket;
+    }
+
+    int noDelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    return sock;
+}
+
+bool sendAllTo(SocketType sock, const std::string& bytes) {
+    std::size_t offset = 0;
+    while (offset < bytes.size()) {
+        const int sent = static_cast<int>(
+            send(sock, bytes.data() + offset, static_cast<int>(bytes.size() - offset), kSendFlags));
+        if (sent <= 0) return false;
+        offset += static_cast<std::size_t>(sent);
+    }
+    return true;
+}
 } // namespace
 
+nlohmann::json HttpClientResponse::json() const {
+    if (isBinaryMediaType(contentType)) {
+        nlohmann::json value;
+        return decodeBinary(body, value) ? value : nlohmann::json(nlohmann::json::value_t::discarded);
+    }
+    return nlohmann::json::parse(body, nullptr, false);
+}
+
+std::string HttpClientResponse::text() const {
+    if (!isBinaryMediaType(contentType)) return body;
+    const nlohmann::json value = json();
+    return value.is_discarded() ? "<undecodable binary body>" : value.dump();
+}
+
 HttpClient::HttpClient(std::string host, int port) : host_(std::move(host)), port_(port) {
 #ifdef _WIN32
     WSADATA wsaData;
@@ -39,85 +121,436 @@ HttpClient::HttpClient(std::string host, int port) : host_(std::move(host)), por
 #endif
 }
 
+HttpClient::~HttpClient() {
+    disconnect();
+}
+
 HttpClientResponse HttpClient::get(const std::string& path) {
-    return sendRequest("GET", path, "");
+    auto cached = cache_.find(path);
+    std::string wire;
+    appendRequest(wire, "GET", path, "", cached != cache_.end() ? cached->second.etag : "");
+    HttpClientResponse resp = std::move(exchange(wire, 1).front());
+    if (resp.status == 304 && cached != cache_.end()) {
+        resp.status = 200;
+        resp.body = cached->second.body;
+        resp.etag = cached->second.etag;
+        resp.contentType = cached->second.contentType;
+        resp.notModified = true;
+    } else if (resp.status == 200 && !resp.etag.empty()) {
+        remember(path, resp);
+    }
+    return resp;
+}
+
+void HttpClient::remember(const std::string& path, const HttpClientResponse& resp) {
+    auto it = cache_.find(path);
+    if (it == cache_.end()) {
+        if (cache_.size() >= kMaxCachedResponses) {
+            cache_.erase(cacheOrder_.front());
+            cacheOrder_.pop_front();
+        }
+        cacheOrder_.push_back(path);
+        it = cache_.emplace(path, CachedResponse{}).first;
+    }
+    it->second.etag = resp.etag;
+    it->second.body = resp.body;
+    it->second.contentType = resp.contentType;
 }
 
 HttpClientResponse HttpClient::post(const std::string& path, const nlohmann::json& payload) {
+    if (binary_ && serverBinary_) {
+        std::string wire;
+        appendRequest(wire, "POST", path, encodeBinary(payload), "", kBinaryMediaType);
+        return std::move(exchange(wire, 1).front());
+    }
     return sendRequest("POST", path, payload.dump());
 }
 
-HttpClientResponse HttpClient::sendRequest(const std::string& method, const std::string& path,
-                                           const std::string& body) {
-    HttpClientResponse resp;
-
-    SocketType sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock == kInvalidSocket) {
-        resp.status = 0;
-        resp.body = "socket failed";
-        return resp;
+std::vector<HttpClientResponse> HttpClient::pipeline(const std::vector<HttpClientRequest>& requests) {
+    if (requests.empty()) return {};
+    std::string wire;
+    for (const auto& req : requests) {
+        appendRequest(wire, req.method, req.path, req.body);
     }
+    return exchange(wire, requests.size());
+}
 
-    struct hostent* server = gethostbyname(host_.c_str());
-    if (!server) {
-        resp.status = 0;
-        resp.body = "host not found";
-        closeSocket(sock);
-        return resp;
+void HttpClient::disconnect() {
+    if (sock_ != -1) {
+        closeSocket(static_cast<SocketType>(sock_));
+        sock_ = -1;
     }
+    readBuffer_.clear();
+}
 
-    sockaddr_in serv_addr{};
-    serv_addr.sin_family = AF_INET;
-    serv_addr.sin_port = htons(static_cast<uint16_t>(port_));
-    std::memcpy(&serv_addr.sin_addr.s_addr, server->h_addr, server->h_length);
-
-    if (connect(sock, reinterpret_cast<sockaddr*>(&serv_addr), sizeof(serv_addr)) < 0) {
-        resp.status = 0;
-        resp.body = "connect failed";
-        closeSocket(sock);
-        return resp;
-    }
+HttpClientResponse HttpClient::sendRequest(const std::string& method, const std::string& path,
+                                           const std::string& body) {
+    std::string wire;
+    appendRequest(wire, method, path, body);
+    return std::move(exchange(wire, 1).front());
+}
 
+void HttpClient::appendRequest(std::string& out, const std::string& method, const std::string& path,
+                               const std::string& body, const std::string& ifNoneMatch,
+                               const std::string& contentType) const {
     std::ostringstream oss;
     oss << method << " " << path << " HTTP/1.1\r\n";
     oss << "Host: " << host_ << "\r\n";
+    if (!ifNoneMatch.empty()) {
+        oss << "If-None-Match: " << ifNoneMatch << "\r\n";
+    }
+    if (binary_) {
+        oss << "Accept: " << kBinaryMediaType << ", application/json\r\n";
+    }
     if (method == "POST") {
-        oss << "Content-Type: application/json\r\n";
+        oss << "Content-Type: " << contentType << "\r\n";
         oss << "Content-Length: " << body.size() << "\r\n";
     }
-    oss << "Connection: close\r\n\r\n";
+    oss << "\r\n";
     if (method == "POST") {
         oss << body;
     }
+    out += oss.str();
+}
 
-    std::string request = oss.str();
-    send(sock, request.c_str(), static_cast<int>(request.size()), 0);
+std::vector<HttpClientResponse> HttpClient::exchange(const std::string& wire, std::size_t count) {
+    // A kept-alive connection may have been closed by the server while idle; that only shows
+    // up on the next write or read, so one retry on a fresh connection is allowed.
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const bool reused = sock_ != -1;
+        std::string error;
+        if (!ensureConnected(&error)) {
+            return failAll(count, error);
+        }
+        if (!sendAll(wire)) {
+            disconnect();
+            if (reused) continue;
+            return failAll(count, "send failed");
+        }
 
-    std::string raw;
-    char buffer[4096];
-    int received = 0;
-    while ((received = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
-        raw.append(buffer, buffer + received);
+        std::vector<HttpClientResponse> responses;
+        responses.reserve(count);
+        bool retry = false;
+        while (responses.size() < count) {
+            HttpClientResponse resp;
+            bool serverClosing = false;
+            const ReadResult result = readResponse(resp, serverClosing);
+            if (result != ReadResult::Ok) {
+                disconnect();
+                retry = result == ReadResult::NoData && reused && responses.empty();
+                break;
+            }
+            responses.push_back(std::move(resp));
+            if (serverClosing) {
+                disconnect();
+                break;
+            }
+        }
+        if (retry) continue;
+        while (responses.size() < count) {
+            HttpClientResponse lost;
+            lost.body = "connection closed";
+            responses.push_back(std::move(lost));
+        }
+        return responses;
     }
+    return failAll(count, "connection closed");
+}
 
-    closeSocket(sock);
+bool HttpClient::ensureConnected(std::string* error) {
+    if (sock_ != -1) return true;
 
-    auto pos = raw.find("\r\n\r\n");
-    if (pos == std::string::npos) {
-        resp.status = 0;
-        resp.body = raw;
-        return resp;
+    if (!resolved_) {
+        if (!resolveHost(host_, address_)) {
+            if (error) *error = "host not found";
+            return false;
+        }
+        resolved_ = true;
     }
 
-    std::string header = raw.substr(0, pos);
-    resp.body = raw.substr(pos + 4);
+    SocketType sock = connectTo(address_, port_);
+    if (sock == kInvalidSocket) {
+        if (error) *error = "connect failed";
+        // The cached address may be stale; resolve again on the next attempt.
+        resolved_ = false;
+        return false;
+    }
+    sock_ = static_cast<int>(sock);
+    readBuffer_.clear();
+    return true;
+}
+
+bool HttpClient::sendAll(const std::string& bytes) {
+    return sendAllTo(static_cast<SocketType>(sock_), bytes);
+}
 
-    std::istringstream headerStream(header);
+bool HttpClient::fillBuffer() {
+    char buffer[4096];
+    const int received = static_cast<int>(recv(static_cast<SocketType>(sock_), buffer, sizeof(buffer), 0));
+    if (received <= 0) return false;
+    readBuffer_.append(buffer, buffer + received);
+    return true;
+}
+
+HttpClient::ReadResult HttpClient::readResponse(HttpClientResponse& resp, bool& serverClosing) {
+    ResponseHead head;
+    ReadResult result = readHead(resp, head);
+    if (result == ReadResult::Ok) result = readBody(resp, head);
+    serverClosing = head.serverClosing;
+    return result;
+}
+
+HttpClient::ReadResult HttpClient::readHead(HttpClientResponse& resp, ResponseHead& head) {
+    bool receivedAny = !readBuffer_.empty();
+    std::size_t headerEnd;
+    while ((headerEnd = readBuffer_.find("\r\n\r\n")) == std::string::npos) {
+        if (!fillBuffer()) return receivedAny ? ReadResult::Failed : ReadResult::NoData;
+        receivedAny = true;
+    }
+
+    std::istringstream headerStream(readBuffer_.substr(0, headerEnd));
     std::string statusLine;
     std::getline(headerStream, statusLine);
     std::istringstream statusStream(statusLine);
     std::string httpVersion;
     statusStream >> httpVersion >> resp.status;
+    head.serverClosing = httpVersion != "HTTP/1.1";
+
+    std::string line;
+    while (std::getline(headerStream, line)) {
+        auto pos = line.find(':');
+        if (pos == std::string::npos) continue;
+        const std::string key = toLower(line.substr(0, pos));
+        const std::string value = toLower(line.substr(pos + 1));
+        if (key == "etag") {
+            // Opaque and case-sensitive, so taken from the line as sent.
+            const std::string raw = line.substr(pos + 1);
+            const auto first = raw.find_first_not_of(" \t");
+            const auto last = raw.find_last_not_of(" \t\r");
+            resp.etag = first == std::string::npos ? std::string() : raw.substr(first, last - first + 1);
+        } else if (key == "content-type") {
+            const auto first = value.find_first_not_of(" \t");
+            const auto last = value.find_last_not_of(" \t\r");
+            resp.contentType = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+            if (isBinaryMediaType(resp.contentType)) serverBinary_ = true;
+        } else if (key == "content-length") {
+            try {
+                head.contentLength = static_cast<std::size_t>(std::stoul(value));
+                head.hasLength = true;
+            } catch (...) {
+                head.hasLength = false;
+            }
+        } else if (key == "connection") {
+            if (value.find("close") != std::string::npos) head.serverClosing = true;
+            if (value.find("keep-alive") != std::string::npos) head.serverClosing = false;
+        }
+    }
+    head.bodyStart = headerEnd + 4;
+    return ReadResult::Ok;
+}
 
+HttpClient::ReadResult HttpClient::readBody(HttpClientResponse& resp, ResponseHead& head) {
+    if (resp.status == 304) {
+        // Never has a body, whatever the headers say.
+        readBuffer_.erase(0, head.bodyStart);
+        return ReadResult::Ok;
+    }
+    if (!head.hasLength) {
+        // No framing: the body runs until the server closes the connection.
+        while (fillBuffer()) {
+        }
+        resp.body = readBuffer_.substr(head.bodyStart);
+        readBuffer_.clear();
+        head.serverClosing = true;
+        return ReadResult::Ok;
+    }
+
+    while (readBuffer_.size() < head.bodyStart + head.contentLength) {
+        if (!fillBuffer()) return ReadResult::Failed;
+    }
+    resp.body = readBuffer_.substr(head.bodyStart, head.contentLength);
+    readBuffer_.erase(0, head.bodyStart + head.contentLength);
+    return ReadResult::Ok;
+}
+
+HttpClientResponse HttpClient::subscribe(const std::string& path, const EventHandler& onEvent) {
+    HttpClientResponse resp;
+    // Always a fresh connection: a kept-alive one could be closed under us mid-handshake, and
+    // the stream is never handed back for reuse anyway.
+    disconnect();
+    if (!ensureConnected(&resp.body)) return resp;
+    std::string wire = "GET " + path + " HTTP/1.1\r\nHost: " + host_ + "\r\nAccept: text/event-stream\r\n\r\n";
+    ResponseHead head;
+    if (!sendAll(wire) || readHead(resp, head) != ReadResult::Ok) {
+        disconnect();
+        resp.status = 0;
+        resp.body = "connection closed";
+        return resp;
+    }
+    if (resp.status != 200 || head.hasLength) {
+        if (readBody(resp, head) != ReadResult::Ok || head.serverClosing) disconnect();
+        return resp;
+    }
+
+    readBuffer_.erase(0, head.bodyStart);
+    std::string event;
+    std::string data;
+    bool comment = false;
+    for (;;) {
+        std::size_t eol;
+        while ((eol = readBuffer_.find('\n')) != std::string::npos) {
+            std::string line = readBuffer_.substr(0, eol);
+            readBuffer_.erase(0, eol + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) {
+                // Blank line dispatches the block collected so far.
+                const bool dispatch = comment || !data.empty() || !event.empty();
+                if (dispatch && !onEvent(event, data)) {
+                    disconnect();
+                    return resp;
+                }
+                event.clear();
+                data.clear();
+                comment = false;
+                continue;
+            }
+            if (line[0] == ':') {
+                comment = true;
+                continue;
+            }
+            const auto colon = line.find(':');
+            const std::string field = line.substr(0, colon);
+            std::string value = colon == std::string::npos ? std::string() : line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') value.erase(0, 1);
+            if (field == "event") {
+                event = value;
+            } else if (field == "data") {
+                if (!data.empty()) data += '\n';
+                data += value;
+            }
+        }
+        if (!fillBuffer()) break;
+    }
+    disconnect();
     return resp;
 }
+
+WebSocketClient::WebSocketClient(std::string host, int port) : host_(std::move(host)), port_(port) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+}
+
+WebSocketClient::~WebSocketClient() {
+    close();
+    if (sock_ != -1) closeSocket(static_cast<SocketType>(sock_.load()));
+}
+
+bool WebSocketClient::connect(const std::string& path, int* status, std::string* error) {
+    if (status) *status = 0;
+    if (sock_ != -1) return open_;
+
+    std::uint32_t address = 0;
+    if (!resolveHost(host_, address)) {
+        if (error) *error = "host not found";
+        return false;
+    }
+    SocketType sock = connectTo(address, port_);
+    if (sock == kInvalidSocket) {
+        if (error) *error = "connect failed";
+        return false;
+    }
+    sock_ = static_cast<int>(sock);
+
+    auto fail = [&](const char* reason) {
+        if (error) *error = reason;
+        shutdown(static_cast<SocketType>(sock_.load()), kShutdownBoth);
+        return false;
+    };
+
+    std::string nonce(16, '\0');
+    std::random_device rd;
+    for (auto& c : nonce) c = static_cast<char>(rd() & 0xFF);
+    const std::string key = base64Encode(nonce);
+    if (!sendRaw("GET " + path + " HTTP/1.1\r\nHost: " + host_ +
+                 "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + key +
+                 "\r\nSec-WebSocket-Version: 13\r\n\r\n")) {
+        return fail("send failed");
+    }
+
+    char buffer[4096];
+    std::size_t headerEnd;
+    while ((headerEnd = readBuffer_.find("\r\n\r\n")) == std::string::npos) {
+        const int received = static_cast<int>(recv(static_cast<SocketType>(sock_.load()), buffer, sizeof(buffer), 0));
+        if (received <= 0) return fail("connection closed");
+        readBuffer_.append(buffer, buffer + received);
+    }
+
+    std::istringstream headerStream(readBuffer_.substr(0, headerEnd));
+    std::string line;
+    std::getline(headerStream, line);
+    std::istringstream statusStream(line);
+    std::string httpVersion;
+    int code = 0;
+    statusStream >> httpVersion >> code;
+    if (status) *status = code;
+    if (code != 101) return fail("upgrade rejected");
+
+    std::string accept;
+    while (std::getline(headerStream, line)) {
+        auto pos = line.find(':');
+        if (pos == std::string::npos) continue;
+        if (toLower(line.substr(0, pos)) != "sec-websocket-accept") continue;
+        accept = line.substr(pos + 1);
+        accept.erase(0, accept.find_first_not_of(' '));
+        accept.erase(accept.find_last_not_of(" \r") + 1);
+    }
+    if (accept != webSocketAccept(key)) return fail("bad handshake");
+
+    // Anything after the handshake is already frame data.
+    readBuffer_.erase(0, headerEnd + 4);
+    open_ = true;
+    return true;
+}
+
+bool WebSocketClient::send(const std::string& message) {
+    if (!open_) return false;
+    return sendRaw(encodeWebSocketFrame(WebSocketOpcode::Text, message, true));
+}
+
+bool WebSocketClient::receive(std::string& message) {
+    char buffer[4096];
+    while (inboxNext_ >= inbox_.size()) {
+        inbox_.clear();
+        inboxNext_ = 0;
+        if (!open_) return false;
+        const int received = static_cast<int>(recv(static_cast<SocketType>(sock_.load()), buffer, sizeof(buffer), 0));
+        if (received <= 0) {
+            open_ = false;
+            return false;
+        }
+        readBuffer_.append(buffer, buffer + received);
+        std::string replies;
+        const bool stillOpen = reader_.read(readBuffer_, inbox_, replies);
+        if (!replies.empty()) sendRaw(replies);
+        // Messages that arrived ahead of a close frame are still handed out.
+        if (!stillOpen) open_ = false;
+    }
+    message = std::move(inbox_[inboxNext_++]);
+    return true;
+}
+
+void WebSocketClient::close() {
+    if (sock_ == -1) return;
+    if (open_.exchange(false)) {
+        sendRaw(encodeWebSocketFrame(WebSocketOpcode::Close, webSocketClosePayload(1000), true));
+    }
+    // Wakes a receive() blocked on another thread; the descriptor itself is closed on destruction.
+    shutdown(static_cast<SocketType>(sock_.load()), kShutdownBoth);
+}
+
+bool WebSocketClient::sendRaw(const std::string& bytes) {
+    std::lock_guard<std::mutex> lock(sendMutex_);
+    return sendAllTo(static_cast<SocketType>(sock_.load()), bytes);
+}
@@ -1,24 +1,152 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "websocket.h"
+
 struct HttpClientResponse {
     int status = 0;
     std::string body;
+    std::string etag = {};
+    // Empty for bodies that did not come over HTTP (e.g. a pushed state); treated as JSON.
+    std::string contentType = {};
+    // The server answered 304 to a conditional GET: status is 200 and body is the cached copy,
+    // unchanged since it was last returned.
+    bool notModified = false;
+
+    // The body as JSON, whichever wire format it arrived in; discarded when it does not decode.
+    nlohmann::json json() const;
+    // The body as JSON text, for messages shown to the user.
+    std::string text() const;
 };
 
+struct HttpClientRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+};
+
+// Keeps one persistent (keep-alive) connection to the server. The connection is opened lazily,
+// reopened when the server closes it, and a request that fails on a reused connection before
+// any response byte arrives is retried once on a fresh one.
 class HttpClient {
   public:
     HttpClient(std::string host, int port);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
 
+    // Remembers the ETag of recent 200 responses per path and revalidates with If-None-Match.
     HttpClientResponse get(const std::string& path);
     HttpClientResponse post(const std::string& path, const nlohmann::json& payload);
 
+    // Writes all requests back-to-back, then reads the responses in order (HTTP pipelining).
+    // Not conditional: the response cache is neither consulted nor filled.
+    // Requests that could not be answered come back with status 0.
+    std::vector<HttpClientResponse> pipeline(const std::vector<HttpClientRequest>& requests);
+
+    // Called once per Server-Sent Event; comment lines (keep-alives) arrive with an empty event
+    // and data. Returning false ends the subscription.
+    using EventHandler = std::function<bool(const std::string& event, const std::string& data)>;
+
+    // GETs a text/event-stream resource and feeds its events to onEvent until the handler
+    // returns false or the server ends the stream. The stream occupies the connection, which is
+    // closed afterwards. A non-200 (or non-streamed) reply is returned as-is with no callbacks.
+    HttpClientResponse subscribe(const std::string& path, const EventHandler& onEvent);
+
+    // Asks for application/x-rocoarena response bodies (see wire_format.h) and, once the server
+    // has answered in it, sends POST bodies that way too. Off by default.
+    void setBinary(bool enabled) { binary_ = enabled; }
+    bool binary() const { return binary_; }
+
+    void disconnect();
+
+    const std::string& host() const { return host_; }
+    int port() const { return port_; }
+
   private:
+    enum class ReadResult { Ok, NoData, Failed };
+
+    struct ResponseHead {
+        std::size_t bodyStart = 0;
+        bool hasLength = false;
+        std::size_t contentLength = 0;
+        bool serverClosing = false;
+    };
+
     HttpClientResponse sendRequest(const std::string& method, const std::string& path, const std::string& body);
+    std::vector<HttpClientResponse> exchange(const std::string& wire, std::size_t count);
+    bool ensureConnected(std::string* error);
+    bool sendAll(const std::string& bytes);
+    ReadResult readResponse(HttpClientResponse& resp, bool& serverClosing);
+    ReadResult readHead(HttpClientResponse& resp, ResponseHead& head);
+    ReadResult readBody(HttpClientResponse& resp, ResponseHead& head);
+    bool fillBuffer();
+    void appendRequest(std::string& out, const std::string& method, const std::string& path,
+                       const std::string& body, const std::string& ifNoneMatch = "",
+                       const std::string& contentType = "application/json") const;
+    void remember(const std::string& path, const HttpClientResponse& resp);
+
+    struct CachedResponse {
+        std::string etag;
+        std::string body;
+        std::string contentType;
+    };
+    static constexpr std::size_t kMaxCachedResponses = 32;
+
+    std::string host_;
+    int port_ = 0;
+    int sock_ = -1;
+    bool resolved_ = false;
+    std::uint32_t address_ = 0; // IPv4, network byte order
+    std::string readBuffer_;
+    bool binary_ = false;
+    bool serverBinary_ = false; // the server has answered in the binary format
+    std::unordered_map<std::string, CachedResponse> cache_;
+    std::deque<std::string> cacheOrder_; // oldest first, for eviction
+};
+
+// Client end of a WebSocket, opened with an HTTP/1.1 Upgrade on a connection of its own.
+// send() may be called from any thread while another one blocks in receive(); close() from a
+// third thread wakes that receive().
+class WebSocketClient {
+  public:
+    WebSocketClient(std::string host, int port);
+    ~WebSocketClient();
+
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    // Performs the opening handshake for `path`. On failure *status holds the HTTP status the
+    // server answered with (0 if it never answered), e.g. 404 from a server without the route.
+    bool connect(const std::string& path, int* status = nullptr, std::string* error = nullptr);
+    bool send(const std::string& message);
+    // Blocks until the next message arrives, answering pings on the way. Returns false once the
+    // connection is closed.
+    bool receive(std::string& message);
+    void close();
+    bool isOpen() const { return open_; }
+
+  private:
+    bool sendRaw(const std::string& bytes);
 
     std::string host_;
     int port_ = 0;
+    std::atomic<int> sock_{ -1 };
+    std::atomic<bool> open_{ false };
+    std::mutex sendMutex_;
+    std::string readBuffer_;
+    WebSocketReader reader_{ false };
+    std::vector<std::string> inbox_;
+    std::size_t inboxNext_ = 0;
 };
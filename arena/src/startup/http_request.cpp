@@ -0,0 +1,243 @@
+#include "http_request.h"
+
+#include <limits>
+
+namespace {
+char lowerAscii(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (lowerAscii(a[i]) != lowerAscii(b[i])) return false;
+    }
+    return true;
+}
+
+// RFC 9110 token characters, as allowed in methods and header names.
+bool isTokenChar(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return true;
+    switch (c) {
+        case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+':
+        case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isToken(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!isTokenChar(c)) return false;
+    }
+    return true;
+}
+
+std::string_view trimWhitespace(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// True if the comma-separated list `value` holds `token` (any case).
+bool listContains(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        const std::size_t comma = value.find(',');
+        if (equalsIgnoreCase(trimWhitespace(value.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool parseLength(std::string_view s, std::size_t& out) {
+    if (s.empty()) return false;
+    std::size_t value = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        const std::size_t digit = static_cast<std::size_t>(c - '0');
+        if (value > (std::numeric_limits<std::size_t>::max() - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    out = value;
+    return true;
+}
+
+// Value of one hex digit, or -1.
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool hasEscapes(std::string_view component) {
+    for (char c : component) {
+        if (c == '%' || c == '+') return true;
+    }
+    return false;
+}
+
+// Next line of the head starting at `pos`, without its line ending (CRLF or a bare LF).
+// False if the buffer ends before the line does.
+bool nextLine(std::string_view buffer, std::size_t& pos, std::string_view& line) {
+    const std::size_t end = buffer.find('\n', pos);
+    if (end == std::string_view::npos) return false;
+    line = buffer.substr(pos, end - pos);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    pos = end + 1;
+    return true;
+}
+} // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (std::size_t i = headerCount; i-- > 0;) {
+        if (equalsIgnoreCase(headers[i].name, name)) return headers[i].value;
+    }
+    return {};
+}
+
+HttpParseResult parseHttpRequest(std::string_view buffer, HttpRequest& req, std::size_t& length) {
+    req.method = req.path = req.query = req.body = {};
+    req.headerCount = 0;
+    req.keepAlive = req.upgrade = req.websocket = false;
+    length = 0;
+
+    std::size_t pos = 0;
+    std::string_view line;
+    if (!nextLine(buffer, pos, line)) return HttpParseResult::Incomplete;
+
+    // request-line = method SP request-target SP HTTP-version
+    const std::size_t methodEnd = line.find(' ');
+    if (methodEnd == std::string_view::npos) return HttpParseResult::Invalid;
+    const std::size_t targetEnd = line.find(' ', methodEnd + 1);
+    if (targetEnd == std::string_view::npos) return HttpParseResult::Invalid;
+    const std::string_view method = line.substr(0, methodEnd);
+    const std::string_view target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    const std::string_view version = line.substr(targetEnd + 1);
+    // A target of only a query ("?a=b") would leave the handler an empty path.
+    if (!isToken(method) || target.empty() || target.front() == '?') return HttpParseResult::Invalid;
+    for (char c : target) {
+        if (static_cast<unsigned char>(c) <= ' ' || c == 0x7F) return HttpParseResult::Invalid;
+    }
+    if (version == "HTTP/1.1") {
+        req.keepAlive = true;
+    } else if (version != "HTTP/1.0") {
+        return HttpParseResult::Invalid;
+    }
+
+    std::size_t contentLength = 0;
+    bool hasLength = false;
+    bool connectionUpgrade = false;
+    bool upgradeWebSocket = false;
+    bool hasWebSocketKey = false;
+    for (;;) {
+        if (!nextLine(buffer, pos, line)) return HttpParseResult::Incomplete;
+        if (line.empty()) break;
+        // No obsolete line folding, no whitespace between the name and the colon.
+        const std::size_t colon = line.find(':');
+        if (colon == std::string_view::npos) return HttpParseResult::Invalid;
+        const std::string_view name = line.substr(0, colon);
+        if (!isToken(name)) return HttpParseResult::Invalid;
+        if (req.headerCount == HttpRequest::kMaxHeaders) return HttpParseResult::Invalid;
+        const std::string_view value = trimWhitespace(line.substr(colon + 1));
+        req.headers[req.headerCount++] = HttpHeader{ name, value };
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            std::size_t parsed = 0;
+            if (!parseLength(value, parsed) || (hasLength && parsed != contentLength)) {
+                return HttpParseResult::Invalid;
+            }
+            contentLength = parsed;
+            hasLength = true;
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            return HttpParseResult::Invalid;
+        } else if (equalsIgnoreCase(name, "connection")) {
+            if (listContains(value, "close")) req.keepAlive = false;
+            if (listContains(value, "keep-alive")) req.keepAlive = true;
+            if (listContains(value, "upgrade")) connectionUpgrade = true;
+        } else if (equalsIgnoreCase(name, "upgrade")) {
+            req.upgrade = true;
+            upgradeWebSocket = equalsIgnoreCase(value, "websocket");
+        } else if (equalsIgnoreCase(name, "sec-websocket-key")) {
+            hasWebSocketKey = !value.empty();
+        }
+    }
+
+    if (contentLength > buffer.size() - pos) return HttpParseResult::Incomplete;
+    req.method = method;
+    const std::size_t question = target.find('?');
+    req.path = target.substr(0, question);
+    if (question != std::string_view::npos) req.query = target.substr(question + 1);
+    req.body = buffer.substr(pos, contentLength);
+    req.websocket = upgradeWebSocket && connectionUpgrade && hasWebSocketKey;
+    length = pos + contentLength;
+    return HttpParseResult::Complete;
+}
+
+QueryParams::QueryParams(std::string_view query) : querySize_(query.size()) {
+    while (!query.empty() && count_ < kMaxParams) {
+        const std::size_t amp = query.find('&');
+        const std::string_view pair = query.substr(0, amp);
+        query.remove_prefix(amp == std::string_view::npos ? query.size() : amp + 1);
+        const std::size_t eq = pair.find('=');
+        const std::string_view key = decode(pair.substr(0, eq));
+        if (key.empty()) continue;
+        const std::string_view value = eq == std::string_view::npos ? std::string_view() : decode(pair.substr(eq + 1));
+        params_[count_++] = Param{ key, value };
+    }
+}
+
+// application/x-www-form-urlencoded decoding; a '%' not followed by two hex digits stays as is.
+std::string_view QueryParams::decode(std::string_view component) {
+    if (!hasEscapes(component)) return component;
+    // Decoding never lengthens the query, so decoded_ is not reallocated under earlier views.
+    if (decoded_.empty()) decoded_.reserve(querySize_);
+    const std::size_t begin = decoded_.size();
+    for (std::size_t i = 0; i < component.size(); ++i) {
+        if (component[i] == '+') {
+            decoded_ += ' ';
+        } else if (component[i] == '%' && i + 2 < component.size() && hexValue(component[i + 1]) >= 0 &&
+                   hexValue(component[i + 2]) >= 0) {
+            decoded_ += static_cast<char>(hexValue(component[i + 1]) * 16 + hexValue(component[i + 2]));
+            i += 2;
+        } else {
+            decoded_ += component[i];
+        }
+    }
+    return std::string_view(decoded_).substr(begin);
+}
+
+std::string_view QueryParams::get(std::string_view key) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (params_[i].key == key) return params_[i].value;
+    }
+    return {};
+}
+
+bool QueryParams::has(std::string_view key) const {
+    for (std::size_t i = 0; i < count_; ++i) {
+        if (params_[i].key == key) return true;
+    }
+    return false;
+}
+
+std::string encodeQueryComponent(std::string_view value) {
+    static constexpr char kHex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        const auto byte = static_cast<unsigned char>(c);
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.' ||
+            c == '_' || c == '~') {
+            out += c;
+        } else {
+            out += '%';
+            out += kHex[byte >> 4];
+            out += kHex[byte & 0xF];
+        }
+    }
+    return out;
+}
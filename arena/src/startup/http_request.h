@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+struct HttpHeader {
+    std::string_view name; // as sent; compare case-insensitively
+    std::string_view value;
+};
+
+// One request parsed in place by parseHttpRequest(): every view points into the receive buffer,
+// which HttpServer keeps alive until the handler returns. Copy whatever has to outlive the
+// handler call (e.g. into a parked long-poll).
+struct HttpRequest {
+    static constexpr std::size_t kMaxHeaders = 64;
+
+    std::string_view method; // empty for a request that failed to parse
+    std::string_view path;
+    std::string_view query; // after '?', undecoded
+    std::string_view body;
+    std::array<HttpHeader, kMaxHeaders> headers{};
+    std::size_t headerCount = 0;
+    // The connection stays open afterwards (HTTP/1.1 default, HTTP/1.0 only with "keep-alive").
+    bool keepAlive = false;
+    // Carries an Upgrade header: nothing after it on the connection is HTTP.
+    bool upgrade = false;
+    // Valid WebSocket opening handshake ("Upgrade: websocket" with a Sec-WebSocket-Key).
+    bool websocket = false;
+
+    // Value of the named header (any case), or empty; a repeated header yields its last value.
+    std::string_view header(std::string_view name) const;
+};
+
+enum class HttpParseResult { Complete, Incomplete, Invalid };
+
+// Parses the request at the start of `buffer` in a single pass, without allocating. On Complete,
+// `length` is the number of bytes it occupies (head and Content-Length body). Invalid covers a
+// malformed request line or header, more than kMaxHeaders headers, a bad or conflicting
+// Content-Length and Transfer-Encoding (bodies must be Content-Length framed).
+HttpParseResult parseHttpRequest(std::string_view buffer, HttpRequest& req, std::size_t& length);
+
+// A query string decoded once: split on '&' and '=', with %XX escapes and '+' (a space) decoded,
+// into a small flat array that get() scans. Keys match exactly, so "name" never finds "roomname".
+// A key without '=' has an empty value; of repeated keys the first wins, and pairs beyond
+// kMaxParams are ignored. Components without escapes are views into the query string, which
+// must outlive this object; only escaped ones are decoded into storage of its own.
+class QueryParams {
+  public:
+    static constexpr std::size_t kMaxParams = 16;
+
+    QueryParams() = default;
+    explicit QueryParams(std::string_view query);
+    // The views into decoded_ would dangle in a copy.
+    QueryParams(const QueryParams&) = delete;
+    QueryParams& operator=(const QueryParams&) = delete;
+
+    // Decoded value of `key`, or empty when it is absent.
+    std::string_view get(std::string_view key) const;
+    bool has(std::string_view key) const;
+    std::size_t size() const { return count_; }
+
+  private:
+    struct Param {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    std::string_view decode(std::string_view component);
+
+    std::array<Param, kMaxParams> params_{};
+    std::size_t count_ = 0;
+    std::size_t querySize_ = 0;
+    std::string decoded_;
+};
+
+// Percent-encodes all but RFC 3986 unreserved characters, for one key or value of a query string.
+std::string encodeQueryComponent(std::string_view value);
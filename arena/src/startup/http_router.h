@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+struct RouteKey {
+    std::string_view method;
+    std::string_view path;
+};
+
+// A fixed set of routes hashed without collisions, built at compile time: the constructor tries
+// seeds until every method+path lands in its own slot, so a lookup is one hash, one slot read and
+// one comparison whatever the number of routes. Declare it constexpr and static_assert valid().
+template <std::size_t N>
+class RouteTable {
+  public:
+    static constexpr std::size_t kNoRoute = N;
+
+    constexpr explicit RouteTable(const std::array<RouteKey, N>& routes) : routes_(routes) {
+        for (std::uint32_t seed = 0; seed < kMaxSeeds; ++seed) {
+            if (tryPlace(seed)) {
+                seed_ = seed;
+                valid_ = true;
+                return;
+            }
+        }
+    }
+
+    // False if no seed separates the routes (e.g. one is listed twice).
+    constexpr bool valid() const { return valid_; }
+
+    // Index of the route in the array the table was built from, or kNoRoute.
+    constexpr std::size_t find(std::string_view method, std::string_view path) const {
+        const std::size_t index = slots_[slotOf(method, path, seed_)];
+        if (index == kNoRoute) return kNoRoute;
+        return routes_[index].method == method && routes_[index].path == path ? index : kNoRoute;
+    }
+
+    constexpr const RouteKey& operator[](std::size_t index) const { return routes_[index]; }
+    static constexpr std::size_t size() { return N; }
+
+  private:
+    static constexpr std::uint32_t kMaxSeeds = 4096;
+
+    // Smallest power of two at least twice the route count.
+    static constexpr std::size_t slotCount() {
+        std::size_t slots = 1;
+        while (slots < 2 * N) slots *= 2;
+        return slots;
+    }
+    static constexpr std::size_t kSlots = slotCount();
+
+    static constexpr std::size_t slotOf(std::string_view method, std::string_view path, std::uint32_t seed) {
+        std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u); // FNV-1a, seeded
+        for (char c : method) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        hash = (hash ^ ' ') * 16777619u;
+        for (char c : path) hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        hash ^= hash >> 15; // FNV's low bits mix poorly; the slot is taken from them
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return hash & (kSlots - 1);
+    }
+
+    constexpr bool tryPlace(std::uint32_t seed) {
+        for (std::size_t slot = 0; slot < kSlots; ++slot) slots_[slot] = kNoRoute;
+        for (std::size_t index = 0; index < N; ++index) {
+            const std::size_t slot = slotOf(routes_[index].method, routes_[index].path, seed);
+            if (slots_[slot] != kNoRoute) return false;
+            slots_[slot] = index;
+        }
+        return true;
+    }
+
+    std::array<RouteKey, N> routes_;
+    std::array<std::size_t, kSlots> slots_{};
+    std::uint32_t seed_ = 0;
+    bool valid_ = false;
+};
+
+// Callbacks for the routes of a RouteTable, indexed like it. Unknown routes and routes without a
+// callback both come back as nullptr, so the caller answers them 404.
+template <typename Callback, std::size_t N>
+class Router {
+  public:
+    explicit Router(const RouteTable<N>& table) : table_(table) {}
+
+    // Registers the callback of a route the table holds; anything else marks the router incomplete.
+    void on(std::string_view method, std::string_view path, Callback callback) {
+        const std::size_t index = table_.find(method, path);
+        if (index == RouteTable<N>::kNoRoute) {
+            unknown_ = true;
+            return;
+        }
+        callbacks_[index] = std::move(callback);
+    }
+
+    // True once every route has a callback and none was registered for a route not in the table.
+    bool complete() const {
+        if (unknown_) return false;
+        for (const Callback& callback : callbacks_) {
+            if (!callback) return false;
+        }
+        return true;
+    }
+
+    std::size_t find(std::string_view method, std::string_view path) const { return table_.find(method, path); }
+
+    // Callback of a route index returned by find(), or nullptr.
+    const Callback* route(std::size_t index) const {
+        return index < N && callbacks_[index] ? &callbacks_[index] : nullptr;
+    }
+
+  private:
+    const RouteTable<N>& table_;
+    std::array<Callback, N> callbacks_{};
+    bool unknown_ = false;
+};
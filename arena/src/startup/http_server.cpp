@@ -1,10 +1,17 @@
 #include "http_server.h"
 
 #include <algorithm>
-#include <cctype>
+#include <cerrno>
+#include <condition_variable>
 #include <cstring>
-#include <sstream>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+
+#include "websocket.h"
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -13,29 +20,19 @@
 #else
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
 
-namespace {
-std::string toLower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
-    return s;
-}
-
-std::string trim(const std::string& s) {
-    auto start = s.find_first_not_of(" \t\r\n");
-    auto end = s.find_last_not_of(" \t\r\n");
-    if (start == std::string::npos) return {};
-    return s.substr(start, end - start + 1);
-}
-
-std::string getHeaderValue(const std::unordered_map<std::string, std::string>& headers, const std::string& key) {
-    auto it = headers.find(toLower(key));
-    if (it == headers.end()) return {};
-    return it->second;
-}
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define ROCOARENA_HAS_EPOLL 1
+#endif
 
+namespace {
 #ifdef _WIN32
 using SocketType = SOCKET;
 constexpr SocketType kInvalidSocket = INVALID_SOCKET;
@@ -44,6 +41,12 @@ using SocketType = int;
 constexpr SocketType kInvalidSocket = -1;
 #endif
 
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
 void closeSocket(SocketType fd) {
 #ifdef _WIN32
     closesocket(fd);
@@ -51,15 +54,970 @@ void closeSocket(SocketType fd) {
     close(fd);
 #endif
 }
+
+const char* statusText(int status) {
+    switch (status) {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "OK";
+    }
+}
+
+// Status line and headers of `resp`, up to and including the blank line.
+void appendHead(std::string& out, const HttpResponse& resp, bool keepAlive) {
+    out += "HTTP/1.1 ";
+    out += std::to_string(resp.status);
+    out += ' ';
+    out += statusText(resp.status);
+    for (const auto& [name, value] : resp.headers) {
+        out += "\r\n";
+        out += name;
+        out += ": ";
+        out += value;
+    }
+    if (resp.status == 101) {
+        // Switching protocols: no body, the connection now speaks whatever was negotiated.
+        out += "\r\n\r\n";
+        return;
+    }
+    if (resp.status == 304) {
+        // Not Modified never carries a body (nor a Content-Length describing this one).
+        out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        return;
+    }
+    out += "\r\nContent-Type: ";
+    out += resp.contentType;
+    if (resp.stream) {
+        // Body runs until the connection closes.
+        out += "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n";
+        return;
+    }
+    out += "\r\nContent-Length: ";
+    out += std::to_string(resp.body.size());
+    out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+}
+
+// What the server answers by itself when it turns work away.
+HttpResponse overloadedResponse() {
+    HttpResponse resp{ 503, "{\"error\":\"server busy\"}" };
+    resp.headers.emplace_back("Retry-After", "1");
+    return resp;
+}
+
+HttpResponse invalidRequestResponse() {
+    return HttpResponse{ 400, "{\"error\":\"invalid request\"}" };
+}
+
+HttpResponse tooLargeResponse() {
+    return HttpResponse{ 413, "{\"error\":\"request too large\"}" };
+}
+
+// Answers a connection over the limit with a 503 and closes it, without reading its request.
+// Best effort: the socket is new, so the few bytes fit its send buffer.
+void refuseConnection(SocketType fd) {
+    HttpResponse resp = overloadedResponse();
+    std::string bytes;
+    appendHead(bytes, resp, false);
+    bytes += resp.body;
+    [[maybe_unused]] const auto sent = send(fd, bytes.data(), static_cast<int>(bytes.size()), kSendFlags);
+    closeSocket(fd);
+}
+
+// Bounds blocking recv/send on a thread-per-connection socket; 0 waits forever.
+void setSocketTimeout(SocketType fd, std::chrono::milliseconds timeout) {
+#ifdef _WIN32
+    const DWORD value = static_cast<DWORD>(timeout.count());
+#else
+    timeval value{};
+    value.tv_sec = static_cast<decltype(value.tv_sec)>(timeout.count() / 1000);
+    value.tv_usec = static_cast<decltype(value.tv_usec)>(timeout.count() % 1000 * 1000);
+#endif
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Output waiting to be written to one connection. Response heads are formatted into a buffer the
+// writer owns and reuses once everything queued has gone out; bodies are moved in and handed to
+// the kernel where they are, head and body together in one scatter-gather sendmsg(). A short
+// write just advances the position in the queue, so the rest goes out on the next call.
+class ResponseWriter {
+  public:
+    enum class Result { Done, Blocked, Failed };
+
+    // Queues status line, headers and body; the body is moved out of `resp`.
+    void appendResponse(HttpResponse&& resp, bool keepAlive) {
+        Chunk chunk;
+        chunk.headBegin = head_.size();
+        appendHead(head_, resp, keepAlive);
+        chunk.headEnd = head_.size();
+        if (resp.status != 101 && resp.status != 304) chunk.body = std::move(resp.body);
+        push(std::move(chunk));
+    }
+
+    // Queues bytes that go out as they are (stream data, WebSocket frames).
+    void append(std::string bytes) {
+        if (bytes.empty()) return;
+        Chunk chunk;
+        chunk.headBegin = chunk.headEnd = head_.size();
+        chunk.body = std::move(bytes);
+        push(std::move(chunk));
+    }
+
+    bool empty() const { return chunks_.empty(); }
+    std::size_t pending() const { return pending_; }
+
+    // Writes until the queue is empty (Done), the socket would block (Blocked) or fails.
+    Result writeTo(SocketType fd) {
+        while (!chunks_.empty()) {
+            Slice slices[kMaxSlices];
+            const std::size_t count = gather(slices);
+#ifdef _WIN32
+            (void)count;
+            const int sent = send(fd, slices[0].data, static_cast<int>(slices[0].size), 0);
+            if (sent > 0) {
+                consume(static_cast<std::size_t>(sent));
+                continue;
+            }
+            if (sent < 0 && WSAGetLastError() == WSAEWOULDBLOCK) return Result::Blocked;
+            return Result::Failed;
+#else
+            iovec iov[kMaxSlices];
+            for (std::size_t i = 0; i < count; ++i) {
+                iov[i].iov_base = const_cast<char*>(slices[i].data);
+                iov[i].iov_len = slices[i].size;
+            }
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            const ssize_t sent = sendmsg(fd, &msg, kSendFlags);
+            if (sent > 0) {
+                consume(static_cast<std::size_t>(sent));
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return Result::Blocked;
+            return Result::Failed;
+#endif
+        }
+        return Result::Done;
+    }
+
+  private:
+    // A response (a slice of head_ plus its body) or raw bytes (empty head slice).
+    struct Chunk {
+        std::size_t headBegin = 0;
+        std::size_t headEnd = 0;
+        std::string body;
+
+        std::size_t size() const { return headEnd - headBegin + body.size(); }
+    };
+
+    struct Slice {
+        const char* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Enough for 32 pipelined responses per system call.
+    static constexpr std::size_t kMaxSlices = 64;
+
+    void push(Chunk chunk) {
+        pending_ += chunk.size();
+        chunks_.push_back(std::move(chunk));
+    }
+
+    // The unsent bytes at the front of the queue, as at most kMaxSlices non-empty pieces.
+    std::size_t gather(Slice (&slices)[kMaxSlices]) const {
+        std::size_t count = 0;
+        std::size_t skip = sent_;
+        auto add = [&](const char* data, std::size_t size) {
+            if (skip >= size) {
+                skip -= size;
+                return;
+            }
+            slices[count++] = Slice{ data + skip, size - skip };
+            skip = 0;
+        };
+        for (auto it = chunks_.begin(); it != chunks_.end() && count + 2 <= kMaxSlices; ++it) {
+            add(head_.data() + it->headBegin, it->headEnd - it->headBegin);
+            add(it->body.data(), it->body.size());
+        }
+        return count;
+    }
+
+    void consume(std::size_t bytes) {
+        pending_ -= bytes;
+        sent_ += bytes;
+        while (!chunks_.empty() && sent_ >= chunks_.front().size()) {
+            sent_ -= chunks_.front().size();
+            chunks_.pop_front();
+        }
+        if (chunks_.empty()) head_.clear(); // keeps its capacity for the next responses
+    }
+
+    std::string head_;
+    std::deque<Chunk> chunks_;
+    std::size_t sent_ = 0; // bytes of chunks_.front() already written
+    std::size_t pending_ = 0;
+};
+
 } // namespace
 
-HttpServer::HttpServer(int port) : port_(port) {}
+bool HttpStream::send(const std::string& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return false;
+    if (!sink_) {
+        pending_ += data;
+        return true;
+    }
+    if (!sink_(data, false)) {
+        closed_ = true;
+        sink_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void HttpStream::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    closed_ = true;
+    if (sink_) {
+        sink_({}, true);
+        sink_ = nullptr;
+    } else {
+        endPending_ = true;
+    }
+}
+
+bool HttpStream::isOpen() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !closed_;
+}
+
+void HttpStream::attach(Sink sink) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_.empty()) {
+        sink(pending_, false);
+        pending_.clear();
+    }
+    if (endPending_) {
+        endPending_ = false;
+        sink({}, true);
+        return;
+    }
+    if (closed_) return;
+    sink_ = std::move(sink);
+}
+
+void HttpStream::detach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    endPending_ = false;
+    sink_ = nullptr;
+    pending_.clear();
+}
+
+WebSocket::WebSocket(MessageHandler onMessage)
+    : onMessage_(std::move(onMessage)), stream_(std::make_shared<HttpStream>()) {}
+
+bool WebSocket::send(const std::string& message) {
+    return stream_->send(encodeWebSocketFrame(WebSocketOpcode::Text, message, false));
+}
+
+bool WebSocket::ping() {
+    return stream_->send(encodeWebSocketFrame(WebSocketOpcode::Ping, {}, false));
+}
+
+void WebSocket::close(std::uint16_t code) {
+    stream_->send(encodeWebSocketFrame(WebSocketOpcode::Close, webSocketClosePayload(code), false));
+    stream_->close();
+}
+
+bool WebSocket::isOpen() const {
+    return stream_->isOpen();
+}
+
+void WebSocket::deliver(const std::string& message) {
+    if (onMessage_) onMessage_(*this, message);
+}
+
+#ifdef ROCOARENA_HAS_EPOLL
+// Edge-triggered epoll reactor. The reactor thread owns every connection: it accepts, reads
+// into per-connection buffers and writes responses. Complete requests are handed to a fixed
+// worker pool that runs the handler; finished responses come back through a completion queue
+// and an eventfd wake-up, so sockets are only ever touched by the reactor thread.
+//
+// Connections are persistent (HTTP/1.1 keep-alive). At most one task per connection is in
+// flight; every complete request already buffered when it is dispatched (pipelining) goes into
+// that task, so the responses are produced in order and written back together by the
+// connection's ResponseWriter.
+// A streaming response turns the connection into a one-way pipe fed by its HttpStream; an
+// accepted WebSocket upgrade additionally parses incoming frames and hands whole messages to the
+// worker pool, again one task per connection at a time so they are delivered in order.
+// Admission control (HttpServerOptions) is enforced here: connections over the limit are refused
+// at accept, a full task queue is answered 503 by the loop itself, and connections the server is
+// waiting on are closed once their read deadline passes.
+struct HttpServer::Reactor {
+    using Clock = std::chrono::steady_clock;
+
+    // A connection the server is waiting on (for a request, or to drain a response). Every entry
+    // gets the same timeout, so appending keeps the list ordered by deadline.
+    struct Waiting {
+        std::uint64_t connId = 0;
+        Clock::time_point deadline;
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        ResponseWriter out;
+        bool busy = false;            // a task for this connection is queued or running
+        bool closeAfterWrite = false; // last response carried "Connection: close"
+        bool peerClosed = false;      // read side saw EOF; finish pending responses, then close
+        bool readPaused = false;      // receive() stopped before EAGAIN; resume once not busy
+        bool writeArmed = false;      // EPOLLOUT registered after a short write
+        std::shared_ptr<HttpStream> stream;
+        std::shared_ptr<WebSocket> websocket;
+        WebSocketReader wsReader{ true };
+        std::vector<std::string> inbox; // WebSocket messages waiting for a worker
+        std::size_t inboxBytes = 0;     // payload bytes in `inbox`
+        bool waiting = false;           // has an entry in `waiting`, at waitPos
+        std::list<Waiting>::iterator waitPos;
+    };
+
+    // A slow consumer that lets this much stream output pile up is disconnected.
+    static constexpr std::size_t kMaxStreamBacklog = 4 * 1024 * 1024;
+    // A WebSocket peer this far ahead of its message handler (unparsed bytes plus queued
+    // messages) is not read until the handler catches up.
+    static constexpr std::size_t kMaxWebSocketBacklog = 4 * kMaxWebSocketMessage;
+
+    // Either a batch of HTTP requests or, on an upgraded connection, a batch of WebSocket messages.
+    struct Task {
+        std::uint64_t connId = 0;
+        // Bytes the requests were parsed from; their views point into it, so it is held on the
+        // heap where moving the task cannot relocate it.
+        std::unique_ptr<std::string> buffer;
+        std::vector<HttpRequest> requests;
+        std::shared_ptr<WebSocket> websocket;
+        std::vector<std::string> messages;
+    };
+
+    struct Completion {
+        enum class Kind { Response, StreamData, StreamEnd, MessagesDone };
+        Kind kind = Kind::Response;
+        std::uint64_t connId = 0;
+        std::vector<HttpResponse> responses; // Response: the batch, in request order
+        std::vector<bool> keepAlive;         // Response: per entry of `responses`
+        std::string bytes;                   // StreamData
+        bool close = false;
+        std::shared_ptr<HttpStream> stream;       // Response only: switch the connection to streaming
+        std::shared_ptr<WebSocket> websocket;     // Response only: the stream carries this WebSocket
+    };
+
+    // Shared with responders so a deferred response that fires after stop() is dropped instead
+    // of touching a destroyed reactor.
+    struct CompletionQueue {
+        std::mutex mutex;
+        std::vector<Completion> done;
+        int wakeFd = -1;
+        bool open = true;
+
+        bool push(Completion completion) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!open) return false;
+            done.push_back(std::move(completion));
+            std::uint64_t one = 1;
+            [[maybe_unused]] ssize_t n = write(wakeFd, &one, sizeof(one));
+            return true;
+        }
+    };
+
+    // Responses of one pipelined batch, filled in by responders in any order and posted as a
+    // single completion once every slot is set. Responses after a streaming one are dropped.
+    struct PendingBatch {
+        std::mutex mutex;
+        std::uint64_t connId = 0;
+        std::vector<HttpResponse> responses;
+        std::vector<bool> filled;
+        std::vector<bool> keepAlive;
+        std::size_t remaining = 0;
+
+        void complete(std::size_t index, HttpResponse resp, CompletionQueue& queue) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (filled[index]) return;
+            filled[index] = true;
+            responses[index] = std::move(resp);
+            if (--remaining > 0) return;
+            Completion completion;
+            completion.connId = connId;
+            completion.close = !keepAlive.back();
+            for (std::size_t i = 0; i < responses.size(); ++i) {
+                const std::shared_ptr<HttpStream> stream = responses[i].stream;
+                const std::shared_ptr<WebSocket> websocket = responses[i].websocket;
+                completion.responses.push_back(std::move(responses[i]));
+                completion.keepAlive.push_back(keepAlive[i]);
+                if (stream) {
+                    completion.stream = stream;
+                    completion.websocket = websocket;
+                    completion.close = false;
+                    break;
+                }
+            }
+            const std::shared_ptr<HttpStream> stream = completion.stream;
+            if (!queue.push(std::move(completion)) && stream) {
+                stream->detach();
+            }
+        }
+    };
+
+    static constexpr std::uint64_t kListenId = 0;
+    static constexpr std::uint64_t kWakeId = 1;
+
+    HttpServer& server;
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::uint64_t nextId = 2;
+    std::unordered_map<std::uint64_t, Connection> conns;
+    std::list<Waiting> waiting;
+    std::thread loopThread;
+    std::vector<std::thread> workers;
+
+    std::mutex taskMutex;
+    std::condition_variable taskCv;
+    std::deque<Task> tasks;
+    bool stopping = false;
+
+    std::shared_ptr<CompletionQueue> completions = std::make_shared<CompletionQueue>();
+
+    explicit Reactor(HttpServer& owner) : server(owner) {}
+
+    bool start(std::string* error) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) {
+            if (error) *error = "epoll setup failed";
+            return false;
+        }
+        completions->wakeFd = wakeFd;
+        fcntl(server.serverFd_, F_SETFL, fcntl(server.serverFd_, F_GETFL, 0) | O_NONBLOCK);
+        if (!watch(server.serverFd_, kListenId, EPOLLIN | EPOLLET, EPOLL_CTL_ADD) ||
+            !watch(wakeFd, kWakeId, EPOLLIN | EPOLLET, EPOLL_CTL_ADD)) {
+            if (error) *error = "epoll_ctl failed";
+            return false;
+        }
+
+        std::size_t workerCount = server.options_.workerThreads;
+        if (workerCount == 0) workerCount = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+        loopThread = std::thread([this]() { eventLoop(); });
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            stopping = true;
+        }
+        taskCv.notify_all();
+        wake();
+        if (loopThread.joinable()) loopThread.join();
+        for (auto& worker : workers) {
+            if (worker.joinable()) worker.join();
+        }
+        workers.clear();
+        {
+            std::lock_guard<std::mutex> lock(completions->mutex);
+            completions->open = false;
+        }
+        for (auto& [id, conn] : conns) {
+            close(conn.fd);
+        }
+        conns.clear();
+        waiting.clear();
+        if (wakeFd >= 0) close(wakeFd);
+        if (epollFd >= 0) close(epollFd);
+        wakeFd = epollFd = -1;
+    }
+
+    bool watch(int fd, std::uint64_t id, std::uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        return epoll_ctl(epollFd, op, fd, &ev) == 0;
+    }
+
+    void wake() {
+        std::uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wakeFd, &one, sizeof(one));
+    }
+
+    void workerLoop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(taskMutex);
+                taskCv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            if (task.websocket) {
+                for (const auto& message : task.messages) {
+                    task.websocket->deliver(message);
+                }
+                Completion done;
+                done.kind = Completion::Kind::MessagesDone;
+                done.connId = task.connId;
+                completions->push(std::move(done));
+                continue;
+            }
+            auto batch = std::make_shared<PendingBatch>();
+            batch->connId = task.connId;
+            batch->responses.resize(task.requests.size());
+            batch->filled.assign(task.requests.size(), false);
+            batch->keepAlive.resize(task.requests.size());
+            for (std::size_t i = 0; i < task.requests.size(); ++i) batch->keepAlive[i] = task.requests[i].keepAlive;
+            batch->remaining = task.requests.size();
+            for (std::size_t i = 0; i < task.requests.size(); ++i) {
+                server.handleRequest(task.requests[i], [batch, queue = completions, i](HttpResponse resp) {
+                    batch->complete(i, std::move(resp), *queue);
+                });
+            }
+        }
+    }
+
+    void eventLoop() {
+        std::vector<epoll_event> events(256);
+        while (server.running_) {
+            const int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), waitTimeoutMs());
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                const std::uint64_t id = events[i].data.u64;
+                if (id == kListenId) {
+                    acceptAll();
+                } else if (id == kWakeId) {
+                    std::uint64_t counter = 0;
+                    while (read(wakeFd, &counter, sizeof(counter)) > 0) {
+                    }
+                    drainCompletions();
+                } else {
+                    onConnectionEvent(id, events[i].events);
+                }
+            }
+            expireWaiting();
+        }
+    }
+
+    // Until the earliest read deadline, rounded up so the loop never wakes just before it.
+    int waitTimeoutMs() const {
+        if (waiting.empty()) return -1;
+        const auto left = waiting.front().deadline - Clock::now();
+        if (left <= Clock::duration::zero()) return 0;
+        return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(left).count());
+    }
+
+    void expireWaiting() {
+        const auto now = Clock::now();
+        while (!waiting.empty() && waiting.front().deadline <= now) {
+            closeConnection(waiting.front().connId);
+        }
+    }
+
+    // (Re)starts the connection's read deadline.
+    void expectPeer(std::uint64_t id, Connection& conn) {
+        const auto timeout = server.options_.readTimeout;
+        if (timeout <= std::chrono::milliseconds::zero()) return;
+        stopWaiting(conn);
+        conn.waitPos = waiting.insert(waiting.end(), Waiting{ id, Clock::now() + timeout });
+        conn.waiting = true;
+    }
+
+    void stopWaiting(Connection& conn) {
+        if (!conn.waiting) return;
+        waiting.erase(conn.waitPos);
+        conn.waiting = false;
+    }
+
+    void acceptAll() {
+        for (;;) {
+            const int fd = accept4(server.serverFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                return; // EAGAIN: backlog drained; anything else: retry on the next edge
+            }
+            const std::size_t maxConnections = server.options_.maxConnections;
+            if (maxConnections > 0 && conns.size() >= maxConnections) {
+                refuseConnection(fd);
+                continue;
+            }
+            const std::uint64_t id = nextId++;
+            if (!watch(fd, id, EPOLLIN | EPOLLRDHUP | EPOLLET, EPOLL_CTL_ADD)) {
+                close(fd);
+                continue;
+            }
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            Connection conn;
+            conn.fd = fd;
+            expectPeer(id, conns.emplace(id, std::move(conn)).first->second);
+        }
+    }
+
+    void closeConnection(std::uint64_t id) {
+        auto it = conns.find(id);
+        if (it == conns.end()) return;
+        if (it->second.stream) it->second.stream->detach();
+        stopWaiting(it->second);
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        conns.erase(it);
+    }
+
+    void onConnectionEvent(std::uint64_t id, std::uint32_t events) {
+        auto it = conns.find(id);
+        if (it == conns.end()) return;
+        Connection& conn = it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeConnection(id);
+            return;
+        }
+        if (events & EPOLLOUT) {
+            if (!flush(id, conn)) return;
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP)) {
+            if (!receive(id, conn)) return;
+            if (conn.websocket) {
+                readWebSocket(id, conn);
+                return;
+            }
+            if (conn.stream && conn.peerClosed) {
+                closeConnection(id);
+                return;
+            }
+            dispatch(id, conn);
+        }
+    }
+
+    // Reads what the socket holds into `in`. Once more than maxRequestBytes is buffered (on a
+    // WebSocket, kMaxWebSocketBacklog counting the inbox), reading pauses instead; the size limit
+    // itself is per request, see dispatch(). The rest stays in the kernel, which also holds the
+    // peer back, until the connection's task completes and reading resumes. Edge-triggered, so a
+    // paused connection gets no new EPOLLIN for what is already there. A streaming response never
+    // reads requests again, so its input is discarded. Returns false if the connection was closed.
+    bool receive(std::uint64_t id, Connection& conn) {
+        const bool discard = conn.stream && !conn.websocket;
+        const std::size_t maxBuffered = discard         ? 0
+                                        : conn.websocket ? kMaxWebSocketBacklog
+                                                         : server.options_.maxRequestBytes;
+        conn.readPaused = false;
+        char buffer[4096];
+        for (;;) {
+            if (maxBuffered > 0 && conn.in.size() + conn.inboxBytes > maxBuffered) {
+                conn.readPaused = true;
+                return true;
+            }
+            const ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                if (!discard) conn.in.append(buffer, static_cast<std::size_t>(received));
+                continue;
+            }
+            if (received == 0) {
+                conn.peerClosed = true;
+                return true;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+            closeConnection(id);
+            return false;
+        }
+    }
+
+    // Queues every complete buffered request as one task. The receive buffer moves into the task
+    // and each request is parsed exactly once, in place; only bytes of a trailing partial request
+    // are copied back. A request over maxRequestBytes is answered 413 once those before it are,
+    // and when the task queue is full the batch is answered 503 here instead. Returns false if the
+    // connection was closed.
+    bool dispatch(std::uint64_t id, Connection& conn) {
+        if (conn.busy || conn.in.empty()) return dispatchNothing(id, conn);
+        Task task;
+        task.connId = id;
+        task.buffer = std::make_unique<std::string>(std::move(conn.in));
+        conn.in.clear();
+        const std::string_view buffer = *task.buffer;
+        const std::size_t maxRequest = server.options_.maxRequestBytes;
+        std::size_t consumed = 0;
+        bool tooLarge = false;
+        for (;;) {
+            HttpRequest req;
+            std::size_t length = 0;
+            const HttpParseResult result = parseHttpRequest(buffer.substr(consumed), req, length);
+            if (result == HttpParseResult::Incomplete) {
+                tooLarge = maxRequest > 0 && buffer.size() - consumed > maxRequest;
+                break;
+            }
+            if (result == HttpParseResult::Complete && maxRequest > 0 && length > maxRequest) {
+                tooLarge = true;
+                break;
+            }
+            if (result == HttpParseResult::Invalid) {
+                // Answered 400 and the connection closed (keepAlive is false); the rest is dropped.
+                task.requests.emplace_back();
+                consumed = buffer.size();
+                break;
+            }
+            consumed += length;
+            task.requests.push_back(req);
+            if (req.upgrade) {
+                // Bytes after an upgrade belong to the new protocol (or the connection closes).
+                break;
+            }
+            if (!req.keepAlive) {
+                // Anything pipelined after "Connection: close" is never answered.
+                consumed = buffer.size();
+                break;
+            }
+        }
+        if (task.requests.empty()) {
+            conn.in = std::move(*task.buffer);
+            if (tooLarge) {
+                conn.in.clear();
+                conn.out.appendResponse(tooLargeResponse(), false);
+                conn.closeAfterWrite = true;
+                return flush(id, conn);
+            }
+            return dispatchNothing(id, conn);
+        }
+        conn.in.assign(buffer.substr(consumed));
+        const std::size_t maxQueued = server.options_.maxQueuedRequests;
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            if (maxQueued == 0 || tasks.size() < maxQueued) {
+                tasks.push_back(std::move(task));
+                queued = true;
+            }
+        }
+        if (!queued) return shed(id, conn, task);
+        taskCv.notify_one();
+        conn.busy = true;
+        stopWaiting(conn);
+        return true;
+    }
+
+    // Answers every request of a batch that found the task queue full with a 503, so the client
+    // learns right away to back off rather than waiting behind work the workers cannot reach.
+    // A request that failed to parse still gets its 400 (and the close that goes with it).
+    bool shed(std::uint64_t id, Connection& conn, const Task& task) {
+        for (const auto& req : task.requests) {
+            conn.out.appendResponse(req.method.empty() ? invalidRequestResponse() : overloadedResponse(),
+                                    req.keepAlive);
+        }
+        conn.closeAfterWrite = !task.requests.back().keepAlive;
+        return flush(id, conn);
+    }
+
+    bool dispatchNothing(std::uint64_t id, Connection& conn) {
+        if (!conn.busy && conn.peerClosed) {
+            closeConnection(id);
+            return false;
+        }
+        return true;
+    }
+
+    // Parses buffered frames on an upgraded connection, answers control frames and queues
+    // complete messages for the workers. Reading resumes here if receive() paused and nothing is
+    // left waiting on a worker (e.g. the backlog was all control frames).
+    void readWebSocket(std::uint64_t id, Connection& conn) {
+        for (;;) {
+            std::string replies;
+            const std::size_t before = conn.inbox.size();
+            const bool open = conn.wsReader.read(conn.in, conn.inbox, replies);
+            for (std::size_t i = before; i < conn.inbox.size(); ++i) conn.inboxBytes += conn.inbox[i].size();
+            conn.out.append(std::move(replies));
+            if (!open) conn.closeAfterWrite = true;
+            if (conn.peerClosed && !conn.closeAfterWrite) {
+                closeConnection(id);
+                return;
+            }
+            dispatchMessages(id, conn);
+            if (!conn.readPaused || conn.busy || conn.closeAfterWrite) break;
+            if (!receive(id, conn)) return;
+        }
+        flush(id, conn);
+    }
+
+    // Like HTTP batches, messages count against maxQueuedRequests; a WebSocket that finds the
+    // queue full is closed with 1013 (Try Again Later), the WebSocket counterpart of a 503.
+    // The caller flushes.
+    void dispatchMessages(std::uint64_t id, Connection& conn) {
+        if (conn.busy || conn.inbox.empty()) return;
+        Task task;
+        task.connId = id;
+        task.websocket = conn.websocket;
+        task.messages.swap(conn.inbox);
+        conn.inboxBytes = 0;
+        const std::size_t maxQueued = server.options_.maxQueuedRequests;
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            if (maxQueued == 0 || tasks.size() < maxQueued) {
+                tasks.push_back(std::move(task));
+                queued = true;
+            }
+        }
+        if (!queued) {
+            conn.out.append(encodeWebSocketFrame(WebSocketOpcode::Close, webSocketClosePayload(1013), false));
+            conn.closeAfterWrite = true;
+            return;
+        }
+        conn.busy = true;
+        taskCv.notify_one();
+    }
+
+    void drainCompletions() {
+        std::vector<Completion> ready;
+        {
+            std::lock_guard<std::mutex> lock(completions->mutex);
+            ready.swap(completions->done);
+        }
+        for (auto& completion : ready) {
+            auto it = conns.find(completion.connId);
+            if (it == conns.end()) {
+                // Client went away while the handler ran.
+                if (completion.stream) completion.stream->detach();
+                continue;
+            }
+            Connection& conn = it->second;
+            const std::uint64_t id = completion.connId;
+            switch (completion.kind) {
+                case Completion::Kind::Response:
+                    for (std::size_t i = 0; i < completion.responses.size(); ++i) {
+                        conn.out.appendResponse(std::move(completion.responses[i]), completion.keepAlive[i]);
+                    }
+                    conn.closeAfterWrite = completion.close;
+                    if (completion.stream) {
+                        // Streams end when either side closes; no read deadline applies.
+                        stopWaiting(conn);
+                        conn.stream = completion.stream;
+                        conn.stream->attach([queue = completions, id](const std::string& data, bool end) {
+                            Completion next;
+                            next.kind = end ? Completion::Kind::StreamEnd : Completion::Kind::StreamData;
+                            next.connId = id;
+                            next.bytes = data;
+                            return queue->push(std::move(next));
+                        });
+                        if (!completion.websocket) {
+                            // Nothing on a plain stream is read as a request again; just watch for EOF.
+                            conn.in.clear();
+                            if (conn.readPaused) {
+                                if (!receive(id, conn)) continue;
+                                if (conn.peerClosed) {
+                                    closeConnection(id);
+                                    continue;
+                                }
+                            }
+                        }
+                    }
+                    if (completion.websocket) {
+                        conn.websocket = completion.websocket;
+                        conn.busy = false;
+                        // The peer may already have sent frames behind the handshake.
+                        readWebSocket(id, conn);
+                        continue;
+                    }
+                    break;
+                case Completion::Kind::StreamData:
+                    conn.out.append(std::move(completion.bytes));
+                    if (conn.out.pending() > kMaxStreamBacklog) {
+                        closeConnection(id);
+                        continue;
+                    }
+                    break;
+                case Completion::Kind::StreamEnd:
+                    conn.closeAfterWrite = true;
+                    break;
+                case Completion::Kind::MessagesDone:
+                    conn.busy = false;
+                    if (conn.readPaused && !receive(id, conn)) continue;
+                    readWebSocket(id, conn);
+                    continue;
+            }
+            flush(id, conn);
+        }
+    }
+
+    // Writes as much pending output as the socket accepts. Once a batch is fully written the
+    // connection either closes or goes back to serving buffered requests, reading on first if
+    // receive() paused (streams just wait for more data); the read deadline restarts in both the
+    // blocked and the written case, so a peer that stops reading is dropped too. Returns false if
+    // the connection was closed.
+    bool flush(std::uint64_t id, Connection& conn) {
+        switch (conn.out.writeTo(conn.fd)) {
+            case ResponseWriter::Result::Done:
+                break;
+            case ResponseWriter::Result::Blocked:
+                if (!conn.writeArmed) {
+                    conn.writeArmed = watch(conn.fd, id, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, EPOLL_CTL_MOD);
+                }
+                if (!conn.stream) expectPeer(id, conn);
+                return true;
+            case ResponseWriter::Result::Failed:
+                closeConnection(id);
+                return false;
+        }
+        if (conn.closeAfterWrite) {
+            closeConnection(id);
+            return false;
+        }
+        if (conn.writeArmed) {
+            conn.writeArmed = !watch(conn.fd, id, EPOLLIN | EPOLLRDHUP | EPOLLET, EPOLL_CTL_MOD);
+        }
+        if (conn.stream) return true;
+        expectPeer(id, conn);
+        if (!conn.busy && !conn.readPaused) return true;
+        conn.busy = false;
+        if (conn.readPaused && !receive(id, conn)) return false;
+        return dispatch(id, conn);
+    }
+};
+#else
+struct HttpServer::Reactor {};
+#endif
+
+HttpServer::HttpServer(int port, HttpServerOptions options) : port_(port), options_(options) {
+#ifndef ROCOARENA_HAS_EPOLL
+    options_.threadPerConnection = true;
+#endif
+}
 
 HttpServer::~HttpServer() {
     stop();
 }
 
 void HttpServer::setHandler(Handler handler) {
+    if (!handler) {
+        handler_ = nullptr;
+        return;
+    }
+    handler_ = [handler = std::move(handler)](const HttpRequest& req, Responder respond) { respond(handler(req)); };
+}
+
+void HttpServer::setAsyncHandler(AsyncHandler handler) {
     handler_ = std::move(handler);
 }
 
@@ -94,14 +1052,41 @@ bool HttpServer::start(std::string* error) {
         return false;
     }
 
-    if (listen(serverFd, 16) < 0) {
+    const int backlog = options_.acceptBacklog > 0 ? options_.acceptBacklog : SOMAXCONN;
+    if (listen(serverFd, backlog) < 0) {
         if (error) *error = "listen failed";
         closeSocket(serverFd);
         return false;
     }
 
+    if (port_ == 0) {
+        sockaddr_in bound{};
+#ifdef _WIN32
+        int boundLen = sizeof(bound);
+#else
+        socklen_t boundLen = sizeof(bound);
+#endif
+        if (getsockname(serverFd, reinterpret_cast<sockaddr*>(&bound), &boundLen) == 0) {
+            port_ = ntohs(bound.sin_port);
+        }
+    }
+
     serverFd_ = static_cast<int>(serverFd);
     running_ = true;
+#ifdef ROCOARENA_HAS_EPOLL
+    if (!options_.threadPerConnection) {
+        reactor_ = std::make_unique<Reactor>(*this);
+        if (!reactor_->start(error)) {
+            running_ = false;
+            reactor_->stop();
+            reactor_.reset();
+            closeSocket(serverFd);
+            serverFd_ = -1;
+            return false;
+        }
+        return true;
+    }
+#endif
     acceptThread_ = std::thread(&HttpServer::acceptLoop, this);
     return true;
 }
@@ -109,7 +1094,17 @@ bool HttpServer::start(std::string* error) {
 void HttpServer::stop() {
     if (!running_) return;
     running_ = false;
+#ifdef ROCOARENA_HAS_EPOLL
+    if (reactor_) {
+        reactor_->stop();
+        reactor_.reset();
+    }
+#endif
     if (serverFd_ != -1) {
+#ifndef _WIN32
+        // close() alone does not wake a thread blocked in accept() on Linux.
+        shutdown(serverFd_, SHUT_RDWR);
+#endif
         closeSocket(static_cast<SocketType>(serverFd_));
         serverFd_ = -1;
     }
@@ -134,117 +1129,151 @@ void HttpServer::acceptLoop() {
         if (clientFd == kInvalidSocket) {
             continue;
         }
+        // One thread per connection, so the connection limit is also the thread limit.
+        const std::size_t maxConnections = options_.maxConnections;
+        if (maxConnections > 0 && activeConnections_.load() >= maxConnections) {
+            refuseConnection(clientFd);
+            continue;
+        }
+        ++activeConnections_;
 
         std::thread([this, clientFd]() {
             std::string raw;
             char buffer[4096];
             int received = 0;
-            bool headerParsed = false;
-            std::size_t headerEnd = std::string::npos;
-            std::size_t contentLength = 0;
-
-            while ((received = recv(clientFd, buffer, sizeof(buffer), 0)) > 0) {
-                raw.append(buffer, buffer + received);
-                if (!headerParsed) {
-                    headerEnd = raw.find("\r\n\r\n");
-                    if (headerEnd != std::string::npos) {
-                        headerParsed = true;
-                        std::string headerPart = raw.substr(0, headerEnd + 4);
-                        std::istringstream hs(headerPart);
-                        std::string line;
-                        while (std::getline(hs, line)) {
-                            if (line.find("Content-Length:") != std::string::npos ||
-                                line.find("content-length:") != std::string::npos) {
-                                auto pos = line.find(':');
-                                if (pos != std::string::npos) {
-                                    std::string value = trim(line.substr(pos + 1));
-                                    try {
-                                        contentLength = static_cast<std::size_t>(std::stoul(value));
-                                    } catch (...) {
-                                        contentLength = 0;
-                                    }
-                                }
-                            }
-                        }
+            HttpRequest req;
+            std::size_t length = 0;
+            HttpParseResult parsed = HttpParseResult::Incomplete;
+            const std::size_t maxRequest = options_.maxRequestBytes;
+            // The deadline covers the whole request, so a peer trickling bytes cannot stretch it.
+            const auto timeout = options_.readTimeout;
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            while (parsed == HttpParseResult::Incomplete && (maxRequest == 0 || raw.size() <= maxRequest)) {
+                if (timeout > std::chrono::milliseconds::zero()) {
+                    const auto left =
+                        std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                    if (left <= std::chrono::milliseconds::zero()) {
+                        received = -1;
+                        break;
                     }
+                    setSocketTimeout(clientFd, left);
                 }
+                if ((received = recv(clientFd, buffer, sizeof(buffer), 0)) <= 0) break;
+                raw.append(buffer, buffer + received);
+                parsed = parseHttpRequest(raw, req, length);
+            }
+            if (received < 0) {
+                // Read deadline passed (or the socket failed) before a whole request arrived.
+                closeSocket(clientFd);
+                --activeConnections_;
+                return;
+            }
+            if (parsed == HttpParseResult::Complete && maxRequest > 0 && length > maxRequest) {
+                parsed = HttpParseResult::Incomplete;
+            }
+            if (parsed == HttpParseResult::Incomplete && maxRequest > 0 && raw.size() > maxRequest) {
+                ResponseWriter out;
+                out.appendResponse(tooLargeResponse(), false);
+                out.writeTo(clientFd);
+                closeSocket(clientFd);
+                --activeConnections_;
+                return;
+            }
+            if (parsed != HttpParseResult::Complete) req = HttpRequest{}; // answered 400
+            // A peer that stops reading the response gets the same allowance.
+            if (timeout > std::chrono::milliseconds::zero()) setSocketTimeout(clientFd, timeout);
 
-                if (headerParsed) {
-                    std::size_t totalNeeded = headerEnd + 4 + contentLength;
-                    if (raw.size() >= totalNeeded) {
-                        break;
+            // The legacy path stays one request per connection: its detached threads must not
+            // outlive stop() waiting on an idle keep-alive socket.
+            auto promise = std::make_shared<std::promise<HttpResponse>>();
+            std::future<HttpResponse> response = promise->get_future();
+            handleRequest(req, [promise](HttpResponse resp) {
+                try {
+                    promise->set_value(std::move(resp));
+                } catch (const std::future_error&) {
+                    // Responder called twice; the first response wins.
+                }
+            });
+            HttpResponse resp = response.get();
+            const std::shared_ptr<HttpStream> stream = resp.stream;
+            const std::shared_ptr<WebSocket> websocket = resp.stream ? resp.websocket : nullptr;
+            ResponseWriter out;
+            out.appendResponse(std::move(resp), false);
+            // Blocking socket: returns once everything is written or the peer is gone.
+            out.writeTo(clientFd);
+            if (stream) {
+                // Stream writes go straight to the socket from the sender's thread; this thread
+                // just waits for the peer (or an end-of-stream shutdown) to finish the connection.
+                // Streams may stay quiet indefinitely, so the read deadline no longer applies.
+                setSocketTimeout(clientFd, std::chrono::milliseconds::zero());
+                stream->attach([clientFd](const std::string& data, bool end) {
+                    if (end) {
+#ifdef _WIN32
+                        shutdown(clientFd, SD_BOTH);
+#else
+                        shutdown(clientFd, SHUT_RDWR);
+#endif
+                        return true;
+                    }
+                    std::size_t offset = 0;
+                    while (offset < data.size()) {
+                        const int sent = static_cast<int>(send(clientFd, data.data() + offset,
+                                                               static_cast<int>(data.size() - offset), kSendFlags));
+                        if (sent <= 0) return false;
+                        offset += static_cast<std::size_t>(sent);
+                    }
+                    return true;
+                });
+                if (websocket) {
+                    WebSocketReader reader(true);
+                    std::string in;
+                    std::vector<std::string> messages;
+                    bool open = true;
+                    while (open && (received = recv(clientFd, buffer, sizeof(buffer), 0)) > 0) {
+                        in.append(buffer, buffer + received);
+                        std::string replies;
+                        open = reader.read(in, messages, replies);
+                        if (!replies.empty()) stream->send(replies);
+                        for (const auto& message : messages) {
+                            websocket->deliver(message);
+                        }
+                        messages.clear();
+                    }
+                } else {
+                    while (recv(clientFd, buffer, sizeof(buffer), 0) > 0) {
                     }
                 }
+                stream->detach();
             }
-
-            HttpResponse resp = handleRawRequest(raw);
-
-            std::ostringstream oss;
-            oss << "HTTP/1.1 " << resp.status << " OK\r\n";
-            oss << "Content-Type: " << resp.contentType << "\r\n";
-            oss << "Content-Length: " << resp.body.size() << "\r\n";
-            oss << "Connection: close\r\n\r\n";
-            oss << resp.body;
-            std::string out = oss.str();
-            send(clientFd, out.c_str(), static_cast<int>(out.size()), 0);
             closeSocket(clientFd);
+            --activeConnections_;
         }).detach();
     }
 }
 
-HttpResponse HttpServer::handleRawRequest(const std::string& raw) const {
-    std::istringstream iss(raw);
-    std::string line;
-    if (!std::getline(iss, line)) {
-        return { 400, "{\"error\":\"invalid request\"}" };
+void HttpServer::handleRequest(const HttpRequest& req, Responder respond) const {
+    if (req.method.empty()) {
+        respond(invalidRequestResponse());
+        return;
     }
-
-    std::istringstream lineStream(line);
-    HttpRequest req;
-    lineStream >> req.method;
-    std::string path;
-    lineStream >> path;
-
-    auto qpos = path.find('?');
-    if (qpos != std::string::npos) {
-        req.path = path.substr(0, qpos);
-        req.query = path.substr(qpos + 1);
-    } else {
-        req.path = path;
+    if (!handler_) {
+        respond({ 500, "{\"error\":\"no handler\"}" });
+        return;
     }
-
-    std::unordered_map<std::string, std::string> headers;
-    while (std::getline(iss, line)) {
-        if (line == "\r" || line.empty()) {
-            break;
-        }
-        auto pos = line.find(':');
-        if (pos == std::string::npos) continue;
-        std::string key = toLower(trim(line.substr(0, pos)));
-        std::string value = trim(line.substr(pos + 1));
-        headers[key] = value;
+    if (!req.websocket) {
+        handler_(req, std::move(respond));
+        return;
     }
-
-    std::string contentLenStr = getHeaderValue(headers, "content-length");
-    int contentLen = 0;
-    if (!contentLenStr.empty()) {
-        try {
-            contentLen = std::stoi(contentLenStr);
-        } catch (...) {
-            contentLen = 0;
+    // Turn an accepted upgrade into the 101 handshake; its stream then carries the frames.
+    std::string accept = webSocketAccept(std::string(req.header("Sec-WebSocket-Key")));
+    handler_(req, [respond = std::move(respond), accept = std::move(accept)](HttpResponse resp) {
+        if (resp.websocket) {
+            resp.status = 101;
+            resp.headers.emplace_back("Upgrade", "websocket");
+            resp.headers.emplace_back("Connection", "Upgrade");
+            resp.headers.emplace_back("Sec-WebSocket-Accept", accept);
+            resp.stream = resp.websocket->stream_;
         }
-    }
-
-    if (contentLen > 0) {
-        std::string body;
-        body.resize(static_cast<std::size_t>(contentLen));
-        iss.read(body.data(), contentLen);
-        req.body = body;
-    }
-
-    if (!handler_) {
-        return { 500, "{\"error\":\"no handler\"}" };
-    }
-
-    return handler_(req);
+        respond(std::move(resp));
+    });
 }
@@ -1,42 +1,144 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
-struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::string body;
-    std::string query;
+#include "http_request.h"
+
+// Body of a long-lived response (e.g. text/event-stream). Created by the handler, attached to
+// the connection by HttpServer once the headers are queued; bytes sent before that are buffered.
+// Thread-safe. send() returns false once the peer has gone away or close() was called.
+class HttpStream {
+  public:
+    bool send(const std::string& data);
+    void close();
+    bool isOpen() const;
+
+  private:
+    friend class HttpServer;
+    // Writes bytes to the connection, or ends it when `end` is set; false if the connection is gone.
+    using Sink = std::function<bool(const std::string& data, bool end)>;
+
+    void attach(Sink sink);
+    void detach();
+
+    mutable std::mutex mutex_;
+    Sink sink_;
+    std::string pending_;
+    bool closed_ = false;
+    bool endPending_ = false;
+};
+
+// Server end of an RFC 6455 WebSocket. A handler accepts an upgrade request (req.websocket) by
+// returning a response with `websocket` set; HttpServer answers 101 Switching Protocols and from
+// then on hands each message from the peer to the message handler (on a worker thread, one at a
+// time, in order) and writes whatever is sent here. Pings and the close handshake are answered
+// by the server. Thread-safe; messages sent before the upgrade is written are buffered.
+class WebSocket {
+  public:
+    using MessageHandler = std::function<void(WebSocket& socket, const std::string& message)>;
+
+    explicit WebSocket(MessageHandler onMessage);
+
+    bool send(const std::string& message);
+    // Lets a dead peer be noticed; the pong is consumed by the server.
+    bool ping();
+    // Sends a close frame; the connection is closed once it has been written.
+    void close(std::uint16_t code = 1000);
+    bool isOpen() const;
+
+  private:
+    friend class HttpServer;
+
+    void deliver(const std::string& message);
+
+    MessageHandler onMessage_;
+    // Frames ride the streaming-response path once the upgrade response is queued.
+    std::shared_ptr<HttpStream> stream_;
 };
 
 struct HttpResponse {
     int status = 200;
     std::string body;
     std::string contentType = "application/json";
+    // Extra response headers, written as-is.
+    std::vector<std::pair<std::string, std::string>> headers = {};
+    // Streaming response: sent without Content-Length, `body` first, then whatever is written to
+    // the stream until either side closes. The connection is not reused afterwards.
+    std::shared_ptr<HttpStream> stream = nullptr;
+    // Accepts a WebSocket upgrade; ignored unless the request was one (see HttpRequest::websocket).
+    std::shared_ptr<WebSocket> websocket = nullptr;
+};
+
+struct HttpServerOptions {
+    // Handler worker threads for the epoll reactor; 0 = std::thread::hardware_concurrency().
+    std::size_t workerThreads = 0;
+    // Legacy mode: one detached thread per accepted socket. Kept for non-Linux builds and
+    // as the baseline for the loopback load benchmark.
+    bool threadPerConnection = false;
+    // Admission control. Beyond these limits the server answers 503 (or 413 for an oversized
+    // request) straight away instead of queueing more work; 0 turns a limit off.
+    // Pending connections the kernel holds for accept().
+    int acceptBacklog = 512;
+    // Open connections; one more is answered 503 and closed. Keep it below the process's file
+    // descriptor limit. In thread-per-connection mode this also bounds the threads.
+    std::size_t maxConnections = 1000;
+    // How long a connection may take to deliver a whole request, counted from when the server
+    // starts waiting for it (accept, or the previous response written), and to accept a response
+    // it is being sent. The connection is closed when it runs out. Streams and WebSockets, and
+    // requests a handler is still answering (long-polls), are not subject to it.
+    std::chrono::milliseconds readTimeout{ 30000 };
+    // Request line, headers and body together; a larger request is answered 413 and the
+    // connection closed.
+    std::size_t maxRequestBytes = 1024 * 1024;
+    // Request batches waiting for a handler worker; once this many are queued, new requests are
+    // answered 503 with Retry-After until the workers catch up. Reactor mode only.
+    std::size_t maxQueuedRequests = 1024;
 };
 
 class HttpServer {
   public:
     using Handler = std::function<HttpResponse(const HttpRequest&)>;
+    // Completes one request. Must be called exactly once; may be called later and from any thread
+    // (e.g. when a long-poll wakes up). Pipelined responses are still written in request order.
+    using Responder = std::function<void(HttpResponse)>;
+    using AsyncHandler = std::function<void(const HttpRequest&, Responder)>;
 
-    explicit HttpServer(int port);
+    explicit HttpServer(int port, HttpServerOptions options = {});
     ~HttpServer();
 
     void setHandler(Handler handler);
+    void setAsyncHandler(AsyncHandler handler);
     bool start(std::string* error = nullptr);
     void stop();
 
+    // Port actually bound (useful when constructed with port 0).
+    int port() const { return port_; }
+
   private:
+    struct Reactor;
+
     void acceptLoop();
-    HttpResponse handleRawRequest(const std::string& raw) const;
+    // `req.method` is empty for a request that failed to parse, which is answered 400.
+    void handleRequest(const HttpRequest& req, Responder respond) const;
 
     int port_ = 0;
+    HttpServerOptions options_;
     int serverFd_ = -1;
-    bool running_ = false;
-    Handler handler_;
+    std::atomic<bool> running_{ false };
+    std::atomic<std::size_t> activeConnections_{ 0 }; // thread-per-connection mode
+    AsyncHandler handler_;
     std::thread acceptThread_;
+    std::unique_ptr<Reactor> reactor_;
 };
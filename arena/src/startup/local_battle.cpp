@@ -11,24 +11,6 @@
 #include "data_loader.h"
 
 namespace {
-std::vector<std::unique_ptr<Pet>> buildRandomRoster(const DataStore& store, std::mt19937& rng, std::size_t count) {
-    std::vector<int> ids;
-    ids.reserve(store.pets.size());
-    for (const auto& it : store.pets) {
-        ids.push_back(it.first);
-    }
-    std::shuffle(ids.begin(), ids.end(), rng);
-
-    std::vector<std::unique_ptr<Pet>> roster;
-    for (std::size_t i = 0; i < ids.size() && roster.size() < count; ++i) {
-        auto it = store.pets.find(ids[i]);
-        if (it == store.pets.end()) continue;
-        auto pet = createPetFromTemplate(it->second, store.skills, 100);
-        if (pet) roster.push_back(std::move(pet));
-    }
-    return roster;
-}
-
 void showRoster(const std::vector<std::unique_ptr<Pet>>& roster) {
     std::cout << "Roster:\n";
     for (std::size_t i = 0; i < roster.size(); ++i) {
@@ -124,8 +106,9 @@ int runLocalBattle(const std::string& petsDbPath, const std::string& skillsDir)
     }
 
     std::mt19937 rng{ std::random_device{}() };
-    auto roster1 = buildRandomRoster(store, rng, Player::kMaxPets);
-    auto roster2 = buildRandomRoster(store, rng, Player::kMaxPets);
+    RosterSampler rosters;
+    auto roster1 = rosters.draw(store, rng, Player::kMaxPets);
+    auto roster2 = rosters.draw(store, rng, Player::kMaxPets);
 
     BattleSession session(std::move(roster1), std::move(roster2), store.skills);
 
@@ -0,0 +1,134 @@
+#include "matchmaker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+double RatingBook::rating(const std::string& name) const {
+    auto it = ratings_.find(name);
+    return it == ratings_.end() ? kInitialRating : it->second;
+}
+
+void RatingBook::record(const std::string& player1, const std::string& player2, int winner) {
+    if (player1.empty() || player2.empty() || player1 == player2) return;
+    const double rating1 = rating(player1);
+    const double rating2 = rating(player2);
+    const double expected1 = 1.0 / (1.0 + std::pow(10.0, (rating2 - rating1) / 400.0));
+    const double score1 = winner == 1 ? 1.0 : winner == 2 ? 0.0 : 0.5;
+    const double change = kFactor * (score1 - expected1);
+    ratings_[player1] = rating1 + change;
+    ratings_[player2] = rating2 - change;
+}
+
+Matchmaker::Matchmaker(MatchmakerOptions options) : options_(options) {
+    if (options_.bucketWidth <= 0) options_.bucketWidth = 1;
+    const auto count = static_cast<std::size_t>(std::ceil(std::max(options_.maxRating, 1.0) / options_.bucketWidth));
+    buckets_.resize(count);
+    heads_.resize(count);
+}
+
+bool Matchmaker::enqueue(Ticket ticket, std::string name, double rating, Clock::time_point now) {
+    Entry entry;
+    entry.ticket = ticket;
+    entry.name = std::move(name);
+    entry.rating = rating;
+    entry.enqueued = now;
+    if (!entries_.emplace(ticket, std::move(entry)).second) return false;
+    arrivals_.push_back(ticket);
+    return true;
+}
+
+bool Matchmaker::cancel(Ticket ticket) {
+    return entries_.erase(ticket) != 0;
+}
+
+double Matchmaker::window(Ticket ticket, Clock::time_point now) const {
+    auto it = entries_.find(ticket);
+    return it == entries_.end() ? 0.0 : windowOf(it->second, now);
+}
+
+double Matchmaker::windowOf(const Entry& entry, Clock::time_point now) const {
+    const double waited = std::chrono::duration<double>(now - entry.enqueued).count();
+    return std::min(options_.maxWindow, options_.baseWindow + options_.widenPerSecond * std::max(waited, 0.0));
+}
+
+std::size_t Matchmaker::bucketOf(double rating) const {
+    if (!(rating > 0)) return 0;
+    return std::min(static_cast<std::size_t>(rating / options_.bucketWidth), buckets_.size() - 1);
+}
+
+std::vector<Matchmaker::Match> Matchmaker::pairBatch(Clock::time_point now) {
+    // Drops the tickets that left since the last batch and lays the rest out by bucket.
+    for (auto& bucket : buckets_) bucket.clear();
+    std::fill(heads_.begin(), heads_.end(), 0);
+    order_.clear();
+    std::size_t live = 0;
+    for (Ticket ticket : arrivals_) {
+        auto it = entries_.find(ticket);
+        if (it == entries_.end()) continue;
+        arrivals_[live++] = ticket;
+        Entry* entry = &it->second;
+        buckets_[bucketOf(entry->rating)].push_back(entry);
+        order_.push_back(entry);
+    }
+    arrivals_.resize(live);
+
+    std::vector<Match> matches;
+    for (Entry* entry : order_) {
+        if (entry->paired) continue;
+        Entry* partner = findPartner(*entry, now);
+        if (!partner) continue;
+        entry->paired = true;
+        partner->paired = true;
+        matches.push_back(Match{ entry->ticket, partner->ticket });
+    }
+    if (matches.empty()) return matches;
+
+    live = 0;
+    for (Ticket ticket : arrivals_) {
+        if (!entries_.at(ticket).paired) arrivals_[live++] = ticket;
+    }
+    arrivals_.resize(live);
+    for (const Match& match : matches) {
+        entries_.erase(match.first);
+        entries_.erase(match.second);
+    }
+    order_.clear(); // pointed into the erased entries
+    return matches;
+}
+
+// Own bucket first, then one step further out on either side at a time, as far as the window
+// reaches.
+Matchmaker::Entry* Matchmaker::findPartner(const Entry& entry, Clock::time_point now) {
+    const double window = windowOf(entry, now);
+    const std::size_t center = bucketOf(entry.rating);
+    const std::size_t low = bucketOf(entry.rating - window);
+    const std::size_t high = bucketOf(entry.rating + window);
+    for (std::size_t step = 0; center >= low + step || center + step <= high; ++step) {
+        if (center >= low + step) {
+            if (Entry* partner = scanBucket(center - step, entry, window, now)) return partner;
+        }
+        if (step > 0 && center + step <= high) {
+            if (Entry* partner = scanBucket(center + step, entry, window, now)) return partner;
+        }
+    }
+    return nullptr;
+}
+
+// The longest-waiting player in the bucket that `entry` and it both accept.
+Matchmaker::Entry* Matchmaker::scanBucket(std::size_t bucket, const Entry& entry, double window,
+                                          Clock::time_point now) {
+    const std::vector<Entry*>& players = buckets_[bucket];
+    std::size_t& head = heads_[bucket];
+    while (head < players.size() && players[head]->paired) ++head;
+    std::size_t looked = 0;
+    for (std::size_t i = head; i < players.size() && looked < options_.scanPerBucket; ++i) {
+        Entry* candidate = players[i];
+        if (candidate == &entry) continue;
+        ++looked; // paired ones too, so a batch that pairs many cannot make this scan long
+        if (candidate->paired || candidate->name == entry.name) continue;
+        const double gap = std::fabs(candidate->rating - entry.rating);
+        if (gap <= window && gap <= windowOf(*candidate, now)) return candidate;
+    }
+    return nullptr;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Elo ratings by player name, fed with the outcome of every finished battle. Not thread-safe.
+class RatingBook {
+  public:
+    static constexpr double kInitialRating = 1500.0;
+    static constexpr double kFactor = 32.0; // largest change one battle can make
+
+    double rating(const std::string& name) const;
+
+    // Applies one battle's result; `winner` is BattleOutcome::winner (0 for a draw). Ignored
+    // unless both names are set and differ.
+    void record(const std::string& player1, const std::string& player2, int winner);
+
+    std::size_t size() const { return ratings_.size(); }
+
+  private:
+    std::unordered_map<std::string, double> ratings_;
+};
+
+struct MatchmakerOptions {
+    double bucketWidth = 50.0;
+    double maxRating = 4000.0; // ratings outside [0, maxRating) share the edge buckets
+    // Rating difference a player accepts: baseWindow at first, widening by widenPerSecond of
+    // waiting up to maxWindow. A pair needs each to be within the other's window.
+    double baseWindow = 100.0;
+    double widenPerSecond = 20.0;
+    double maxWindow = 600.0;
+    // Players looked at per bucket before moving on to the next one.
+    std::size_t scanPerBucket = 16;
+};
+
+// Queued players kept in rating buckets and paired in batches. Joining and leaving the queue are
+// O(1). A batch visits the players oldest first and looks for each one's partner in its own
+// bucket and then outwards, no further than its window reaches, so the cost per player depends
+// on the window and bucket width but not on how many players are queued. Not thread-safe.
+class Matchmaker {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Ticket = std::uint64_t;
+
+    struct Match {
+        Ticket first;  // the one that waited longer
+        Ticket second;
+    };
+
+    explicit Matchmaker(MatchmakerOptions options = {});
+
+    // False if the ticket is already queued.
+    bool enqueue(Ticket ticket, std::string name, double rating, Clock::time_point now);
+    // False if the ticket is not queued (never was, already left or already paired).
+    bool cancel(Ticket ticket);
+    bool contains(Ticket ticket) const { return entries_.count(ticket) != 0; }
+    std::size_t size() const { return entries_.size(); }
+
+    // Rating difference the ticket accepts at `now`; 0 if it is not queued.
+    double window(Ticket ticket, Clock::time_point now) const;
+
+    // Pairs every player it can; the paired tickets leave the queue. Players never meet someone
+    // of their own name.
+    std::vector<Match> pairBatch(Clock::time_point now);
+
+  private:
+    struct Entry {
+        Ticket ticket = 0;
+        std::string name;
+        double rating = 0;
+        Clock::time_point enqueued;
+        bool paired = false;
+    };
+
+    double windowOf(const Entry& entry, Clock::time_point now) const;
+    std::size_t bucketOf(double rating) const;
+    Entry* findPartner(const Entry& entry, Clock::time_point now);
+    Entry* scanBucket(std::size_t bucket, const Entry& entry, double window, Clock::time_point now);
+
+    MatchmakerOptions options_;
+    std::unordered_map<Ticket, Entry> entries_;
+    std::vector<Ticket> arrivals_; // oldest first; tickets that left linger until the next batch
+    // Rebuilt by each batch, reusing their storage: the batch's players by bucket in arrival
+    // order, and per bucket the first one that may still be unpaired.
+    std::vector<std::vector<Entry*>> buckets_;
+    std::vector<std::size_t> heads_;
+    std::vector<Entry*> order_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Idle objects kept for reuse instead of being freed and allocated again. take() hands one out
+// (nullptr when there is none; the caller constructs a fresh one then), give() returns it once
+// the caller is done. Objects come back as they were given, so the caller resets them on reuse.
+// At most maxIdle are kept; the rest are destroyed. Thread-safe.
+template <typename T>
+class ObjectPool {
+  public:
+    explicit ObjectPool(std::size_t maxIdle = 256) : maxIdle_(maxIdle) {
+        idle_.reserve(maxIdle_); // so give() never grows the vector
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    std::unique_ptr<T> take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.empty()) return nullptr;
+        std::unique_ptr<T> object = std::move(idle_.back());
+        idle_.pop_back();
+        return object;
+    }
+
+    void give(std::unique_ptr<T> object) {
+        if (!object) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.size() < maxIdle_) {
+                idle_.push_back(std::move(object));
+                return;
+            }
+        }
+        // Full: `object` is destroyed here, outside the lock.
+    }
+
+    std::size_t idle() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
+  private:
+    const std::size_t maxIdle_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> idle_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Where a room sits in an OpenRoomQueue; embedded in the room as `openLink`. Guarded by the
+// queue's mutex. `linked` additionally only changes while the room's own lock is held, so code
+// holding that lock may read it without the queue's.
+template <typename Room>
+struct OpenRoomLink {
+    std::shared_ptr<Room> self; // keeps a queued room alive
+    Room* prev = nullptr;
+    Room* next = nullptr;
+    bool linked = false;
+};
+
+// Intrusive FIFO of the rooms waiting for a second player, oldest first. The links live inside
+// the rooms, so push and remove are O(1) and never allocate.
+// Lock order: a room's lock may be held while calling into the queue, never the other way round;
+// at() hands out a room for the caller to lock (and re-check) after it returns.
+template <typename Room>
+class OpenRoomQueue {
+  public:
+    OpenRoomQueue() = default;
+    ~OpenRoomQueue() {
+        // Queued rooms hold themselves alive through their links.
+        while (Room* room = head_) {
+            head_ = room->openLink.next;
+            room->openLink.prev = room->openLink.next = nullptr;
+            room->openLink.linked = false;
+            room->openLink.self.reset();
+        }
+    }
+    OpenRoomQueue(const OpenRoomQueue&) = delete;
+    OpenRoomQueue& operator=(const OpenRoomQueue&) = delete;
+
+    // Appends `room` unless it is queued already. Call with the room locked.
+    void push(const std::shared_ptr<Room>& room) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        OpenRoomLink<Room>& link = room->openLink;
+        if (link.linked) return;
+        link.self = room;
+        link.prev = tail_;
+        link.next = nullptr;
+        link.linked = true;
+        if (tail_) {
+            tail_->openLink.next = room.get();
+        } else {
+            head_ = room.get();
+        }
+        tail_ = room.get();
+        ++size_;
+    }
+
+    // Unlinks `room` if it is queued. Call with the room locked.
+    void remove(Room& room) {
+        std::shared_ptr<Room> self;
+        std::lock_guard<std::mutex> lock(mutex_);
+        OpenRoomLink<Room>& link = room.openLink;
+        if (!link.linked) return;
+        if (link.prev) {
+            link.prev->openLink.next = link.next;
+        } else {
+            head_ = link.next;
+        }
+        if (link.next) {
+            link.next->openLink.prev = link.prev;
+        } else {
+            tail_ = link.prev;
+        }
+        link.prev = link.next = nullptr;
+        link.linked = false;
+        self = std::move(link.self); // released after the queue's mutex
+        --size_;
+    }
+
+    // The room `skip` places behind the oldest one, or null. Only name clashes make callers skip,
+    // so this is O(1) in practice.
+    std::shared_ptr<Room> at(std::size_t skip) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Room* room = head_;
+        for (; room && skip > 0; --skip) room = room->openLink.next;
+        return room ? room->openLink.self : nullptr;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    Room* head_ = nullptr;
+    Room* tail_ = nullptr;
+    std::size_t size_ = 0;
+};
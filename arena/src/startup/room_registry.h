@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Rooms keyed by name, split across independently locked shards so that lookups of different
+// rooms do not contend. A shard lock is only held while its map is read or changed; access to a
+// room's contents is synchronised by the caller (the server gives every room its own mutex).
+// Lock order: a shard lock may be held while taking a room's lock, never the other way round.
+template <typename Room>
+class RoomRegistry {
+  public:
+    explicit RoomRegistry(std::size_t shardCount = 16) : shards_(shardCount == 0 ? 1 : shardCount) {}
+
+    RoomRegistry(const RoomRegistry&) = delete;
+    RoomRegistry& operator=(const RoomRegistry&) = delete;
+
+    std::shared_ptr<Room> find(const std::string& name) const {
+        const Shard& shard = shardFor(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.rooms.find(name);
+        return it == shard.rooms.end() ? nullptr : it->second;
+    }
+
+    // Adds `room` under `name`. When the name is taken, `replace(existing)` is asked (with the
+    // shard locked) whether the existing room may be dropped; returns false if it stays.
+    template <typename Replace>
+    bool insert(const std::string& name, std::shared_ptr<Room> room, Replace&& replace) {
+        Shard& shard = shardFor(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::shared_ptr<Room>& slot = shard.rooms[name];
+        if (slot && !replace(*slot)) return false;
+        slot = std::move(room);
+        return true;
+    }
+
+    bool insert(const std::string& name, std::shared_ptr<Room> room) {
+        return insert(name, std::move(room), [](Room&) { return false; });
+    }
+
+    // Removes `name` only if it still refers to `room`; it may have been replaced meanwhile.
+    void erase(const std::string& name, const std::shared_ptr<Room>& room) {
+        Shard& shard = shardFor(name);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.rooms.find(name);
+        if (it != shard.rooms.end() && it->second == room) shard.rooms.erase(it);
+    }
+
+    // Every room registered at the time of the call. Shards are visited one at a time, so the
+    // result is not an atomic picture of the whole registry.
+    std::vector<std::shared_ptr<Room>> snapshot() const {
+        std::vector<std::shared_ptr<Room>> rooms;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& kv : shard.rooms) {
+                rooms.push_back(kv.second);
+            }
+        }
+        return rooms;
+    }
+
+    std::size_t size() const {
+        std::size_t total = 0;
+        for (const Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.rooms.size();
+        }
+        return total;
+    }
+
+    std::size_t shardCount() const { return shards_.size(); }
+
+  private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Room>> rooms;
+    };
+
+    Shard& shardFor(const std::string& name) { return shards_[std::hash<std::string>{}(name) % shards_.size()]; }
+    const Shard& shardFor(const std::string& name) const {
+        return shards_[std::hash<std::string>{}(name) % shards_.size()];
+    }
+
+    std::vector<Shard> shards_;
+};
@@ -2,11 +2,16 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <mutex>
 #include <optional>
 #include <random>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,13 +19,36 @@
 
 #include <nlohmann/json.hpp>
 
+#include "actor_pool.h"
 #include "battle_session.h"
 #include "data_loader.h"
+#include "http_router.h"
 #include "http_server.h"
+#include "matchmaker.h"
+#include "object_pool.h"
+#include "open_room_queue.h"
+#include "room_registry.h"
+#include "state_delta.h"
+#include "wire_format.h"
+#include "timer_wheel.h"
 
 namespace {
 using Clock = std::chrono::steady_clock;
 constexpr std::chrono::seconds kParticipantTimeout{60};
+constexpr std::chrono::milliseconds kDefaultLongPollTimeout{25000};
+constexpr std::chrono::milliseconds kMaxLongPollTimeout{30000};
+constexpr std::chrono::seconds kEventKeepAlive{15};
+// How long a /queue ticket lives without being polled, and a made match waits to be collected.
+constexpr std::chrono::seconds kQueueTicketTimeout{10};
+// Queued players are paired in batches this far apart.
+constexpr std::chrono::milliseconds kMatchBatchInterval{250};
+constexpr std::size_t kRoomShards = 32;
+// /events and /ws viewer roles; also the index of the room's cached frames for that role.
+constexpr int kPlayer1Role = 0;
+constexpr int kSpectatorRole = 2;
+constexpr std::size_t kViewerRoles = 3;
+// Versions per viewer role that /state/delta can diff against before falling back to a full state.
+constexpr std::size_t kStateHistory = 16;
 
 struct PlayerSlot {
     bool occupied = false;
@@ -28,66 +56,212 @@ struct PlayerSlot {
     bool ready = false;
 };
 
+// A parked GET /state?since=<version> (or /state/delta) request. It is answered once the room
+// version moves past `since` or the deadline passes; until then no thread or lock is held for it.
+struct StateWaiter {
+    int playerId = 0;
+    bool spectator = false;
+    std::string spectatorName;
+    std::uint64_t since = 0;
+    std::string ifNoneMatch;
+    bool binary = false; // Accept: application/x-rocoarena
+    bool delta = false;  // /state/delta rather than /state
+    Clock::time_point deadline;
+    HttpServer::Responder respond;
+};
+
+// A pushed-state subscriber: either a text/event-stream (/events) or a WebSocket (/ws).
+struct EventSubscriber {
+    int role = kSpectatorRole;
+    int playerId = 0;
+    std::string spectatorName;
+    std::shared_ptr<HttpStream> stream;
+    std::shared_ptr<WebSocket> socket;
+    std::uint64_t sentVersion = 0;
+};
+
+// Serialised state for one viewer role, built lazily once per room version and shared by every
+// /state request and subscriber with that role.
+struct ViewerFrames {
+    std::uint64_t version = 0;
+    std::uint64_t sessionVersion = 0;
+    std::string body;    // /state JSON
+    std::string binary;  // /state as application/x-rocoarena, encoded on first request
+    std::string event;   // text/event-stream frame
+    std::string message; // WebSocket message
+};
+
+// Recent /state bodies of one viewer role, oldest first, for /state/delta. Only the newest
+// version is kept parsed; an older one is parsed again when a delta from it is asked for. The
+// delta last served is kept so that viewers polling from the same version share it.
+struct StateHistory {
+    std::deque<std::pair<std::uint64_t, std::string>> bodies;
+    nlohmann::json current; // payload of bodies.back()
+    std::uint64_t deltaSince = 0;
+    std::string deltaBody; // cleared whenever a new version is recorded
+};
+
+// Everything inside but `openLink` is guarded by `mutex`. A room that has been dropped from the
+// registry is marked `closed` first, so a request that looked it up just before treats it as gone.
 struct Room {
+    std::mutex mutex;
+    bool closed = false;
+    // Unique per room ever created, so ETags differ when a name is reused.
+    std::uint64_t id = 0;
     std::string name;
     std::array<PlayerSlot, 2> players{};
     std::vector<std::string> spectators;
     std::array<std::optional<Clock::time_point>, 2> playerSeen{};
     std::unordered_map<std::string, Clock::time_point> spectatorSeen;
     std::unique_ptr<BattleSession> session;
+    // Version of everything /state reports for this room (summary + session state).
+    std::uint64_t version = 1;
+    std::uint64_t sessionVersion = 0;
+    std::vector<StateWaiter> waiters;
+    std::vector<EventSubscriber> subscribers;
+    std::array<ViewerFrames, kViewerRoles> viewerFrames{};
+    std::array<StateHistory, kViewerRoles> history{};
+    // roomSummary() as served by /room and /rooms, rebuilt once per version (see summaryBody).
+    std::string summary;
+    std::uint64_t summaryVersion = 0;
+    std::uint64_t summarySessionVersion = 0;
+    Clock::time_point lastEventPing{};
+    // The room's single pending timer (0 if none), armed for the earliest of its deadlines.
+    TimerService::TimerId timer = 0;
+    Clock::time_point timerDue{};
+    // Names seated when the battle started, whose ratings its outcome updates (once; see rateBattle).
+    std::array<std::string, 2> battlePlayers{};
+    bool rated = false;
+    // Position in ServerState::openRooms while /join_random may seat a player here (see roomOpen).
+    OpenRoomLink<Room> openLink;
 };
 
-struct ServerState {
+// A POST /queue caller waiting for an opponent, or already matched and yet to collect its room.
+struct QueueTicket {
+    std::string name;
+    double rating = 0;
+    Clock::time_point seen;
+    std::string room; // set once matched
+    int playerId = 0;
+};
+
+// Players queued by POST /queue, paired by rating in batches (see runMatchBatch). `mutex` is
+// never taken with a room locked; matched rooms are created after it is released.
+struct MatchQueue {
     std::mutex mutex;
-    DataStore store;
-    std::unordered_map<std::string, Room> rooms;
-    bool running = true;
+    Matchmaker matchmaker;
+    std::unordered_map<Matchmaker::Ticket, QueueTicket> tickets;
+    std::deque<std::pair<Matchmaker::Ticket, Clock::time_point>> matched; // for expiring uncollected matches
+    std::atomic<std::uint64_t> nextRoom{ 0 }; // numbers matched rooms; taken without `mutex`
+    bool batchArmed = false;
+    Clock::time_point lastSweep{};
+};
+
+struct ServerState {
+    DataStore store; // read-only once loaded
+    RoomRegistry<Room> rooms{ kRoomShards };
+    OpenRoomQueue<Room> openRooms;
+    MatchQueue matchQueue;
+    std::mutex rngMutex;
     std::mt19937 rng{ std::random_device{}() };
+    RosterSampler rosters; // with rng, under rngMutex
+    ObjectPool<BattleSession> sessions; // of retired rooms, reset by startBattle for the next battle
+    std::mutex ratingsMutex; // taken with a room locked; nothing else is locked under it
+    RatingBook ratings;
+    // Randomly based so tags handed out before a restart do not match afterwards.
+    std::atomic<std::uint64_t> nextRoomId{ std::uint64_t{ std::random_device{}() } << 32 };
+    // Each room's ticks and actions run on the worker its id maps to (see serviceRoom and
+    // queueRoomAction); rooms on different workers are serviced in parallel.
+    ActorPool actors;
+    // Last member, so it is stopped before the rooms its callbacks refer to go away.
+    TimerService timers;
 };
 
-std::vector<std::unique_ptr<Pet>> buildRandomRoster(const DataStore& store, std::mt19937& rng, std::size_t count) {
-    std::vector<int> ids;
-    ids.reserve(store.pets.size());
-    for (const auto& it : store.pets) {
-        ids.push_back(it.first);
-    }
-    std::shuffle(ids.begin(), ids.end(), rng);
+void armRoomTimer(ServerState& state, const std::shared_ptr<Room>& room);
+void syncOpenRoom(ServerState& state, const std::shared_ptr<Room>& room);
+void rateBattle(ServerState& state, Room& room);
 
-    std::vector<std::unique_ptr<Pet>> roster;
-    for (std::size_t i = 0; i < ids.size() && roster.size() < count; ++i) {
-        auto it = store.pets.find(ids[i]);
-        if (it == store.pets.end()) continue;
-        auto pet = createPetFromTemplate(it->second, store.skills, 100);
-        if (pet) {
-            roster.push_back(std::move(pet));
-        }
+// A live room with its mutex held; empty when the room does not exist (or was just closed).
+// Whatever was done to the room, its timer is re-armed for its new deadlines, its place in the
+// open-room queue brought up to date and a battle that just ended rated on release.
+struct LockedRoom {
+    ServerState* state = nullptr;
+    std::shared_ptr<Room> room;
+    std::unique_lock<std::mutex> lock;
+
+    LockedRoom() = default;
+    LockedRoom(LockedRoom&&) = default;
+    LockedRoom& operator=(LockedRoom&&) = delete;
+    ~LockedRoom() {
+        if (!room) return;
+        armRoomTimer(*state, room);
+        syncOpenRoom(*state, room);
+        rateBattle(*state, *room);
     }
-    return roster;
+
+    explicit operator bool() const { return room != nullptr; }
+    Room* operator->() const { return room.get(); }
+    Room& operator*() const { return *room; }
+};
+
+LockedRoom lockRoom(ServerState& state, std::shared_ptr<Room> room) {
+    LockedRoom locked;
+    if (!room) return locked;
+    std::unique_lock<std::mutex> lock(room->mutex);
+    if (room->closed) return locked;
+    locked.state = &state;
+    locked.room = std::move(room);
+    locked.lock = std::move(lock);
+    return locked;
 }
 
-std::string queryValue(const std::string& query, const std::string& key) {
-    std::string needle = key + "=";
-    auto pos = query.find(needle);
-    if (pos == std::string::npos) return {};
-    auto start = pos + needle.size();
-    auto end = query.find('&', start);
-    return query.substr(start, end == std::string::npos ? std::string::npos : end - start);
+LockedRoom lockRoom(ServerState& state, const std::string& name) {
+    return lockRoom(state, state.rooms.find(name));
 }
 
-int parsePlayerId(const std::string& query) {
-    auto val = queryValue(query, "playerId");
+int parsePlayerId(const QueryParams& query) {
+    const std::string_view val = query.get("playerId");
     if (val.empty()) return 0;
     try {
-        return std::stoi(val);
+        return std::stoi(std::string(val));
     } catch (...) {
         return 0;
     }
 }
 
+bool spectatorFlag(const QueryParams& query) {
+    const std::string_view flag = query.get("spectator");
+    return flag == "1" || flag == "true";
+}
+
 HttpResponse jsonResponse(const nlohmann::json& j, int status = 200) {
     return { status, j.dump(), "application/json" };
 }
 
+bool wantsBinary(const HttpRequest& req) {
+    return acceptsBinary(req.header("Accept"));
+}
+
+// Re-encodes a JSON reply for a client that asked for application/x-rocoarena. Routes with a
+// cached binary body (/state) answer in it directly and pass through untouched.
+HttpResponse binaryResponse(HttpResponse resp) {
+    if (resp.contentType != "application/json" || resp.body.empty() || resp.stream || resp.websocket) return resp;
+    nlohmann::json value = nlohmann::json::parse(resp.body, nullptr, false);
+    if (value.is_discarded()) return resp;
+    resp.body = encodeBinary(value);
+    resp.contentType = kBinaryMediaType;
+    return resp;
+}
+
+// POST body in either wire format; discarded when it does not decode.
+nlohmann::json requestBody(const HttpRequest& req) {
+    if (isBinaryMediaType(req.header("Content-Type"))) {
+        nlohmann::json value;
+        return decodeBinary(req.body, value) ? value : nlohmann::json(nlohmann::json::value_t::discarded);
+    }
+    return nlohmann::json::parse(req.body, nullptr, false);
+}
+
 bool roomHasName(const Room& room, const std::string& name) {
     if (name.empty()) return false;
     for (const auto& slot : room.players) {
@@ -135,6 +309,11 @@ bool roomEmpty(const Room& room) {
     return room.spectators.empty();
 }
 
+// Waiting for a second player: exactly one seat taken and no battle yet.
+bool roomOpen(const Room& room) {
+    return !room.closed && !room.session && room.players[0].occupied != room.players[1].occupied;
+}
+
 bool roomReady(const Room& room) {
     return room.players[0].occupied && room.players[1].occupied && room.players[0].ready && room.players[1].ready;
 }
@@ -160,6 +339,59 @@ nlohmann::json roomSummary(const Room& room) {
     return j;
 }
 
+std::uint64_t sessionVersionOf(const Room& room) {
+    return room.session ? room.session->stateVersion() : 0;
+}
+
+// Identifies everything /room, /rooms and /state can show for the room.
+std::string roomTag(const Room& room) {
+    return std::to_string(room.id) + "-" + std::to_string(room.version) + "-" + std::to_string(sessionVersionOf(room));
+}
+
+const std::string& summaryBody(Room& room) {
+    const std::uint64_t sessionVersion = sessionVersionOf(room);
+    if (room.summary.empty() || room.summaryVersion != room.version || room.summarySessionVersion != sessionVersion) {
+        room.summary = roomSummary(room).dump();
+        room.summaryVersion = room.version;
+        room.summarySessionVersion = sessionVersion;
+    }
+    return room.summary;
+}
+
+// If-None-Match is "*" or a comma-separated list of entity tags; weak tags compare equal too.
+bool etagMatches(std::string_view ifNoneMatch, const std::string& etag) {
+    std::size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        std::size_t end = ifNoneMatch.find(',', pos);
+        if (end == std::string_view::npos) end = ifNoneMatch.size();
+        std::size_t first = ifNoneMatch.find_first_not_of(" \t", pos);
+        std::size_t last = ifNoneMatch.find_last_not_of(" \t", end - 1);
+        if (first != std::string_view::npos && first < end && last != std::string_view::npos && last >= first) {
+            std::string_view tag = ifNoneMatch.substr(first, last - first + 1);
+            if (tag == "*") return true;
+            if (tag.compare(0, 2, "W/") == 0) tag.remove_prefix(2);
+            if (tag == etag) return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+// A tag names one representation, so binary replies get tags of their own.
+std::string representationTag(std::string etag, bool binary) {
+    if (binary) etag.insert(etag.size() - 1, "-b");
+    return etag;
+}
+
+// 304 with an empty body when the client already holds `etag`, else the body itself.
+HttpResponse taggedResponse(const std::string& body, const std::string& etag, std::string_view ifNoneMatch,
+                            const std::string& contentType = "application/json") {
+    if (etagMatches(ifNoneMatch, etag)) {
+        return { 304, "", contentType, { { "ETag", etag }, { "Vary", "Accept" } } };
+    }
+    return { 200, body, contentType, { { "ETag", etag }, { "Vary", "Accept" } } };
+}
+
 void touchPlayer(Room& room, int playerId, Clock::time_point now) {
     if (playerId < 1 || playerId > 2) return;
     room.playerSeen[static_cast<std::size_t>(playerId - 1)] = now;
@@ -170,13 +402,16 @@ void touchSpectator(Room& room, const std::string& name, Clock::time_point now)
     room.spectatorSeen[name] = now;
 }
 
-void expireRoomParticipants(Room& room, Clock::time_point now) {
+// Returns true if anyone was removed.
+bool expireRoomParticipants(Room& room, Clock::time_point now) {
+    bool changed = false;
     for (int i = 0; i < 2; ++i) {
         if (room.playerSeen[i].has_value() && (now - *room.playerSeen[i]) > kParticipantTimeout) {
             removePlayer(room, i + 1);
             if (room.session && !room.session->outcome().ended) {
                 room.session->forfeit(i);
             }
+            changed = true;
         }
     }
 
@@ -185,10 +420,421 @@ void expireRoomParticipants(Room& room, Clock::time_point now) {
             std::string name = it->first;
             it = room.spectatorSeen.erase(it);
             removeSpectator(room, name);
+            changed = true;
             continue;
         }
         ++it;
     }
+    return changed;
+}
+
+// /state body for one viewer. playerId must be valid unless spectator is set or there is no session.
+nlohmann::json statePayload(const Room& room, bool spectator, int playerId) {
+    if (!room.session) {
+        return { { "status", "waiting" }, { "room", roomSummary(room) }, { "version", room.version } };
+    }
+    nlohmann::json payload = spectator ? room.session->spectatorState() : room.session->stateForPlayer(playerId - 1);
+    payload["room"] = roomSummary(room);
+    payload["version"] = room.version;
+    return payload;
+}
+
+// Every change a viewer can see bumps room.version (roomChanged / publishRoom); the session
+// version is checked as well so a session mutation not yet published never serves stale bytes.
+ViewerFrames& viewerFrames(Room& room, int role) {
+    ViewerFrames& frames = room.viewerFrames[static_cast<std::size_t>(role)];
+    const std::uint64_t sessionVersion = sessionVersionOf(room);
+    if (frames.version != room.version || frames.sessionVersion != sessionVersion) {
+        frames.version = room.version;
+        frames.sessionVersion = sessionVersion;
+        frames.body.clear();
+        frames.binary.clear();
+        frames.event.clear();
+        frames.message.clear();
+    }
+    return frames;
+}
+
+int viewerRole(bool spectator, int playerId) {
+    if (spectator || playerId < 1 || playerId > 2) return kSpectatorRole;
+    return kPlayer1Role + playerId - 1;
+}
+
+// Folds session progress into the room version.
+void foldSessionVersion(Room& room) {
+    if (room.session && room.session->stateVersion() != room.sessionVersion) {
+        room.sessionVersion = room.session->stateVersion();
+        ++room.version;
+    }
+}
+
+// Every version a viewer was shown passes through here, so the history holds whatever `since`
+// a /state/delta client can come back with.
+void recordState(Room& room, int role, nlohmann::json payload, const std::string& body) {
+    StateHistory& history = room.history[static_cast<std::size_t>(role)];
+    history.deltaBody.clear();
+    history.current = std::move(payload);
+    if (!history.bodies.empty() && history.bodies.back().first == room.version) {
+        history.bodies.back().second = body;
+        return;
+    }
+    history.bodies.emplace_back(room.version, body);
+    if (history.bodies.size() > kStateHistory) history.bodies.pop_front();
+}
+
+const std::string& viewerState(Room& room, int role) {
+    ViewerFrames& frames = viewerFrames(room, role);
+    if (frames.body.empty()) {
+        const bool spectator = role == kSpectatorRole;
+        nlohmann::json payload = statePayload(room, spectator, spectator ? 0 : role - kPlayer1Role + 1);
+        frames.body = payload.dump();
+        recordState(room, role, std::move(payload), frames.body);
+    }
+    return frames.body;
+}
+
+const std::string& viewerBinary(Room& room, int role) {
+    viewerState(room, role);
+    ViewerFrames& frames = room.viewerFrames[static_cast<std::size_t>(role)];
+    if (frames.binary.empty()) {
+        // The history keeps the JSON payload of the current version.
+        frames.binary = encodeBinary(room.history[static_cast<std::size_t>(role)].current);
+    }
+    return frames.binary;
+}
+
+// /state/delta body: {"since","version","full":false,"patch"} with the diffState() patch from
+// the viewer's `since` payload to the current one, or {"since","version","full":true,"state"}
+// once `since` has dropped out of the history. The full reply wraps the cached /state body.
+const std::string& deltaBody(Room& room, int role, std::uint64_t since) {
+    // A version must name one payload, or a client could be patched from bytes it never saw.
+    foldSessionVersion(room);
+    const std::string& body = viewerState(room, role);
+    StateHistory& history = room.history[static_cast<std::size_t>(role)];
+    if (!history.deltaBody.empty() && history.deltaSince == since) return history.deltaBody;
+
+    const std::uint64_t version = history.bodies.back().first;
+    auto base = std::find_if(history.bodies.begin(), history.bodies.end(),
+                             [&](const auto& entry) { return entry.first == since; });
+    if (base == history.bodies.end()) {
+        // Keys in the order nlohmann::json dumps them, as in the patch reply.
+        history.deltaBody = "{\"full\":true,\"since\":" + std::to_string(since) + ",\"state\":" + body +
+                            ",\"version\":" + std::to_string(version) + "}";
+    } else {
+        nlohmann::json reply = { { "since", since }, { "version", version }, { "full", false } };
+        reply["patch"] = since == version ? nlohmann::json::object()
+                                          : diffState(nlohmann::json::parse(base->second), history.current);
+        history.deltaBody = reply.dump();
+    }
+    history.deltaSince = since;
+    return history.deltaBody;
+}
+
+// Role whose payload a /state or /state/delta viewer gets (touching the viewer on the way), or
+// -1 for an invalid playerId once the battle runs.
+int admitViewer(Room& room, bool spectator, const std::string& specName, int playerId, Clock::time_point now) {
+    if (!room.session) {
+        // Before the battle every viewer sees the same waiting payload.
+        return kSpectatorRole;
+    }
+    if (!spectator && (playerId < 1 || playerId > 2)) return -1;
+    if (spectator) {
+        touchSpectator(room, specName, now);
+    } else {
+        touchPlayer(room, playerId, now);
+    }
+    return viewerRole(spectator, playerId);
+}
+
+HttpResponse stateResponse(Room& room, bool spectator, const std::string& specName, int playerId,
+                           std::string_view ifNoneMatch, bool binary, Clock::time_point now) {
+    const int role = admitViewer(room, spectator, specName, playerId, now);
+    if (role < 0) {
+        return jsonResponse({ { "error", "invalid playerId" } }, 400);
+    }
+    const std::string etag = representationTag("\"" + roomTag(room) + "-" + std::to_string(role) + "\"", binary);
+    if (!binary) return taggedResponse(viewerState(room, role), etag, ifNoneMatch);
+    return taggedResponse(viewerBinary(room, role), etag, ifNoneMatch, kBinaryMediaType);
+}
+
+HttpResponse deltaResponse(Room& room, bool spectator, const std::string& specName, int playerId,
+                           std::uint64_t since, Clock::time_point now) {
+    const int role = admitViewer(room, spectator, specName, playerId, now);
+    if (role < 0) {
+        return jsonResponse({ { "error", "invalid playerId" } }, 400);
+    }
+    return { 200, deltaBody(room, role, since), "application/json" };
+}
+
+const std::string& eventFrame(Room& room, int role) {
+    ViewerFrames& frames = viewerFrames(room, role);
+    if (frames.event.empty()) {
+        frames.event =
+            "id: " + std::to_string(room.version) + "\nevent: state\ndata: " + viewerState(room, role) + "\n\n";
+    }
+    return frames.event;
+}
+
+const std::string& socketMessage(Room& room, int role) {
+    ViewerFrames& frames = viewerFrames(room, role);
+    if (frames.message.empty()) {
+        frames.message = "{\"op\":\"state\",\"state\":" + viewerState(room, role) + "}";
+    }
+    return frames.message;
+}
+
+bool sendState(Room& room, const EventSubscriber& sub) {
+    if (sub.socket) return sub.socket->send(socketMessage(room, sub.role));
+    return sub.stream->send(eventFrame(room, sub.role));
+}
+
+bool subscriberOpen(const EventSubscriber& sub) {
+    return sub.socket ? sub.socket->isOpen() : sub.stream->isOpen();
+}
+
+void pushEvents(Room& room) {
+    auto& subs = room.subscribers;
+    subs.erase(std::remove_if(subs.begin(), subs.end(),
+                              [&](EventSubscriber& sub) {
+                                  if (sub.sentVersion == room.version) return false;
+                                  sub.sentVersion = room.version;
+                                  return !sendState(room, sub);
+                              }),
+               subs.end());
+}
+
+// Drops closed subscribers, keeps connected ones from expiring, and sends a keep-alive (SSE
+// comment or WebSocket ping) now and then so dead connections are noticed.
+void maintainSubscribers(Room& room, Clock::time_point now) {
+    auto& subs = room.subscribers;
+    subs.erase(
+        std::remove_if(subs.begin(), subs.end(), [](const EventSubscriber& sub) { return !subscriberOpen(sub); }),
+        subs.end());
+    const bool ping = now - room.lastEventPing >= kEventKeepAlive;
+    if (ping) room.lastEventPing = now;
+    for (const auto& sub : subs) {
+        if (sub.role == kSpectatorRole) {
+            touchSpectator(room, sub.spectatorName, now);
+        } else {
+            touchPlayer(room, sub.playerId, now);
+        }
+        if (!ping) continue;
+        if (sub.socket) {
+            sub.socket->ping();
+        } else {
+            sub.stream->send(": keep-alive\n\n");
+        }
+    }
+}
+
+// Reads the viewer (room=..&playerId=.. or spectator=1&name=..) of a /events or /ws request.
+// Returns false for an invalid playerId.
+bool identifySubscriber(Room& room, const QueryParams& query, Clock::time_point now, EventSubscriber& sub) {
+    if (spectatorFlag(query)) {
+        sub.spectatorName = query.get("name");
+        touchSpectator(room, sub.spectatorName, now);
+        return true;
+    }
+    sub.playerId = parsePlayerId(query);
+    if (sub.playerId < 1 || sub.playerId > 2) return false;
+    sub.role = kPlayer1Role + sub.playerId - 1;
+    touchPlayer(room, sub.playerId, now);
+    return true;
+}
+
+HttpResponse stateResponse(Room& room, const StateWaiter& waiter, Clock::time_point now) {
+    if (waiter.delta) {
+        return deltaResponse(room, waiter.spectator, waiter.spectatorName, waiter.playerId, waiter.since, now);
+    }
+    return stateResponse(room, waiter.spectator, waiter.spectatorName, waiter.playerId, waiter.ifNoneMatch,
+                         waiter.binary, now);
+}
+
+// Answers every parked /state request that is out of date or past its deadline.
+void publishRoom(Room& room, Clock::time_point now) {
+    foldSessionVersion(room);
+    for (auto it = room.waiters.begin(); it != room.waiters.end();) {
+        if (it->since == room.version && now < it->deadline) {
+            ++it;
+            continue;
+        }
+        it->respond(stateResponse(room, *it, now));
+        it = room.waiters.erase(it);
+    }
+    pushEvents(room);
+}
+
+void roomChanged(Room& room, Clock::time_point now) {
+    ++room.version;
+    publishRoom(room, now);
+}
+
+void closeRoomListeners(Room& room) {
+    for (auto& waiter : room.waiters) {
+        waiter.respond(jsonResponse({ { "error", "room not found" } }, 404));
+    }
+    room.waiters.clear();
+    for (auto& sub : room.subscribers) {
+        if (sub.socket) {
+            sub.socket->close();
+        } else {
+            sub.stream->close();
+        }
+    }
+    room.subscribers.clear();
+}
+
+// Drops a room from the registry. Its listeners are told it is gone and requests that already
+// hold a pointer to it see it as closed.
+void retireRoom(ServerState& state, LockedRoom& locked) {
+    locked->closed = true;
+    closeRoomListeners(*locked);
+    if (locked->timer != 0) state.timers.cancel(locked->timer);
+    state.openRooms.remove(*locked);
+    rateBattle(state, *locked);
+    // Nothing reads the session of a closed room, so it can serve the next battle.
+    std::unique_ptr<BattleSession> session = std::move(locked->session);
+    std::shared_ptr<Room> room = std::move(locked.room);
+    locked.lock.unlock();
+    state.rooms.erase(room->name, room);
+    state.sessions.give(std::move(session));
+}
+
+// Parks GET /state?since=<version>[&timeout=<ms>] (or /state/delta) when the caller already has
+// the current version. Returns false (respond is left untouched) when the request should be
+// answered now.
+bool parkStateRequest(ServerState& state, const HttpRequest& req, const QueryParams& query,
+                      HttpServer::Responder& respond, Clock::time_point now) {
+    LockedRoom locked = lockRoom(state, std::string(query.get("room")));
+    if (!locked) return false;
+    Room& room = *locked;
+
+    StateWaiter waiter;
+    std::chrono::milliseconds timeout = kDefaultLongPollTimeout;
+    try {
+        waiter.since = std::stoull(std::string(query.get("since")));
+        const std::string_view timeoutValue = query.get("timeout");
+        if (!timeoutValue.empty()) timeout = std::chrono::milliseconds(std::stoll(std::string(timeoutValue)));
+    } catch (...) {
+        return false;
+    }
+    if (waiter.since != room.version || timeout.count() <= 0) return false;
+
+    waiter.spectator = spectatorFlag(query);
+    waiter.spectatorName = query.get("name");
+    waiter.playerId = parsePlayerId(query);
+    if (!waiter.spectator && room.session && (waiter.playerId < 1 || waiter.playerId > 2)) return false;
+    if (waiter.spectator) {
+        touchSpectator(room, waiter.spectatorName, now);
+    } else {
+        touchPlayer(room, waiter.playerId, now);
+    }
+    waiter.ifNoneMatch = req.header("If-None-Match");
+    waiter.binary = wantsBinary(req);
+    waiter.delta = req.path == "/state/delta";
+    waiter.deadline = now + std::min(timeout, kMaxLongPollTimeout);
+    waiter.respond = std::move(respond);
+    room.waiters.push_back(std::move(waiter));
+    return true;
+}
+
+// Applies one action (the fields of POST /action) for playerId. Returns the HTTP status and
+// fills `body` with the reply.
+int submitRoomAction(Room& room, int playerId, const nlohmann::json& data, Clock::time_point now,
+                     nlohmann::json& body) {
+    if (!room.session) {
+        body = { { "error", "battle not ready" } };
+        return 400;
+    }
+    if (playerId < 1 || playerId > 2) {
+        body = { { "error", "invalid playerId" } };
+        return 400;
+    }
+    touchPlayer(room, playerId, now);
+
+    ActionData action;
+    std::string type = data.value("type", "stay");
+    if (type == "skill") {
+        action.type = ActionType::Skill;
+        action.skillId = data.value("skillId", 0);
+    } else if (type == "switch") {
+        action.type = ActionType::Switch;
+        action.switchIndex = static_cast<std::size_t>(data.value("index", 0));
+    } else if (type == "flee") {
+        action.type = ActionType::Flee;
+    } else {
+        action.type = ActionType::Stay;
+    }
+
+    std::string err;
+    if (!room.session->submitAction(playerId - 1, action, &err)) {
+        body = { { "error", err } };
+        return 400;
+    }
+
+    room.session->tick();
+    publishRoom(room, now);
+    body = { { "status", "ok" } };
+    return 200;
+}
+
+// One message from a /ws client: {"op":"action","id":N, <fields of POST /action>}. The room and
+// player come from the socket, not the message. The reply {"op":"result","id":N,"status":..,
+// "body":{..}} goes out after the state push the action caused.
+void handleSocketMessage(ServerState& state, const std::string& roomName, int playerId, WebSocket& socket,
+                         const std::string& message) {
+    nlohmann::json data = nlohmann::json::parse(message, nullptr, false);
+    nlohmann::json reply = { { "op", "result" } };
+    nlohmann::json body;
+    int status = 200;
+    if (data.is_discarded() || !data.is_object()) {
+        body = { { "error", "invalid json" } };
+        status = 400;
+    } else {
+        reply["id"] = data.value("id", 0);
+        if (data.value("op", "") != "action") {
+            body = { { "error", "unknown op" } };
+            status = 400;
+        } else if (playerId == 0) {
+            body = { { "error", "spectators cannot act" } };
+            status = 403;
+        } else {
+            LockedRoom locked = lockRoom(state, roomName);
+            if (!locked || !socket.isOpen()) {
+                body = { { "error", "room not found" } };
+                status = 404;
+            } else {
+                status = submitRoomAction(*locked, playerId, data, Clock::now(), body);
+            }
+        }
+    }
+    reply["status"] = status;
+    reply["body"] = std::move(body);
+    socket.send(reply.dump());
+}
+
+// POST /action, run on the room's worker instead of the handler thread. Returns false (respond is
+// left untouched) when the request should be answered now: bad JSON or no such room.
+bool queueRoomAction(ServerState& state, const HttpRequest& req, HttpServer::Responder& respond) {
+    nlohmann::json data = requestBody(req);
+    if (data.is_discarded()) return false;
+    std::shared_ptr<Room> room = state.rooms.find(data.value("room", ""));
+    if (!room) return false;
+    const std::uint64_t id = room->id;
+    state.actors.post(id, [&state, room = std::move(room), data = std::move(data), respond = std::move(respond)]() {
+        nlohmann::json body;
+        int status = 404;
+        {
+            LockedRoom locked = lockRoom(state, room);
+            if (locked) {
+                status = submitRoomAction(*locked, data.value("playerId", 0), data, Clock::now(), body);
+            } else {
+                body = { { "error", "room not found" } };
+            }
+        }
+        respond(jsonResponse(body, status));
+    });
+    return true;
 }
 
 void syncSpectators(Room& room) {
@@ -196,13 +842,294 @@ void syncSpectators(Room& room) {
     for (const auto& kv : room.spectatorSeen) {
         seen.insert(kv.first);
     }
+    const std::size_t before = room.spectators.size();
     room.spectators.erase(std::remove_if(room.spectators.begin(), room.spectators.end(),
                                          [&](const std::string& name) { return seen.find(name) == seen.end(); }),
                           room.spectators.end());
+    // The summary inside cached state bodies lists spectators.
+    if (room.spectators.size() != before) ++room.version;
+}
+
+// Earliest point at which the timer has something to do for the room: a battle deadline, a
+// participant timing out, a parked long-poll expiring or the next subscriber keep-alive.
+std::optional<Clock::time_point> nextRoomDeadline(const Room& room) {
+    std::optional<Clock::time_point> next;
+    auto consider = [&](Clock::time_point when) {
+        if (!next || when < *next) next = when;
+    };
+    if (room.session) {
+        if (auto deadline = room.session->nextDeadline()) consider(*deadline);
+    }
+    for (const auto& seen : room.playerSeen) {
+        if (seen.has_value()) consider(*seen + kParticipantTimeout);
+    }
+    for (const auto& kv : room.spectatorSeen) {
+        consider(kv.second + kParticipantTimeout);
+    }
+    for (const auto& waiter : room.waiters) {
+        consider(waiter.deadline);
+    }
+    if (!room.subscribers.empty()) consider(room.lastEventPing + kEventKeepAlive);
+    return next;
+}
+
+// Runs on the room's worker when its timer fires: what used to happen to every room on a fixed
+// 100 ms poll, now only for a room with something due.
+void serviceRoom(ServerState& state, std::shared_ptr<Room> room) {
+    LockedRoom locked = lockRoom(state, std::move(room));
+    if (!locked) return;
+    Room& current = *locked;
+    current.timer = 0;
+    const auto now = Clock::now();
+    const bool expired = expireRoomParticipants(current, now);
+    if (!current.session && roomEmpty(current)) {
+        retireRoom(state, locked);
+        return;
+    }
+    if (current.session) {
+        current.session->tick();
+        if (current.session->outcome().ended && roomEmpty(current)) {
+            retireRoom(state, locked);
+            return;
+        }
+    }
+    maintainSubscribers(current, now);
+    // Also answers long-polls whose timeout has passed.
+    if (expired) {
+        roomChanged(current, now);
+    } else {
+        publishRoom(current, now);
+    }
+}
+
+// Called with the room locked. Keeps one timer per room; it is only replaced when the room's
+// earliest deadline moves.
+void armRoomTimer(ServerState& state, const std::shared_ptr<Room>& room) {
+    const std::optional<Clock::time_point> due = nextRoomDeadline(*room);
+    if (room->timer != 0) {
+        if (due && *due == room->timerDue) return;
+        state.timers.cancel(room->timer);
+        room->timer = 0;
+    }
+    if (!due) return;
+    room->timerDue = *due;
+    room->timer = state.timers.schedule(*due, [&state, weak = std::weak_ptr<Room>(room)] {
+        // The timer thread only hands the room to its worker.
+        if (auto target = weak.lock()) {
+            const std::uint64_t id = target->id;
+            state.actors.post(id, [&state, target = std::move(target)]() mutable {
+                serviceRoom(state, std::move(target));
+            });
+        }
+    });
 }
+
+// Called with the room locked, after anything that may have opened or filled it.
+void syncOpenRoom(ServerState& state, const std::shared_ptr<Room>& room) {
+    const bool open = roomOpen(*room);
+    if (open == room->openLink.linked) return;
+    if (open) {
+        state.openRooms.push(room);
+    } else {
+        state.openRooms.remove(*room);
+    }
+}
+
+// Adds a new room to the registry. A closed room still registered under the name is on its way
+// out and may be replaced; false if a live one holds it.
+bool registerRoom(ServerState& state, const std::shared_ptr<Room>& room) {
+    return state.rooms.insert(room->name, room, [](Room& existing) {
+        std::lock_guard<std::mutex> lock(existing.mutex);
+        return existing.closed;
+    });
+}
+
+// Called with the room locked. Feeds the outcome of a finished battle into both players' ratings.
+void rateBattle(ServerState& state, Room& room) {
+    if (room.rated || !room.session || !room.session->outcome().ended) return;
+    room.rated = true;
+    std::lock_guard<std::mutex> lock(state.ratingsMutex);
+    state.ratings.record(room.battlePlayers[0], room.battlePlayers[1], room.session->outcome().winner);
+}
+
+// Deals both seated players a random roster and starts their battle. Called with the room locked
+// (or not yet shared).
+void startBattle(ServerState& state, Room& room) {
+    BattleSession::PrototypeRoster roster1{};
+    BattleSession::PrototypeRoster roster2{};
+    {
+        std::lock_guard<std::mutex> rngLock(state.rngMutex);
+        state.rosters.sample(state.store, state.rng, roster1);
+        state.rosters.sample(state.store, state.rng, roster2);
+    }
+    room.session = state.sessions.take();
+    if (room.session) {
+        room.session->reset(roster1, roster2, state.store.skills);
+    } else {
+        room.session = std::make_unique<BattleSession>(roster1, roster2, state.store.skills);
+    }
+    room.session->tick(); // starts the first choose-action deadline
+    room.battlePlayers = { room.players[0].name, room.players[1].name };
+}
+
+Matchmaker::Ticket newQueueTicket(ServerState& state) {
+    std::lock_guard<std::mutex> rngLock(state.rngMutex);
+    return (std::uint64_t{ state.rng() } << 32) | state.rng();
+}
+
+std::string ticketText(Matchmaker::Ticket ticket) {
+    static const char kHex[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (std::size_t i = 0; i < text.size(); ++i) text[i] = kHex[(ticket >> (60 - 4 * i)) & 0xF];
+    return text;
+}
+
+std::optional<Matchmaker::Ticket> parseTicket(std::string_view text) {
+    if (text.empty() || text.size() > 16) return std::nullopt;
+    Matchmaker::Ticket ticket = 0;
+    for (char c : text) {
+        const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) return std::nullopt;
+        ticket = (ticket << 4) | static_cast<Matchmaker::Ticket>(digit);
+    }
+    return ticket;
+}
+
+// Called with the queue locked. Drops waiting tickets nobody polled within the timeout, and
+// matches whose players never came to collect them.
+void pruneMatchQueue(MatchQueue& queue, Clock::time_point now) {
+    while (!queue.matched.empty() && now - queue.matched.front().second >= kQueueTicketTimeout) {
+        queue.tickets.erase(queue.matched.front().first);
+        queue.matched.pop_front();
+    }
+    if (now - queue.lastSweep < kQueueTicketTimeout / 2) return;
+    queue.lastSweep = now;
+    for (auto it = queue.tickets.begin(); it != queue.tickets.end();) {
+        if (it->second.room.empty() && now - it->second.seen >= kQueueTicketTimeout) {
+            queue.matchmaker.cancel(it->first);
+            it = queue.tickets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Two queued players the matchmaker paired, waiting for their room.
+struct MatchPair {
+    std::uint64_t roomId = 0;
+    std::array<Matchmaker::Ticket, 2> tickets{};
+    std::array<std::string, 2> names;
+};
+
+// A registered room with both players seated and ready and their battle under way.
+std::shared_ptr<Room> createMatchRoom(ServerState& state, const MatchPair& pair, Clock::time_point now) {
+    auto room = std::make_shared<Room>();
+    room->id = pair.roomId;
+    for (const std::string& name : pair.names) {
+        const int assigned = addPlayer(*room, name);
+        room->players[assigned - 1].ready = true;
+        touchPlayer(*room, assigned, now);
+    }
+    startBattle(state, *room);
+    do {
+        room->name = "match-" + std::to_string(++state.matchQueue.nextRoom);
+    } while (!registerRoom(state, room));
+    return room;
+}
+
+// Runs on the new room's worker: creates the room, then hands it to both tickets. A ticket that
+// expired meanwhile is skipped; its player's seat times out like any absent player's.
+void openMatchRoom(ServerState& state, const MatchPair& pair) {
+    const auto now = Clock::now();
+    std::shared_ptr<Room> room = createMatchRoom(state, pair, now);
+    {
+        MatchQueue& queue = state.matchQueue;
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (std::size_t i = 0; i < pair.tickets.size(); ++i) {
+            auto it = queue.tickets.find(pair.tickets[i]);
+            if (it == queue.tickets.end()) continue;
+            it->second.room = room->name;
+            it->second.playerId = static_cast<int>(i) + 1;
+            queue.matched.emplace_back(pair.tickets[i], now);
+        }
+    }
+    lockRoom(state, room); // arms the new room's timer on release
+}
+
+void runMatchBatch(ServerState& state);
+
+// Called with the queue locked.
+void armMatchBatch(ServerState& state) {
+    if (state.matchQueue.batchArmed) return;
+    state.matchQueue.batchArmed = true;
+    state.timers.schedule(Clock::now() + kMatchBatchInterval, [&state] { runMatchBatch(state); });
+}
+
+// Timer callback: only pairs the queued players under the queue lock. Each pair's room is built
+// on the worker its id maps to (see openMatchRoom), so a large batch stalls neither the timer
+// thread nor /queue. Paired tickets read as waiting until their room is up. Runs again while
+// anyone is left waiting.
+void runMatchBatch(ServerState& state) {
+    const auto now = Clock::now();
+    std::vector<MatchPair> pairs;
+    {
+        MatchQueue& queue = state.matchQueue;
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.batchArmed = false;
+        pruneMatchQueue(queue, now);
+        for (const Matchmaker::Match& match : queue.matchmaker.pairBatch(now)) {
+            MatchPair pair;
+            pair.tickets = { match.first, match.second };
+            pair.names = { queue.tickets.at(match.first).name, queue.tickets.at(match.second).name };
+            pairs.push_back(std::move(pair));
+        }
+        if (queue.matchmaker.size() > 0) armMatchBatch(state);
+    }
+    for (MatchPair& pair : pairs) {
+        pair.roomId = state.nextRoomId++;
+        const std::uint64_t id = pair.roomId;
+        state.actors.post(id, [&state, pair = std::move(pair)] { openMatchRoom(state, pair); });
+    }
+}
+
+nlohmann::json queueBody(Matchmaker::Ticket id, const QueueTicket& ticket) {
+    if (ticket.room.empty()) {
+        return { { "status", "waiting" }, { "ticket", ticketText(id) }, { "rating", ticket.rating } };
+    }
+    return { { "status", "matched" }, { "room", ticket.room }, { "playerId", ticket.playerId },
+             { "name", ticket.name }, { "rating", ticket.rating } };
+}
+
+// Every route runServer answers; a request for anything else is a 404.
+constexpr std::array<RouteKey, 16> kRoutes = { {
+    { "GET", "/rooms" },
+    { "GET", "/room" },
+    { "POST", "/create" },
+    { "POST", "/join" },
+    { "POST", "/join_random" },
+    { "POST", "/spectate" },
+    { "POST", "/ready" },
+    { "POST", "/leave" },
+    { "GET", "/state" },
+    { "GET", "/state/delta" },
+    { "GET", "/events" },
+    { "GET", "/ws" },
+    { "POST", "/action" },
+    { "POST", "/queue" },
+    { "GET", "/queue" },
+    { "POST", "/queue/leave" },
+} };
+constexpr RouteTable<kRoutes.size()> kRouteTable(kRoutes);
+static_assert(kRouteTable.valid(), "route table needs a collision-free seed");
+constexpr std::size_t kStateRoute = kRouteTable.find("GET", "/state");
+constexpr std::size_t kStateDeltaRoute = kRouteTable.find("GET", "/state/delta");
+constexpr std::size_t kActionRoute = kRouteTable.find("POST", "/action");
+
+using RouteHandler = std::function<HttpResponse(const HttpRequest&, const QueryParams&, Clock::time_point)>;
 } // namespace
 
-int runServer(int port, const std::string& petsDbPath, const std::string& skillsDir) {
+int runServer(int port, const std::string& petsDbPath, const std::string& skillsDir,
+              const HttpServerOptions& options) {
     ServerState state;
     std::string error;
     if (!loadDataStore(petsDbPath, skillsDir, state.store, &error)) {
@@ -210,291 +1137,380 @@ int runServer(int port, const std::string& petsDbPath, const std::string& skills
         return 1;
     }
 
-    HttpServer server(port);
-    server.setHandler([&](const HttpRequest& req) -> HttpResponse {
-        std::lock_guard<std::mutex> lock(state.mutex);
-        auto now = Clock::now();
-        if (req.path == "/rooms" && req.method == "GET") {
-            nlohmann::json list = nlohmann::json::array();
-            for (auto& kv : state.rooms) {
-                syncSpectators(kv.second);
-                list.push_back(roomSummary(kv.second));
+    HttpServer server(port, options);
+    Router<RouteHandler, kRoutes.size()> router(kRouteTable);
+    // Each route locks only the room it touches (see LockedRoom); nothing holds a server-wide lock.
+    router.on("GET", "/rooms", [&](const HttpRequest& req, const QueryParams&, Clock::time_point) {
+        // Assembled from the rooms' cached summaries; the tag hashes their room tags.
+        std::string body = "{\"rooms\":[";
+        std::uint64_t hash = 14695981039346656037ull; // FNV-1a
+        std::size_t count = 0;
+        for (auto& room : state.rooms.snapshot()) {
+            LockedRoom locked = lockRoom(state, std::move(room));
+            if (!locked) continue;
+            syncSpectators(*locked);
+            if (count++ > 0) body += ',';
+            body += summaryBody(*locked);
+            for (char c : roomTag(*locked) + ";") {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
             }
-            return jsonResponse({ { "rooms", list } });
         }
+        body += "]}";
+        const std::string etag = "\"rooms-" + std::to_string(count) + "-" + std::to_string(hash) + "\"";
+        return taggedResponse(body, representationTag(etag, wantsBinary(req)), req.header("If-None-Match"));
+    });
 
-        if (req.path == "/room" && req.method == "GET") {
-            std::string roomName = queryValue(req.query, "name");
-            if (roomName.empty()) {
-                return jsonResponse({ { "error", "missing room name" } }, 400);
-            }
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            syncSpectators(it->second);
-            return jsonResponse(roomSummary(it->second));
+    router.on("GET", "/room", [&](const HttpRequest& req, const QueryParams& query, Clock::time_point) {
+        const std::string roomName(query.get("name"));
+        if (roomName.empty()) {
+            return jsonResponse({ { "error", "missing room name" } }, 400);
         }
+        LockedRoom locked = lockRoom(state, roomName);
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        syncSpectators(*locked);
+        const std::string etag = representationTag("\"" + roomTag(*locked) + "\"", wantsBinary(req));
+        return taggedResponse(summaryBody(*locked), etag, req.header("If-None-Match"));
+    });
 
-        if (req.path == "/create" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            std::string name = data.value("name", "player");
-            if (roomName.empty()) {
-                return jsonResponse({ { "error", "room name required" } }, 400);
-            }
-            if (state.rooms.find(roomName) != state.rooms.end()) {
-                return jsonResponse({ { "error", "room exists" } }, 409);
-            }
-            Room room;
-            room.name = roomName;
-            if (roomHasName(room, name)) {
-                return jsonResponse({ { "error", "name taken" } }, 409);
-            }
-            int assigned = addPlayer(room, name);
-            if (assigned == 0) {
-                return jsonResponse({ { "error", "room full" } }, 403);
-            }
-            touchPlayer(room, assigned, now);
-            state.rooms.emplace(roomName, std::move(room));
-            return jsonResponse({ { "room", roomName }, { "playerId", assigned }, { "name", name } });
+    router.on("POST", "/create", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
         }
+        std::string roomName = data.value("room", "");
+        std::string name = data.value("name", "player");
+        if (roomName.empty()) {
+            return jsonResponse({ { "error", "room name required" } }, 400);
+        }
+        auto room = std::make_shared<Room>();
+        room->id = state.nextRoomId++;
+        room->name = roomName;
+        int assigned = addPlayer(*room, name);
+        touchPlayer(*room, assigned, now);
+        if (!registerRoom(state, room)) {
+            return jsonResponse({ { "error", "room exists" } }, 409);
+        }
+        {
+            std::lock_guard<std::mutex> lock(room->mutex);
+            armRoomTimer(state, room);
+            syncOpenRoom(state, room);
+        }
+        return jsonResponse({ { "room", roomName }, { "playerId", assigned }, { "name", name } });
+    });
 
-        if (req.path == "/join" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            std::string name = data.value("name", "player");
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            Room& room = it->second;
+    router.on("POST", "/join", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
+        }
+        std::string roomName = data.value("room", "");
+        std::string name = data.value("name", "player");
+        LockedRoom locked = lockRoom(state, roomName);
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        Room& room = *locked;
+        if (roomHasName(room, name)) {
+            return jsonResponse({ { "error", "name taken" } }, 409);
+        }
+        if (roomFull(room)) {
+            return jsonResponse({ { "error", "room full" } }, 403);
+        }
+        if (room.session) {
+            return jsonResponse({ { "error", "battle already started" } }, 403);
+        }
+        int assigned = addPlayer(room, name);
+        touchPlayer(room, assigned, now);
+        roomChanged(room, now);
+        return jsonResponse({ { "room", roomName }, { "playerId", assigned }, { "name", name } });
+    });
+
+    router.on("POST", "/join_random", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
+        }
+        std::string name = data.value("name", "player");
+        // Oldest open room first. One that filled or closed after at() returned it has left the
+        // queue by the time it is locked here, so the same position is looked at again.
+        std::size_t skip = 0;
+        while (auto candidate = state.openRooms.at(skip)) {
+            LockedRoom locked = lockRoom(state, std::move(candidate));
+            if (!locked || !roomOpen(*locked)) continue;
+            Room& room = *locked;
             if (roomHasName(room, name)) {
-                return jsonResponse({ { "error", "name taken" } }, 409);
-            }
-            if (roomFull(room)) {
-                return jsonResponse({ { "error", "room full" } }, 403);
-            }
-            if (room.session) {
-                return jsonResponse({ { "error", "battle already started" } }, 403);
+                ++skip;
+                continue;
             }
             int assigned = addPlayer(room, name);
             touchPlayer(room, assigned, now);
-            return jsonResponse({ { "room", roomName }, { "playerId", assigned }, { "name", name } });
+            roomChanged(room, now);
+            return jsonResponse({ { "room", room.name }, { "playerId", assigned }, { "name", name } });
         }
+        return jsonResponse({ { "error", "no available rooms" } }, 404);
+    });
 
-        if (req.path == "/join_random" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string name = data.value("name", "player");
-            for (auto& kv : state.rooms) {
-                Room& room = kv.second;
-                if (room.session) continue;
-                if (roomFull(room)) continue;
-                if (roomHasName(room, name)) continue;
-                int assigned = addPlayer(room, name);
-                if (assigned > 0) {
-                    touchPlayer(room, assigned, now);
-                    return jsonResponse({ { "room", room.name }, { "playerId", assigned }, { "name", name } });
-                }
-            }
-            return jsonResponse({ { "error", "no available rooms" } }, 404);
+    router.on("POST", "/spectate", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
         }
-
-        if (req.path == "/spectate" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            std::string name = data.value("name", "spectator");
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            Room& room = it->second;
-            if (roomHasName(room, name)) {
-                return jsonResponse({ { "error", "name taken" } }, 409);
-            }
-            room.spectators.push_back(name);
-            touchSpectator(room, name, now);
-            return jsonResponse({ { "room", roomName }, { "name", name }, { "spectator", true } });
+        std::string roomName = data.value("room", "");
+        std::string name = data.value("name", "spectator");
+        LockedRoom locked = lockRoom(state, roomName);
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
         }
+        Room& room = *locked;
+        if (roomHasName(room, name)) {
+            return jsonResponse({ { "error", "name taken" } }, 409);
+        }
+        room.spectators.push_back(name);
+        touchSpectator(room, name, now);
+        roomChanged(room, now);
+        return jsonResponse({ { "room", roomName }, { "name", name }, { "spectator", true } });
+    });
 
-        if (req.path == "/ready" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            int playerId = data.value("playerId", 0);
-            bool ready = data.value("ready", true);
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            if (playerId < 1 || playerId > 2) {
-                return jsonResponse({ { "error", "invalid playerId" } }, 400);
-            }
-            Room& room = it->second;
-            if (!room.players[playerId - 1].occupied) {
-                return jsonResponse({ { "error", "player not in room" } }, 403);
-            }
-            room.players[playerId - 1].ready = ready;
-            touchPlayer(room, playerId, now);
-            if (roomReady(room) && !room.session) {
-                auto roster1 = buildRandomRoster(state.store, state.rng, Player::kMaxPets);
-                auto roster2 = buildRandomRoster(state.store, state.rng, Player::kMaxPets);
-                room.session = std::make_unique<BattleSession>(std::move(roster1), std::move(roster2), state.store.skills);
-            }
-            return jsonResponse({ { "status", "ok" }, { "battleStarted", room.session != nullptr } });
+    router.on("POST", "/ready", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
         }
+        std::string roomName = data.value("room", "");
+        int playerId = data.value("playerId", 0);
+        bool ready = data.value("ready", true);
+        LockedRoom locked = lockRoom(state, roomName);
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        if (playerId < 1 || playerId > 2) {
+            return jsonResponse({ { "error", "invalid playerId" } }, 400);
+        }
+        Room& room = *locked;
+        if (!room.players[playerId - 1].occupied) {
+            return jsonResponse({ { "error", "player not in room" } }, 403);
+        }
+        room.players[playerId - 1].ready = ready;
+        touchPlayer(room, playerId, now);
+        if (roomReady(room) && !room.session) {
+            startBattle(state, room);
+        }
+        roomChanged(room, now);
+        return jsonResponse({ { "status", "ok" }, { "battleStarted", room.session != nullptr } });
+    });
 
-        if (req.path == "/leave" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            int playerId = data.value("playerId", 0);
-            std::string name = data.value("name", "");
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            Room& room = it->second;
-            if (playerId >= 1 && playerId <= 2) {
-                if (room.session && !room.session->outcome().ended) {
-                    room.session->forfeit(playerId - 1);
-                }
-                removePlayer(room, playerId);
-            } else if (!name.empty()) {
-                removeSpectator(room, name);
-            }
-            if (room.session && room.session->outcome().ended && roomEmpty(room)) {
-                state.rooms.erase(it);
-                return jsonResponse({ { "status", "ok" } });
-            }
-            if (!room.session && roomEmpty(room)) {
-                state.rooms.erase(it);
-                return jsonResponse({ { "status", "ok" } });
+    router.on("POST", "/leave", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
+        }
+        std::string roomName = data.value("room", "");
+        int playerId = data.value("playerId", 0);
+        std::string name = data.value("name", "");
+        LockedRoom locked = lockRoom(state, roomName);
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        Room& room = *locked;
+        if (playerId >= 1 && playerId <= 2) {
+            if (room.session && !room.session->outcome().ended) {
+                room.session->forfeit(playerId - 1);
             }
+            removePlayer(room, playerId);
+        } else if (!name.empty()) {
+            removeSpectator(room, name);
+        }
+        if (room.session && room.session->outcome().ended && roomEmpty(room)) {
+            retireRoom(state, locked);
+            return jsonResponse({ { "status", "ok" } });
+        }
+        if (!room.session && roomEmpty(room)) {
+            retireRoom(state, locked);
             return jsonResponse({ { "status", "ok" } });
         }
+        roomChanged(room, now);
+        return jsonResponse({ { "status", "ok" } });
+    });
 
-        if (req.path == "/state" && req.method == "GET") {
-            std::string roomName = queryValue(req.query, "room");
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            Room& room = it->second;
-            std::string spectatorFlag = queryValue(req.query, "spectator");
-            bool spectator = (spectatorFlag == "1" || spectatorFlag == "true");
-            if (!room.session) {
-                return jsonResponse({ { "status", "waiting" }, { "room", roomSummary(room) } });
-            }
-            if (spectator) {
-                std::string specName = queryValue(req.query, "name");
-                touchSpectator(room, specName, now);
-                nlohmann::json payload = room.session->spectatorState();
-                payload["room"] = roomSummary(room);
-                return jsonResponse(payload);
-            }
-            int playerId = parsePlayerId(req.query);
-            if (playerId < 1 || playerId > 2) {
-                return jsonResponse({ { "error", "invalid playerId" } }, 400);
-            }
-            touchPlayer(room, playerId, now);
-            nlohmann::json payload = room.session->stateForPlayer(playerId - 1);
-            payload["room"] = roomSummary(room);
-            return jsonResponse(payload);
+    router.on("GET", "/state", [&](const HttpRequest& req, const QueryParams& query, Clock::time_point now) {
+        LockedRoom locked = lockRoom(state, std::string(query.get("room")));
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
         }
+        return stateResponse(*locked, spectatorFlag(query), std::string(query.get("name")), parsePlayerId(query),
+                             req.header("If-None-Match"), wantsBinary(req), now);
+    });
 
-        if (req.path == "/action" && req.method == "POST") {
-            nlohmann::json data = nlohmann::json::parse(req.body, nullptr, false);
-            if (data.is_discarded()) {
-                return jsonResponse({ { "error", "invalid json" } }, 400);
-            }
-            std::string roomName = data.value("room", "");
-            int playerId = data.value("playerId", 0);
-            auto it = state.rooms.find(roomName);
-            if (it == state.rooms.end()) {
-                return jsonResponse({ { "error", "room not found" } }, 404);
-            }
-            Room& room = it->second;
-            if (!room.session) {
-                return jsonResponse({ { "error", "battle not ready" } }, 400);
-            }
-            if (playerId < 1 || playerId > 2) {
-                return jsonResponse({ { "error", "invalid playerId" } }, 400);
-            }
-            touchPlayer(room, playerId, now);
-
-            ActionData action;
-            std::string type = data.value("type", "stay");
-            if (type == "skill") {
-                action.type = ActionType::Skill;
-                action.skillId = data.value("skillId", 0);
-            } else if (type == "switch") {
-                action.type = ActionType::Switch;
-                action.switchIndex = static_cast<std::size_t>(data.value("index", 0));
-            } else if (type == "flee") {
-                action.type = ActionType::Flee;
-            } else {
-                action.type = ActionType::Stay;
-            }
+    // Changes since a version the client already holds; see deltaBody for the reply.
+    router.on("GET", "/state/delta", [&](const HttpRequest&, const QueryParams& query, Clock::time_point now) {
+        LockedRoom locked = lockRoom(state, std::string(query.get("room")));
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        std::uint64_t since = 0;
+        try {
+            since = std::stoull(std::string(query.get("since")));
+        } catch (...) {
+            return jsonResponse({ { "error", "invalid since" } }, 400);
+        }
+        return deltaResponse(*locked, spectatorFlag(query), std::string(query.get("name")), parsePlayerId(query),
+                             since, now);
+    });
 
-            std::string err;
-            if (!room.session->submitAction(playerId - 1, action, &err)) {
-                return jsonResponse({ { "error", err } }, 400);
-            }
+    router.on("GET", "/events", [&](const HttpRequest&, const QueryParams& query, Clock::time_point now) {
+        LockedRoom locked = lockRoom(state, std::string(query.get("room")));
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        Room& room = *locked;
+        EventSubscriber sub;
+        if (!identifySubscriber(room, query, now, sub)) {
+            return jsonResponse({ { "error", "invalid playerId" } }, 400);
+        }
+        sub.stream = std::make_shared<HttpStream>();
+        HttpResponse resp{ 200, "retry: 2000\n\n" + eventFrame(room, sub.role), "text/event-stream" };
+        resp.stream = sub.stream;
+        sub.sentVersion = room.version;
+        room.subscribers.push_back(std::move(sub));
+        return resp;
+    });
 
-            room.session->tick();
-            return jsonResponse({ { "status", "ok" } });
+    // One WebSocket per client: state pushes out, actions in (see handleSocketMessage).
+    router.on("GET", "/ws", [&](const HttpRequest& req, const QueryParams& query, Clock::time_point now) {
+        if (!req.websocket) {
+            return jsonResponse({ { "error", "websocket upgrade required" } }, 400);
+        }
+        LockedRoom locked = lockRoom(state, std::string(query.get("room")));
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        Room& room = *locked;
+        EventSubscriber sub;
+        if (!identifySubscriber(room, query, now, sub)) {
+            return jsonResponse({ { "error", "invalid playerId" } }, 400);
+        }
+        // Messages are handled on the room's worker, which may outlive the connection; the task
+        // holds the socket weakly and drops the message once it is gone.
+        auto self = std::make_shared<std::weak_ptr<WebSocket>>();
+        sub.socket = std::make_shared<WebSocket>([&state, roomName = room.name, id = room.id, playerId = sub.playerId,
+                                                  self](WebSocket&, const std::string& message) {
+            state.actors.post(id, [&state, roomName, playerId, weak = *self, message] {
+                if (auto socket = weak.lock()) handleSocketMessage(state, roomName, playerId, *socket, message);
+            });
+        });
+        *self = sub.socket;
+        // Queued now, written right after the 101 handshake.
+        sub.socket->send(socketMessage(room, sub.role));
+        sub.sentVersion = room.version;
+        HttpResponse resp;
+        resp.websocket = sub.socket;
+        room.subscribers.push_back(std::move(sub));
+        return resp;
+    });
+
+    // Normally answered from the room's worker (see queueRoomAction); this only sees the requests
+    // that are answered straight away.
+    router.on("POST", "/action", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
+        }
+        LockedRoom locked = lockRoom(state, data.value("room", ""));
+        if (!locked) {
+            return jsonResponse({ { "error", "room not found" } }, 404);
+        }
+        nlohmann::json body;
+        const int status = submitRoomAction(*locked, data.value("playerId", 0), data, now, body);
+        return jsonResponse(body, status);
+    });
+
+    // Matchmaking: the caller gets a ticket to poll with GET /queue until a batch pairs it with a
+    // player of similar rating and seats both in a new room with the battle started.
+    router.on("POST", "/queue", [&](const HttpRequest& req, const QueryParams&, Clock::time_point now) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
         }
+        QueueTicket ticket;
+        ticket.name = data.value("name", "player");
+        ticket.seen = now;
+        {
+            std::lock_guard<std::mutex> lock(state.ratingsMutex);
+            ticket.rating = state.ratings.rating(ticket.name);
+        }
+        const Matchmaker::Ticket id = newQueueTicket(state);
+        std::lock_guard<std::mutex> lock(state.matchQueue.mutex);
+        if (!state.matchQueue.matchmaker.enqueue(id, ticket.name, ticket.rating, now)) {
+            return jsonResponse({ { "error", "try again" } }, 503);
+        }
+        auto it = state.matchQueue.tickets.emplace(id, std::move(ticket)).first;
+        armMatchBatch(state);
+        return jsonResponse(queueBody(id, it->second));
+    });
+
+    router.on("GET", "/queue", [&](const HttpRequest&, const QueryParams& query, Clock::time_point now) {
+        const std::optional<Matchmaker::Ticket> id = parseTicket(query.get("ticket"));
+        std::lock_guard<std::mutex> lock(state.matchQueue.mutex);
+        auto it = id ? state.matchQueue.tickets.find(*id) : state.matchQueue.tickets.end();
+        if (it == state.matchQueue.tickets.end()) {
+            return jsonResponse({ { "error", "ticket not found" } }, 404);
+        }
+        HttpResponse resp = jsonResponse(queueBody(it->first, it->second));
+        if (it->second.room.empty()) {
+            it->second.seen = now;
+        } else {
+            state.matchQueue.tickets.erase(it);
+        }
+        return resp;
+    });
+
+    router.on("POST", "/queue/leave", [&](const HttpRequest& req, const QueryParams&, Clock::time_point) {
+        nlohmann::json data = requestBody(req);
+        if (data.is_discarded()) {
+            return jsonResponse({ { "error", "invalid json" } }, 400);
+        }
+        const std::optional<Matchmaker::Ticket> id = parseTicket(data.value("ticket", ""));
+        if (id) {
+            std::lock_guard<std::mutex> lock(state.matchQueue.mutex);
+            // A ticket already matched keeps its seat; leaving the room is POST /leave.
+            if (state.matchQueue.matchmaker.cancel(*id)) state.matchQueue.tickets.erase(*id);
+        }
+        return jsonResponse({ { "status", "ok" } });
+    });
 
-        return jsonResponse({ { "error", "not found" } }, 404);
+    server.setAsyncHandler([&](const HttpRequest& req, HttpServer::Responder respond) {
+        auto now = Clock::now();
+        if (wantsBinary(req)) {
+            respond = [respond = std::move(respond)](HttpResponse resp) { respond(binaryResponse(std::move(resp))); };
+        }
+        // The query string is decoded once here and shared by parking and the route callback.
+        const QueryParams query(req.query);
+        const std::size_t route = router.find(req.method, req.path);
+        if ((route == kStateRoute || route == kStateDeltaRoute) && !query.get("since").empty() &&
+            parkStateRequest(state, req, query, respond, now)) {
+            return;
+        }
+        if (route == kActionRoute && queueRoomAction(state, req, respond)) return;
+        const RouteHandler* handler = router.route(route);
+        respond(handler ? (*handler)(req, query, now) : jsonResponse({ { "error", "not found" } }, 404));
     });
+    if (!router.complete()) {
+        std::cerr << "Route table and route callbacks differ\n";
+        return 1;
+    }
 
+    // Room deadlines (battle timeouts, presence expiry, long-poll timeouts, keep-alives) are
+    // driven by per-room timers; the timer thread sleeps until the next one is due and then hands
+    // the room to its worker.
+    state.actors.start();
+    state.timers.start();
     if (!server.start(&error)) {
         std::cerr << "Failed to start server: " << error << "\n";
         return 1;
     }
 
-    std::thread timer([&]() {
-        while (state.running) {
-            {
-                std::lock_guard<std::mutex> lock(state.mutex);
-                for (auto it = state.rooms.begin(); it != state.rooms.end();) {
-                    Room& room = it->second;
-                    expireRoomParticipants(room, Clock::now());
-                    if (!room.session && roomEmpty(room)) {
-                        it = state.rooms.erase(it);
-                        continue;
-                    }
-                    if (room.session) {
-                        room.session->tick();
-                        if (room.session->outcome().ended && roomEmpty(room)) {
-                            it = state.rooms.erase(it);
-                            continue;
-                        }
-                    }
-                    ++it;
-                }
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-    });
-
     std::cout << "Server started on port " << port << "\n";
     std::cout << "Press Ctrl+C to stop.\n";
 
@@ -502,8 +1518,7 @@ int runServer(int port, const std::string& petsDbPath, const std::string& skills
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
-    state.running = false;
-    timer.join();
     server.stop();
+    state.timers.stop();
     return 0;
 }
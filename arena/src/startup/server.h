@@ -3,4 +3,7 @@
 #include <memory>
 #include <string>
 
-int runServer(int port, const std::string& petsDbPath, const std::string& skillsDir);
+#include "http_server.h"
+
+int runServer(int port, const std::string& petsDbPath, const std::string& skillsDir,
+              const HttpServerOptions& options = {});
@@ -0,0 +1,70 @@
+#include "state_delta.h"
+
+#include <string>
+
+namespace {
+// Member/element patch for one value; `changed` is false when from == to.
+nlohmann::json diffValue(const nlohmann::json& from, const nlohmann::json& to, bool& changed) {
+    changed = true;
+    if (from.is_object() && to.is_object()) {
+        nlohmann::json patch = diffState(from, to);
+        changed = !patch.empty();
+        return patch;
+    }
+    if (from.is_array() && to.is_array() && from.size() == to.size()) {
+        nlohmann::json patch = nlohmann::json::object();
+        for (std::size_t i = 0; i < to.size(); ++i) {
+            bool elementChanged = false;
+            nlohmann::json element = diffValue(from[i], to[i], elementChanged);
+            if (elementChanged) patch[std::to_string(i)] = std::move(element);
+        }
+        changed = !patch.empty();
+        return patch;
+    }
+    if (from == to) {
+        changed = false;
+        return nullptr;
+    }
+    return to;
+}
+} // namespace
+
+nlohmann::json diffState(const nlohmann::json& from, const nlohmann::json& to) {
+    nlohmann::json patch = nlohmann::json::object();
+    for (auto it = to.begin(); it != to.end(); ++it) {
+        auto old = from.find(it.key());
+        if (old == from.end()) {
+            patch[it.key()] = it.value();
+            continue;
+        }
+        bool changed = false;
+        nlohmann::json value = diffValue(*old, it.value(), changed);
+        if (changed) patch[it.key()] = std::move(value);
+    }
+    for (auto it = from.begin(); it != from.end(); ++it) {
+        if (!to.contains(it.key())) patch[it.key()] = nullptr;
+    }
+    return patch;
+}
+
+void applyStateDelta(nlohmann::json& target, const nlohmann::json& patch) {
+    if (!patch.is_object()) {
+        target = patch;
+        return;
+    }
+    if (target.is_array()) {
+        for (auto it = patch.begin(); it != patch.end(); ++it) {
+            const std::size_t index = std::stoul(it.key());
+            if (index < target.size()) applyStateDelta(target[index], it.value());
+        }
+        return;
+    }
+    if (!target.is_object()) target = nlohmann::json::object();
+    for (auto it = patch.begin(); it != patch.end(); ++it) {
+        if (it.value().is_null()) {
+            target.erase(it.key());
+        } else {
+            applyStateDelta(target[it.key()], it.value());
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+// Deltas between two /state payloads, as served by /state/delta.
+//
+// A delta is a JSON merge patch (RFC 7386) with one extension: an array whose length did not
+// change is patched element by element, as an object keyed by decimal index, so one pet's HP or
+// one skill's PP does not resend the whole roster. Unchanged members are left out and removed
+// members are null; payloads never contain null values themselves.
+
+// Patch that turns `from` into `to`; an empty object when they are equal.
+nlohmann::json diffState(const nlohmann::json& from, const nlohmann::json& to);
+
+// Applies a diffState() patch to `target` in place.
+void applyStateDelta(nlohmann::json& target, const nlohmann::json& patch);
@@ -0,0 +1,172 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel(std::chrono::milliseconds resolution, Clock::time_point start)
+    : resolution_(resolution.count() > 0 ? resolution : std::chrono::milliseconds(1)), start_(start) {}
+
+std::uint64_t TimerWheel::tickFor(Clock::time_point when) const {
+    if (when <= start_) return 0;
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(when - start_).count();
+    const auto step = std::chrono::duration_cast<std::chrono::nanoseconds>(resolution_).count();
+    return static_cast<std::uint64_t>((elapsed + step - 1) / step);
+}
+
+TimerWheel::Clock::time_point TimerWheel::timeOf(std::uint64_t tick) const {
+    return start_ + resolution_ * static_cast<std::int64_t>(tick);
+}
+
+TimerWheel::Slot& TimerWheel::slotFor(std::uint64_t due) {
+    // Overdue timers go into the slot processed next.
+    if (due < current_) return slots_[0][current_ & kSlotMask];
+    const std::uint64_t delta = due - current_;
+    for (std::size_t level = 0; level < kLevels; ++level) {
+        if (delta < (std::uint64_t{ 1 } << (kSlotBits * (level + 1)))) {
+            return slots_[level][(due >> (kSlotBits * level)) & kSlotMask];
+        }
+    }
+    // Beyond the horizon: park at the farthest top-level slot; cascading re-places it later.
+    const std::uint64_t horizon = current_ + (std::uint64_t{ 1 } << (kSlotBits * kLevels)) - 1;
+    return slots_[kLevels - 1][(horizon >> (kSlotBits * (kLevels - 1))) & kSlotMask];
+}
+
+void TimerWheel::place(Slot& from, Slot::iterator it) {
+    Slot& to = slotFor(it->due);
+    to.splice(to.end(), from, it);
+    index_[it->id] = Location{ &to, it };
+}
+
+std::size_t TimerWheel::cascade(std::size_t level) {
+    const std::size_t idx = (current_ >> (kSlotBits * level)) & kSlotMask;
+    Slot pending;
+    pending.splice(pending.end(), slots_[level][idx]);
+    while (!pending.empty()) {
+        place(pending, pending.begin());
+    }
+    return idx;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::time_point when, Callback callback) {
+    const TimerId id = nextId_++;
+    const std::uint64_t due = tickFor(when);
+    Slot& slot = slotFor(due);
+    slot.push_back(Entry{ id, due, std::move(callback) });
+    index_[id] = Location{ &slot, std::prev(slot.end()) };
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    auto it = index_.find(id);
+    if (it == index_.end()) return false;
+    it->second.slot->erase(it->second.it);
+    index_.erase(it);
+    return true;
+}
+
+void TimerWheel::advance(Clock::time_point now, std::vector<Callback>& due) {
+    if (now < start_) return;
+    const auto target = static_cast<std::uint64_t>((now - start_) / resolution_);
+    while (current_ <= target) {
+        if (index_.empty()) {
+            current_ = target + 1;
+            break;
+        }
+        const std::size_t idx = current_ & kSlotMask;
+        // Each time a level wraps, the next coarser slot is spread over the finer levels.
+        if (idx == 0) {
+            for (std::size_t level = 1; level < kLevels && cascade(level) == 0; ++level) {
+            }
+        }
+        Slot fired;
+        fired.splice(fired.end(), slots_[0][idx]);
+        for (Entry& entry : fired) {
+            index_.erase(entry.id);
+            due.push_back(std::move(entry.callback));
+        }
+        ++current_;
+    }
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::nextExpiry() const {
+    if (index_.empty()) return std::nullopt;
+    std::optional<std::uint64_t> next;
+    for (std::uint64_t i = 0; i < kSlots; ++i) {
+        if (!slots_[0][(current_ + i) & kSlotMask].empty()) {
+            next = current_ + i;
+            break;
+        }
+    }
+    // A coarse slot has nothing due before the tick at which it cascades.
+    for (std::size_t level = 1; level < kLevels; ++level) {
+        const std::uint64_t span = std::uint64_t{ 1 } << (kSlotBits * level);
+        const std::uint64_t first = (current_ + span - 1) / span * span;
+        for (std::uint64_t i = 0; i < kSlots; ++i) {
+            const std::uint64_t tick = first + i * span;
+            if (next && tick >= *next) break;
+            if (!slots_[level][(tick >> (kSlotBits * level)) & kSlotMask].empty()) {
+                next = tick;
+                break;
+            }
+        }
+    }
+    return next ? std::optional<Clock::time_point>(timeOf(*next)) : std::nullopt;
+}
+
+TimerService::TimerService(std::chrono::milliseconds resolution) : wheel_(resolution) {}
+
+TimerService::~TimerService() {
+    stop();
+}
+
+void TimerService::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&TimerService::run, this);
+}
+
+void TimerService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+TimerService::TimerId TimerService::schedule(Clock::time_point when, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const TimerId id = wheel_.schedule(when, std::move(callback));
+    if (sleeping_ && when < wakeAt_) wake_.notify_one();
+    return id;
+}
+
+bool TimerService::cancel(TimerId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return wheel_.cancel(id);
+}
+
+void TimerService::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<Callback> due;
+    while (running_) {
+        wheel_.advance(Clock::now(), due);
+        if (!due.empty()) {
+            lock.unlock();
+            for (auto& callback : due) callback();
+            due.clear();
+            lock.lock();
+            continue;
+        }
+        const auto next = wheel_.nextExpiry();
+        wakeAt_ = next ? *next : Clock::time_point::max();
+        sleeping_ = true;
+        if (next) {
+            wake_.wait_until(lock, *next);
+        } else {
+            wake_.wait(lock);
+        }
+        sleeping_ = false;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Hierarchical timing wheel: four levels of 64 slots, the first at `resolution` granularity and
+// each further level 64 times coarser. Scheduling and cancelling are O(1); advancing costs one
+// slot visit per elapsed tick plus the timers that are due or cascade down a level. Timers never
+// fire early: a deadline is rounded up to the next tick.
+// Not thread-safe; TimerService below adds the locking and the thread.
+class TimerWheel {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::uint64_t; // 0 is never handed out
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(std::chrono::milliseconds resolution = std::chrono::milliseconds(10),
+                        Clock::time_point start = Clock::now());
+
+    TimerId schedule(Clock::time_point when, Callback callback);
+    // Returns false if the timer already fired or was cancelled.
+    bool cancel(TimerId id);
+
+    // Moves the callbacks of every timer due at `now` into `due` (in deadline-tick order); the
+    // caller runs them.
+    void advance(Clock::time_point now, std::vector<Callback>& due);
+
+    // Earliest time advance() has work to do: the exact tick of the next due timer, or the
+    // point where a coarser slot cascades, whichever comes first. Empty when nothing is pending.
+    std::optional<Clock::time_point> nextExpiry() const;
+
+    std::size_t size() const { return index_.size(); }
+
+  private:
+    static constexpr std::size_t kLevels = 4;
+    static constexpr unsigned kSlotBits = 6;
+    static constexpr std::size_t kSlots = std::size_t{ 1 } << kSlotBits;
+    static constexpr std::uint64_t kSlotMask = kSlots - 1;
+
+    struct Entry {
+        TimerId id;
+        std::uint64_t due; // tick
+        Callback callback;
+    };
+    using Slot = std::list<Entry>;
+    struct Location {
+        Slot* slot;
+        Slot::iterator it;
+    };
+
+    std::uint64_t tickFor(Clock::time_point when) const;
+    Clock::time_point timeOf(std::uint64_t tick) const;
+    Slot& slotFor(std::uint64_t due);
+    // Moves `it` out of `from` into the slot its deadline belongs to now.
+    void place(Slot& from, Slot::iterator it);
+    // Re-places every timer of one coarse slot; returns that slot's index.
+    std::size_t cascade(std::size_t level);
+
+    std::chrono::milliseconds resolution_;
+    Clock::time_point start_;
+    std::uint64_t current_ = 0; // next tick to process
+    TimerId nextId_ = 1;
+    std::array<std::array<Slot, kSlots>, kLevels> slots_{};
+    std::unordered_map<TimerId, Location> index_;
+};
+
+// A TimerWheel driven by its own thread, which sleeps until the next expiry (or until an earlier
+// timer is scheduled). Callbacks run on that thread without the service lock held, so they may
+// schedule and cancel timers themselves.
+class TimerService {
+  public:
+    using Clock = TimerWheel::Clock;
+    using TimerId = TimerWheel::TimerId;
+    using Callback = TimerWheel::Callback;
+
+    explicit TimerService(std::chrono::milliseconds resolution = std::chrono::milliseconds(10));
+    ~TimerService();
+
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    void start();
+    // Joins the thread; timers still pending are dropped without running.
+    void stop();
+
+    TimerId schedule(Clock::time_point when, Callback callback);
+    bool cancel(TimerId id);
+
+  private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    TimerWheel wheel_;
+    bool sleeping_ = false;
+    Clock::time_point wakeAt_ = Clock::time_point::max(); // while sleeping_
+    bool running_ = false;
+    std::thread thread_;
+};
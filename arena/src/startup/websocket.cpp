@@ -0,0 +1,265 @@
+#include "websocket.h"
+
+#include <random>
+
+namespace {
+std::uint32_t rotl(std::uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+std::uint8_t byteAt(const std::string& s, std::size_t i) {
+    return static_cast<std::uint8_t>(s[i]);
+}
+
+bool isControl(WebSocketOpcode opcode) {
+    return (static_cast<std::uint8_t>(opcode) & 0x8) != 0;
+}
+
+bool isKnownOpcode(std::uint8_t opcode) {
+    return opcode <= 0x2 || (opcode >= 0x8 && opcode <= 0xA);
+}
+
+enum class ParseResult { Incomplete, Ok, Invalid, TooLarge };
+
+struct Frame {
+    bool fin = true;
+    WebSocketOpcode opcode = WebSocketOpcode::Text;
+    bool masked = false;
+    std::string payload; // already unmasked
+    std::size_t length = 0; // bytes taken from the buffer
+};
+
+ParseResult parseFrame(const std::string& buffer, std::size_t offset, Frame& frame) {
+    const std::size_t available = buffer.size() - offset;
+    if (available < 2) return ParseResult::Incomplete;
+    const std::uint8_t b0 = byteAt(buffer, offset);
+    const std::uint8_t b1 = byteAt(buffer, offset + 1);
+    if ((b0 & 0x70) != 0 || !isKnownOpcode(b0 & 0x0F)) return ParseResult::Invalid;
+    frame.fin = (b0 & 0x80) != 0;
+    frame.opcode = static_cast<WebSocketOpcode>(b0 & 0x0F);
+    frame.masked = (b1 & 0x80) != 0;
+
+    std::size_t header = 2;
+    std::uint64_t length = b1 & 0x7F;
+    if (length == 126) {
+        if (available < 4) return ParseResult::Incomplete;
+        length = (static_cast<std::uint64_t>(byteAt(buffer, offset + 2)) << 8) | byteAt(buffer, offset + 3);
+        header = 4;
+    } else if (length == 127) {
+        if (available < 10) return ParseResult::Incomplete;
+        length = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            length = (length << 8) | byteAt(buffer, offset + 2 + i);
+        }
+        header = 10;
+    }
+    if (isControl(frame.opcode) && (length > 125 || !frame.fin)) return ParseResult::Invalid;
+    if (length > kMaxWebSocketMessage) return ParseResult::TooLarge;
+
+    const std::size_t maskOffset = offset + header;
+    if (frame.masked) header += 4;
+    if (available < header + length) return ParseResult::Incomplete;
+
+    frame.payload.assign(buffer, offset + header, static_cast<std::size_t>(length));
+    if (frame.masked) {
+        for (std::size_t i = 0; i < frame.payload.size(); ++i) {
+            frame.payload[i] = static_cast<char>(byteAt(frame.payload, i) ^ byteAt(buffer, maskOffset + i % 4));
+        }
+    }
+    frame.length = header + static_cast<std::size_t>(length);
+    return ParseResult::Ok;
+}
+} // namespace
+
+std::string sha1Digest(const std::string& data) {
+    std::uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    std::string message = data;
+    const std::uint64_t bitLength = static_cast<std::uint64_t>(data.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) message += '\0';
+    for (int i = 7; i >= 0; --i) {
+        message += static_cast<char>((bitLength >> (i * 8)) & 0xFF);
+    }
+
+    std::uint32_t w[80];
+    for (std::size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            const std::size_t p = chunk + i * 4;
+            w[i] = (static_cast<std::uint32_t>(byteAt(message, p)) << 24) |
+                   (static_cast<std::uint32_t>(byteAt(message, p + 1)) << 16) |
+                   (static_cast<std::uint32_t>(byteAt(message, p + 2)) << 8) | byteAt(message, p + 3);
+        }
+        for (std::size_t i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (std::size_t i = 0; i < 80; ++i) {
+            std::uint32_t f;
+            std::uint32_t k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const std::uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    std::string digest;
+    digest.reserve(20);
+    for (std::uint32_t word : h) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            digest += static_cast<char>((word >> shift) & 0xFF);
+        }
+    }
+    return digest;
+}
+
+std::string base64Encode(const std::string& data) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    std::size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        const std::uint32_t n = (byteAt(data, i) << 16) | (byteAt(data, i + 1) << 8) | byteAt(data, i + 2);
+        out += kAlphabet[(n >> 18) & 0x3F];
+        out += kAlphabet[(n >> 12) & 0x3F];
+        out += kAlphabet[(n >> 6) & 0x3F];
+        out += kAlphabet[n & 0x3F];
+    }
+    if (i + 1 == data.size()) {
+        const std::uint32_t n = byteAt(data, i) << 16;
+        out += kAlphabet[(n >> 18) & 0x3F];
+        out += kAlphabet[(n >> 12) & 0x3F];
+        out += "==";
+    } else if (i + 2 == data.size()) {
+        const std::uint32_t n = (byteAt(data, i) << 16) | (byteAt(data, i + 1) << 8);
+        out += kAlphabet[(n >> 18) & 0x3F];
+        out += kAlphabet[(n >> 12) & 0x3F];
+        out += kAlphabet[(n >> 6) & 0x3F];
+        out += '=';
+    }
+    return out;
+}
+
+std::string webSocketAccept(const std::string& key) {
+    return base64Encode(sha1Digest(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+}
+
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, const std::string& payload, bool mask) {
+    std::string frame;
+    frame.reserve(payload.size() + 14);
+    frame += static_cast<char>(0x80 | static_cast<std::uint8_t>(opcode));
+    const std::uint8_t maskBit = mask ? 0x80 : 0x00;
+    if (payload.size() < 126) {
+        frame += static_cast<char>(maskBit | payload.size());
+    } else if (payload.size() <= 0xFFFF) {
+        frame += static_cast<char>(maskBit | 126);
+        frame += static_cast<char>((payload.size() >> 8) & 0xFF);
+        frame += static_cast<char>(payload.size() & 0xFF);
+    } else {
+        frame += static_cast<char>(maskBit | 127);
+        const std::uint64_t length = payload.size();
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame += static_cast<char>((length >> shift) & 0xFF);
+        }
+    }
+    if (!mask) {
+        frame += payload;
+        return frame;
+    }
+    // The key only has to be unpredictable to intermediaries, not cryptographically strong.
+    thread_local std::mt19937 rng{ std::random_device{}() };
+    const std::uint32_t key = rng();
+    const std::size_t keyOffset = frame.size();
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        frame += static_cast<char>((key >> shift) & 0xFF);
+    }
+    const std::size_t payloadOffset = frame.size();
+    frame += payload;
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+        frame[payloadOffset + i] = static_cast<char>(byteAt(frame, payloadOffset + i) ^ byteAt(frame, keyOffset + i % 4));
+    }
+    return frame;
+}
+
+std::string webSocketClosePayload(std::uint16_t code) {
+    std::string payload;
+    payload += static_cast<char>((code >> 8) & 0xFF);
+    payload += static_cast<char>(code & 0xFF);
+    return payload;
+}
+
+bool WebSocketReader::read(std::string& in, std::vector<std::string>& messages, std::string& replies) {
+    const bool maskReplies = !serverSide_;
+    auto fail = [&](std::uint16_t code) {
+        replies += encodeWebSocketFrame(WebSocketOpcode::Close, webSocketClosePayload(code), maskReplies);
+        in.clear();
+        return false;
+    };
+
+    std::size_t consumed = 0;
+    for (;;) {
+        Frame frame;
+        const ParseResult result = parseFrame(in, consumed, frame);
+        if (result == ParseResult::Incomplete) break;
+        if (result == ParseResult::TooLarge) return fail(1009);
+        // Client frames must be masked and server frames must not be (RFC 6455 section 5.1).
+        if (result == ParseResult::Invalid || frame.masked != serverSide_) return fail(1002);
+        consumed += frame.length;
+
+        switch (frame.opcode) {
+            case WebSocketOpcode::Ping:
+                replies += encodeWebSocketFrame(WebSocketOpcode::Pong, frame.payload, maskReplies);
+                break;
+            case WebSocketOpcode::Pong:
+                break;
+            case WebSocketOpcode::Close:
+                // Echo the status code and stop reading.
+                replies += encodeWebSocketFrame(WebSocketOpcode::Close, frame.payload.substr(0, 2), maskReplies);
+                in.clear();
+                return false;
+            case WebSocketOpcode::Text:
+            case WebSocketOpcode::Binary:
+                if (fragmented_) return fail(1002);
+                if (frame.fin) {
+                    messages.push_back(std::move(frame.payload));
+                } else {
+                    message_ = std::move(frame.payload);
+                    fragmented_ = true;
+                }
+                break;
+            case WebSocketOpcode::Continuation:
+                if (!fragmented_) return fail(1002);
+                if (message_.size() + frame.payload.size() > kMaxWebSocketMessage) return fail(1009);
+                message_ += frame.payload;
+                if (frame.fin) {
+                    messages.push_back(std::move(message_));
+                    message_.clear();
+                    fragmented_ = false;
+                }
+                break;
+        }
+    }
+    in.erase(0, consumed);
+    return true;
+}
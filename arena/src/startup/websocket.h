@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RFC 6455 pieces shared by HttpServer and WebSocketClient: the opening-handshake key transform
+// and frame encoding/decoding. No extensions or subprotocols are negotiated.
+
+enum class WebSocketOpcode : std::uint8_t {
+    Continuation = 0x0,
+    Text = 0x1,
+    Binary = 0x2,
+    Close = 0x8,
+    Ping = 0x9,
+    Pong = 0xA,
+};
+
+// Largest message (after reassembling fragments) either side accepts.
+constexpr std::size_t kMaxWebSocketMessage = 1024 * 1024;
+
+// Raw 20-byte SHA-1 digest. Only used for the handshake, which RFC 6455 defines in terms of it.
+std::string sha1Digest(const std::string& data);
+std::string base64Encode(const std::string& data);
+
+// Sec-WebSocket-Accept value for a client's Sec-WebSocket-Key.
+std::string webSocketAccept(const std::string& key);
+
+// One frame with FIN set. Frames sent by a client must be masked (RFC 6455 section 5.3).
+std::string encodeWebSocketFrame(WebSocketOpcode opcode, const std::string& payload, bool mask);
+
+// Close frame payload carrying only a status code (1000 normal, 1002 protocol error, 1009 too big).
+std::string webSocketClosePayload(std::uint16_t code);
+
+// Turns the bytes one endpoint receives into whole messages, and produces the control frames
+// owed to the peer (pongs, the close reply) on the way.
+class WebSocketReader {
+  public:
+    // serverSide: incoming frames must be masked and replies are sent unmasked; the other way
+    // round for a client.
+    explicit WebSocketReader(bool serverSide) : serverSide_(serverSide) {}
+
+    // Consumes every complete frame at the front of `in`. Text and binary messages are appended
+    // to `messages`, control replies to `replies`. Returns false once the connection should close
+    // after `replies` is written (close frame received or protocol error).
+    bool read(std::string& in, std::vector<std::string>& messages, std::string& replies);
+
+  private:
+    bool serverSide_;
+    std::string message_; // fragments of a message that is still arriving
+    bool fragmented_ = false;
+};
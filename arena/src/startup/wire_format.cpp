@@ -0,0 +1,312 @@
+#include "wire_format.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace {
+enum Tag : unsigned char {
+    kNull = 0x00,
+    kFalse = 0x01,
+    kTrue = 0x02,
+    kUnsigned = 0x03,
+    kNegative = 0x04,
+    kDouble = 0x05,
+    kString = 0x06,
+    kArray = 0x07,
+    kObject = 0x08,
+    kSmallInt = 0x80,
+};
+
+constexpr std::size_t kMaxDepth = 64;
+
+// Field ids are index + 1. Append only: a client and server of the same wire version must agree.
+constexpr const char* kFields[] = {
+    "version",  "turn",          "battleOver",  "winner",      "reason",     "pending", "self",
+    "opponent", "activeIndex",   "active",      "pets",        "index",      "name",    "hp",
+    "maxHp",    "fainted",       "attrs",       "skills",      "id",         "pp",      "maxPP",
+    "room",     "players",       "present",     "ready",       "spectators", "status",  "spectatorNames",
+    "error",    "battleStarted", "playerId",    "type",        "skillId",    "lastActions", "p1",
+    "p2",       "spectator",     "since",       "full",        "patch",      "state",   "op",
+    "rooms",
+};
+
+const std::unordered_map<std::string, std::uint64_t>& fieldIds() {
+    static const std::unordered_map<std::string, std::uint64_t> ids = [] {
+        std::unordered_map<std::string, std::uint64_t> map;
+        for (std::size_t i = 0; i < std::size(kFields); ++i) map.emplace(kFields[i], i + 1);
+        return map;
+    }();
+    return ids;
+}
+
+void putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void putString(std::string& out, const std::string& s) {
+    putVarint(out, s.size());
+    out += s;
+}
+
+void putUnsigned(std::string& out, std::uint64_t value) {
+    if (value < 0x80) {
+        out.push_back(static_cast<char>(kSmallInt | value));
+        return;
+    }
+    out.push_back(static_cast<char>(kUnsigned));
+    putVarint(out, value);
+}
+
+void putValue(std::string& out, const nlohmann::json& value) {
+    switch (value.type()) {
+        case nlohmann::json::value_t::boolean:
+            out.push_back(static_cast<char>(value.get<bool>() ? kTrue : kFalse));
+            break;
+        case nlohmann::json::value_t::number_unsigned:
+            putUnsigned(out, value.get<std::uint64_t>());
+            break;
+        case nlohmann::json::value_t::number_integer: {
+            const std::int64_t n = value.get<std::int64_t>();
+            if (n >= 0) {
+                putUnsigned(out, static_cast<std::uint64_t>(n));
+            } else {
+                out.push_back(static_cast<char>(kNegative));
+                putVarint(out, static_cast<std::uint64_t>(-(n + 1)));
+            }
+            break;
+        }
+        case nlohmann::json::value_t::number_float: {
+            const double d = value.get<double>();
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &d, sizeof(bits));
+            out.push_back(static_cast<char>(kDouble));
+            for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+            break;
+        }
+        case nlohmann::json::value_t::string:
+            out.push_back(static_cast<char>(kString));
+            putString(out, value.get_ref<const std::string&>());
+            break;
+        case nlohmann::json::value_t::array:
+            out.push_back(static_cast<char>(kArray));
+            putVarint(out, value.size());
+            for (const auto& element : value) putValue(out, element);
+            break;
+        case nlohmann::json::value_t::object: {
+            out.push_back(static_cast<char>(kObject));
+            putVarint(out, value.size());
+            const auto& ids = fieldIds();
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                auto id = ids.find(it.key());
+                if (id != ids.end()) {
+                    putVarint(out, id->second);
+                } else {
+                    putVarint(out, 0);
+                    putString(out, it.key());
+                }
+                putValue(out, it.value());
+            }
+            break;
+        }
+        default: // null, discarded, binary
+            out.push_back(static_cast<char>(kNull));
+            break;
+    }
+}
+
+class Reader {
+  public:
+    Reader(std::string_view data, std::size_t pos, std::size_t end) : data_(data), pos_(pos), end_(end) {}
+
+    bool atEnd() const { return pos_ == end_; }
+    std::size_t remaining() const { return end_ - pos_; }
+
+    bool byte(unsigned char& out) {
+        if (pos_ >= end_) return fail("truncated");
+        out = static_cast<unsigned char>(data_[pos_++]);
+        return true;
+    }
+
+    bool varint(std::uint64_t& out) {
+        out = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            unsigned char b = 0;
+            if (!byte(b)) return false;
+            out |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return true;
+        }
+        return fail("varint too long");
+    }
+
+    bool string(std::string& out) {
+        std::uint64_t size = 0;
+        if (!varint(size)) return false;
+        if (size > remaining()) return fail("truncated");
+        out.assign(data_.substr(pos_, static_cast<std::size_t>(size)));
+        pos_ += static_cast<std::size_t>(size);
+        return true;
+    }
+
+    bool value(nlohmann::json& out, std::size_t depth) {
+        if (depth > kMaxDepth) return fail("nested too deeply");
+        unsigned char tag = 0;
+        if (!byte(tag)) return false;
+        if (tag & kSmallInt) {
+            out = static_cast<std::uint64_t>(tag & 0x7F);
+            return true;
+        }
+        std::uint64_t n = 0;
+        switch (tag) {
+            case kNull:
+                out = nullptr;
+                return true;
+            case kFalse:
+            case kTrue:
+                out = tag == kTrue;
+                return true;
+            case kUnsigned:
+                if (!varint(n)) return false;
+                out = n;
+                return true;
+            case kNegative:
+                if (!varint(n)) return false;
+                if (n > static_cast<std::uint64_t>(INT64_MAX)) return fail("integer out of range");
+                out = -static_cast<std::int64_t>(n) - 1;
+                return true;
+            case kDouble: {
+                if (remaining() < 8) return fail("truncated");
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i) {
+                    bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(data_[pos_++])) << (8 * i);
+                }
+                double d = 0;
+                std::memcpy(&d, &bits, sizeof(d));
+                out = d;
+                return true;
+            }
+            case kString: {
+                std::string s;
+                if (!string(s)) return false;
+                out = std::move(s);
+                return true;
+            }
+            case kArray: {
+                // Every element takes at least one byte, which bounds what a forged count can allocate.
+                if (!varint(n)) return false;
+                if (n > remaining()) return fail("truncated");
+                out = nlohmann::json::array();
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    nlohmann::json element;
+                    if (!value(element, depth + 1)) return false;
+                    out.push_back(std::move(element));
+                }
+                return true;
+            }
+            case kObject: {
+                if (!varint(n)) return false;
+                if (n > remaining()) return fail("truncated");
+                out = nlohmann::json::object();
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    std::uint64_t id = 0;
+                    std::string key;
+                    if (!varint(id)) return false;
+                    if (id == 0) {
+                        if (!string(key)) return false;
+                    } else if (id <= std::size(kFields)) {
+                        key = kFields[static_cast<std::size_t>(id - 1)];
+                    } else {
+                        return fail("unknown field id");
+                    }
+                    if (!value(out[key], depth + 1)) return false;
+                }
+                return true;
+            }
+            default:
+                return fail("unknown tag");
+        }
+    }
+
+    const std::string& error() const { return error_; }
+
+  private:
+    bool fail(const char* reason) {
+        if (error_.empty()) error_ = reason;
+        return false;
+    }
+
+    std::string_view data_;
+    std::size_t pos_;
+    std::size_t end_;
+    std::string error_;
+};
+
+std::string lowerTrimmed(std::string_view s, std::size_t begin, std::size_t end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) --end;
+    std::string out(s.substr(begin, end - begin));
+    std::transform(out.begin(), out.end(), out.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+} // namespace
+
+std::string encodeBinary(const nlohmann::json& value) {
+    std::string payload;
+    putValue(payload, value);
+    std::string frame = { 'R', 'A', static_cast<char>(kWireFormatVersion) };
+    frame.reserve(frame.size() + 10 + payload.size());
+    putVarint(frame, payload.size());
+    frame += payload;
+    return frame;
+}
+
+bool decodeBinary(std::string_view frame, nlohmann::json& value, std::string* error) {
+    auto fail = [&](const std::string& reason) {
+        if (error) *error = reason;
+        return false;
+    };
+    if (frame.size() < 3 || frame[0] != 'R' || frame[1] != 'A') return fail("not a rocoarena frame");
+    if (static_cast<unsigned char>(frame[2]) != kWireFormatVersion) return fail("unsupported wire version");
+
+    Reader header(frame, 3, frame.size());
+    std::uint64_t length = 0;
+    if (!header.varint(length)) return fail(header.error());
+    if (length != header.remaining()) return fail("length mismatch");
+
+    Reader body(frame, frame.size() - static_cast<std::size_t>(length), frame.size());
+    nlohmann::json decoded;
+    if (!body.value(decoded, 0)) return fail(body.error());
+    if (!body.atEnd()) return fail("trailing bytes");
+    value = std::move(decoded);
+    return true;
+}
+
+bool acceptsBinary(std::string_view accept) {
+    std::size_t start = 0;
+    while (start <= accept.size()) {
+        std::size_t end = accept.find(',', start);
+        if (end == std::string_view::npos) end = accept.size();
+        const std::size_t params = std::min(accept.find(';', start), end);
+        if (lowerTrimmed(accept, start, params) == kBinaryMediaType) {
+            // Listed with q=0 means "not acceptable".
+            const std::string rest = lowerTrimmed(accept, params, end);
+            const std::size_t q = rest.find("q=");
+            if (q == std::string::npos || std::strtod(rest.c_str() + q + 2, nullptr) > 0) return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+bool isBinaryMediaType(std::string_view contentType) {
+    return lowerTrimmed(contentType, 0, std::min(contentType.find(';'), contentType.size())) == kBinaryMediaType;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+// Compact binary encoding of the JSON messages the server exchanges (room summaries, /state
+// payloads, actions and their replies), negotiated per request with
+//   Accept: application/x-rocoarena        (response bodies)
+//   Content-Type: application/x-rocoarena  (request bodies)
+//
+// Frame:  'R' 'A' <version:1> <length:varint> <value>
+// Value:  one tag byte, then
+//   0x00 null   0x01 false   0x02 true
+//   0x03 <varint>                      non-negative integer
+//   0x04 <varint n>                    negative integer -(n + 1)
+//   0x05 <8 bytes>                     IEEE 754 double, little endian
+//   0x06 <length:varint> <bytes>       UTF-8 string
+//   0x07 <count:varint> <value>...     array
+//   0x08 <count:varint> (<key> <value>)...  object; key is a varint field id from the table in
+//                                      wire_format.cpp, or 0 followed by a string for names
+//                                      outside it
+//   0x80 | n                           integer 0..127 in the tag itself
+// Varints are LEB128 (7 bits per byte, low bits first). Field ids are only ever appended to the
+// table; a change to anything above bumps kWireFormatVersion.
+
+constexpr const char* kBinaryMediaType = "application/x-rocoarena";
+constexpr unsigned kWireFormatVersion = 1;
+
+std::string encodeBinary(const nlohmann::json& value);
+// Decodes one whole frame; fails on a truncated or trailing byte, an unknown tag, field id or
+// version, or nesting deeper than 64 levels.
+bool decodeBinary(std::string_view frame, nlohmann::json& value, std::string* error = nullptr);
+
+// True if an Accept header lists application/x-rocoarena (without q=0).
+bool acceptsBinary(std::string_view accept);
+// True if a Content-Type header names application/x-rocoarena, with or without parameters.
+bool isBinaryMediaType(std::string_view contentType);
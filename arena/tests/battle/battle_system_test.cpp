@@ -265,3 +265,24 @@ TEST(BattleSystem, TakeTurnAfterEndIsNoop) {
 
     EXPECT_EQ(battle.currentTurn(), 0); // Turn didn't increment
 }
+
+// =============================================================================
+// Roster invariant: activePetOrNull() is null only for an empty roster
+// =============================================================================
+
+TEST(BattleSystem, ActivePetOrNullOnlyNullForEmptyRoster) {
+    auto sp = makeSpecies(1, "Pet", BS{100, 100, 100, 100, 100, 100});
+    Pet fainted = makePet(sp);
+    fainted.takeDamage(fainted.maxHP());
+
+    // Invalid initial index with only a fainted pet in slot 2: still points at it.
+    Player::Roster roster{};
+    roster[2] = &fainted;
+    Player player(roster, 0);
+    EXPECT_EQ(player.activePetOrNull(), &fainted);
+    EXPECT_EQ(&player.activePet(), &fainted);
+
+    Player empty(Player::Roster{}, 0);
+    EXPECT_EQ(empty.activePetOrNull(), nullptr);
+    EXPECT_THROW(empty.activePet(), std::runtime_error);
+}
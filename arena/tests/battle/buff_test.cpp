@@ -2,6 +2,9 @@
 // Tests for Buff stat stage mechanics and invariants
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
 #include <battle/Buff.h>
 #include <entity/Pet.h>
 #include <entity/Species.h>
@@ -161,3 +164,97 @@ TEST(BuffAilment, StageLocked_Prevents_StageChanges) {
     EXPECT_EQ(delta, 0);
     EXPECT_EQ(buff.stage(Stat::Atk), 0);
 }
+
+// =============================================================================
+// Packed layout: stages in one 64-bit word, SWAR clamp/add
+// =============================================================================
+
+TEST(BuffPacked, ChangeStage_Matches_ScalarClamp_AllStats) {
+    // Every stat lane, every starting stage, every delta: compare against scalar clamp
+    // and make sure neighbouring lanes are untouched.
+    for (std::size_t s = 0; s < kStatCount; ++s) {
+        const Stat stat = static_cast<Stat>(s);
+        for (int start = -6; start <= 6; ++start) {
+            for (int delta = -20; delta <= 20; ++delta) {
+                Buff buff;
+                for (std::size_t o = 0; o < kStatCount; ++o) {
+                    buff.changeStage(static_cast<Stat>(o), (o % 2) ? 6 : -6);
+                }
+                buff.changeStage(stat, start - buff.stage(stat));
+                ASSERT_EQ(buff.stage(stat), start);
+
+                const int expected = std::clamp(start + delta, -6, 6);
+                EXPECT_EQ(buff.changeStage(stat, delta), expected - start);
+                EXPECT_EQ(buff.stage(stat), expected);
+                for (std::size_t o = 0; o < kStatCount; ++o) {
+                    if (o == s) continue;
+                    EXPECT_EQ(buff.stage(static_cast<Stat>(o)), (o % 2) ? 6 : -6);
+                }
+            }
+        }
+    }
+}
+
+TEST(BuffPacked, AddStagesClamped_AllLanesAtOnce) {
+    Buff buff;
+    buff.changeStage(Stat::Atk, 5);
+    buff.changeStage(Stat::Def, -5);
+    buff.changeStage(Stat::Spe, 2);
+
+    const std::array<int, kStatCount> deltas = {3, 3, -3, 12, -12, 3, 0, 20, -20};
+    const std::uint64_t packed = Buff::addStagesClamped(buff.stageWord(), Buff::deltaWordFor(deltas));
+
+    Buff expected = buff;
+    for (std::size_t s = 0; s < kStatCount; ++s) {
+        expected.changeStage(static_cast<Stat>(s), deltas[s]);
+    }
+    EXPECT_EQ(packed, expected.stageWord());
+    EXPECT_EQ(expected.stage(Stat::Atk), 6);
+    EXPECT_EQ(expected.stage(Stat::Def), -6);
+    EXPECT_EQ(expected.stage(Stat::Spe), 5);
+    EXPECT_EQ(expected.stage(Stat::Eva), 6);
+    EXPECT_EQ(expected.stage(Stat::Cri), -6);
+}
+
+TEST(BuffPacked, Equality_And_Hash_Follow_State) {
+    std::array<AttrType, 2> attrs = {AttrType::Normal, AttrType::None};
+    Buff a;
+    Buff b;
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(std::hash<Buff>{}(a), std::hash<Buff>{}(b));
+
+    a.changeStage(Stat::SpA, 2);
+    EXPECT_NE(a, b);
+    b.changeStage(Stat::SpA, 2);
+    EXPECT_EQ(a, b);
+
+    a.applyAilment(Ailment::Poison, attrs);
+    EXPECT_NE(a, b);
+    EXPECT_NE(a.hash(), b.hash());
+    b.applyAilment(Ailment::Poison, attrs);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.hash(), b.hash());
+
+    a.setDoubleLoss();
+    EXPECT_NE(a, b);
+    a.clearDoubleLoss();
+    EXPECT_EQ(a, b);
+
+    // clearAilments leaves stages alone; reset() returns to the default-constructed state.
+    a.clearAilments();
+    EXPECT_EQ(a.stage(Stat::SpA), 2);
+    a.reset();
+    EXPECT_EQ(a, Buff{});
+}
+
+TEST(BuffPacked, Copy_Is_Two_Words) {
+    static_assert(sizeof(Buff) == 16, "Buff should stay two 64-bit words");
+    static_assert(std::is_trivially_copyable_v<Buff>, "Buff should be memcpy-clonable");
+    Buff a;
+    a.changeStage(Stat::Eva, -4);
+    a.setImmuneToExpel();
+    Buff b = a;
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(b.stage(Stat::Eva), -4);
+    EXPECT_TRUE(b.immuneToExpel());
+}
@@ -0,0 +1,155 @@
+// tests/battle/state_hash_test.cpp
+// Zobrist state hash: incremental updates match a from-scratch recompute, and
+// BattleSystem::stateHash() tracks HP / PP / Buff / active index / turn parity.
+
+#include <gtest/gtest.h>
+#include <battle/BattleSystem.h>
+#include <battle/Action.h>
+#include <entity/Pet.h>
+#include <entity/Player.h>
+#include <skill/SkillRegistry.h>
+#include <core/rng/rng.h>
+
+namespace {
+
+Species makeSpecies(int id, const char* name, BS bs) {
+    return Species(id, name, {AttrType::Normal, AttrType::None}, bs);
+}
+
+Pet makePet(Species& sp) {
+    IVData iv{31,31,31,31,31,31};
+    EVData ev{0,0,0,0,0,0};
+    Pet pet(&sp, iv, ev);
+    pet.calcRealStat(sp.baseStats(), iv, ev, NatureType::Hardy, 100);
+    return pet;
+}
+
+class FixedDamageAction : public Action {
+public:
+    FixedDamageAction(int dmg) : Action(ActionType::Skill), dmg_(dmg) {}
+    int priority() const override { return 0; }
+    void execute(BattleSystem& /*battle*/, Player& /*self*/, Player& opponent) override {
+        opponent.activePet().takeDamage(dmg_);
+    }
+
+private:
+    int dmg_;
+};
+
+} // namespace
+
+TEST(StateHash, IncrementalMatchesScratch_RandomOps) {
+    auto sp = makeSpecies(1, "Hasher", BS{100, 100, 100, 100, 100, 100});
+    SkillRegistry registry;
+    std::vector<SkillBase> skills;
+    skills.emplace_back(11, "A", "hit", SkillType::Physical, AttrType::Normal, 40, 10);
+    skills.emplace_back(12, "B", "blast", SkillType::Magical, AttrType::Normal, 60, 5);
+    ASSERT_TRUE(registry.load(std::move(skills)));
+    Pet pet = makePet(sp);
+    pet.setLearnableSkills({11, 12});
+    ASSERT_TRUE(pet.configureSkill(11, registry));
+    ASSERT_TRUE(pet.configureSkill(12, registry));
+
+    PetBattleState& state = pet.battleState();
+    ASSERT_EQ(state.zobrist(), state.zobristFromScratch());
+
+    RNG::instance().reseed(2024);
+    const std::array<AttrType, 2> attrs = {AttrType::Normal, AttrType::None};
+    for (int i = 0; i < 5000; ++i) {
+        switch (RNG::instance().range<int>(0, 11)) {
+            case 0: state.takeDamage(RNG::instance().range<int>(0, 80)); break;
+            case 1: state.restoreHP(RNG::instance().range<int>(0, 80)); break;
+            case 2: state.consumePP(RNG::instance().range<int>(0, 1) ? 11 : 12); break;
+            case 3: state.setDamageMultiplier(RNG::instance().range<int>(0, 4) * 0.25); break;
+            case 4: state.setDamageMultiplierTurns(0.5, RNG::instance().range<int>(0, 3)); break;
+            case 5: state.setDamageImmunityTurns(RNG::instance().range<int>(0, 2)); break;
+            case 6: state.setFlatDamageReduction(RNG::instance().range<int>(0, 10)); break;
+            case 7: state.setPerHitDamageReduction(RNG::instance().range<int>(0, 10), RNG::instance().range<int>(0, 3)); break;
+            case 8: state.tickDamageReductionTurn(); break;
+            case 9: state.resetTurnDamageTaken(); break;
+            case 10: state.buff().changeStage(Stat::Spe, RNG::instance().range<int>(-3, 3)); break;
+            case 11: state.buff().applyAilment(Ailment::Poison, attrs); break;
+        }
+        ASSERT_EQ(state.zobrist(), state.zobristFromScratch()) << "diverged at op " << i;
+    }
+}
+
+TEST(StateHash, IdenticalBattlesHashEqual_DifferentHpDiffers) {
+    auto sp1 = makeSpecies(1, "A", BS{100, 100, 100, 100, 100, 100});
+    auto sp2 = makeSpecies(2, "B", BS{90, 110, 90, 110, 90, 110});
+
+    Pet a1 = makePet(sp1), a2 = makePet(sp2);
+    Pet b1 = makePet(sp1), b2 = makePet(sp2);
+    Player::Roster ra1{}, ra2{}, rb1{}, rb2{};
+    ra1[0] = &a1; ra2[0] = &a2; rb1[0] = &b1; rb2[0] = &b2;
+    Player pa1(ra1, 0), pa2(ra2, 0), pb1(rb1, 0), pb2(rb2, 0);
+
+    BattleSystem battleA, battleB;
+    EXPECT_EQ(battleA.stateHash(), 0u);
+    battleA.init(pa1, pa2);
+    battleB.init(pb1, pb2);
+    EXPECT_EQ(battleA.stateHash(), battleB.stateHash());
+
+    FixedDamageAction hit(30), hit2(20);
+    battleA.takeTurn(hit, hit2);
+    EXPECT_NE(battleA.stateHash(), battleB.stateHash());
+    FixedDamageAction hitB(30), hit2B(20);
+    battleB.takeTurn(hitB, hit2B);
+    EXPECT_EQ(battleA.stateHash(), battleB.stateHash());
+
+    b1.takeDamage(1);
+    EXPECT_NE(battleA.stateHash(), battleB.stateHash());
+}
+
+TEST(StateHash, SwitchAndSlotOrderChangeHash) {
+    auto sp1 = makeSpecies(1, "A", BS{100, 100, 100, 100, 100, 100});
+    auto sp2 = makeSpecies(2, "B", BS{90, 110, 90, 110, 90, 110});
+    Pet p1 = makePet(sp1), p2 = makePet(sp2);
+
+    Player::Roster roster{};
+    roster[0] = &p1;
+    roster[1] = &p2;
+    Player player(roster, 0);
+    const std::uint64_t before = player.stateHash();
+    ASSERT_TRUE(player.switchTo(1));
+    EXPECT_NE(player.stateHash(), before);
+    ASSERT_TRUE(player.switchTo(0));
+    EXPECT_EQ(player.stateHash(), before);
+
+    Player::Roster swapped{};
+    swapped[0] = &p2;
+    swapped[1] = &p1;
+    EXPECT_NE(Player(swapped, 0).stateHash(), before);
+}
+
+TEST(StateHash, TurnParityAndBuffAffectHash) {
+    auto sp = makeSpecies(1, "A", BS{100, 100, 100, 100, 100, 100});
+    Pet p1 = makePet(sp), p2 = makePet(sp);
+    Player::Roster r1{}, r2{};
+    r1[0] = &p1;
+    r2[0] = &p2;
+    Player pl1(r1, 0), pl2(r2, 0);
+    BattleSystem battle;
+    battle.init(pl1, pl2);
+
+    const std::uint64_t h0 = battle.stateHash();
+    p1.buff().changeStage(Stat::Atk, 1);
+    const std::uint64_t h1 = battle.stateHash();
+    EXPECT_NE(h0, h1);
+    p1.buff().changeStage(Stat::Atk, -1);
+    EXPECT_EQ(battle.stateHash(), h0);
+
+    // Mirrored buffs on opposite sides must not cancel out.
+    p1.buff().changeStage(Stat::Def, 2);
+    p2.buff().changeStage(Stat::Def, 2);
+    EXPECT_NE(battle.stateHash(), h0);
+    p1.buff().resetStages();
+    p2.buff().resetStages();
+
+    FixedDamageAction zero1(0), zero2(0);
+    battle.takeTurn(zero1, zero2);
+    EXPECT_NE(battle.stateHash(), h0);
+    FixedDamageAction zero3(0), zero4(0);
+    battle.takeTurn(zero3, zero4);
+    EXPECT_EQ(battle.stateHash(), h0);
+}
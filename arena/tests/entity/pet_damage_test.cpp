@@ -178,3 +178,30 @@ TEST(PetDamage, RestoreHP_Negative_NoChange) {
     pet.restoreHP(-10);
     EXPECT_EQ(pet.currentHP(), before);
 }
+
+// =============================================================================
+// Reset for a new battle
+// =============================================================================
+
+TEST(PetReset, ResetForBattle_Restores_Prototype_State) {
+    auto sp = makeSpecies(BS{100, 50, 50, 50, 50, 50});
+    Pet prototype = makePet(sp);
+    prototype.setLearnableSkills({1, 2, 3});
+
+    Pet pet = prototype;
+    pet.takeDamage(pet.maxHP());
+    pet.setDamageImmunityTurns(3);
+    ASSERT_TRUE(pet.isFainted());
+
+    const int* skillBuffer = pet.learnableSkills().data();
+    pet.resetForBattle(prototype);
+
+    EXPECT_EQ(pet.currentHP(), prototype.maxHP());
+    EXPECT_FALSE(pet.isFainted());
+    EXPECT_EQ(pet.learnableSkills(), prototype.learnableSkills());
+    EXPECT_EQ(pet.learnableSkills().data(), skillBuffer); // storage reused
+    EXPECT_EQ(pet.battleState().zobrist(), prototype.battleState().zobrist());
+
+    // Damage immunity from the previous battle is gone.
+    EXPECT_EQ(pet.takeDamage(10), pet.maxHP() - 10);
+}
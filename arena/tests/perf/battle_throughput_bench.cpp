@@ -3,7 +3,8 @@
 //
 // Goal: Measure how many battles/second the engine can sustain
 // Input: 10K and 100K identical fixed-seed battles (5 turns each)
-// Metrics: Total wall-clock time, battles/sec, μs/battle
+// Metrics: Total wall-clock time, battles/sec, μs/battle, plus the size of the
+//          hot (PetBattleState) / cold (PetProfile) halves of Pet
 //
 // This is a standalone executable, not gtest. Outputs structured results.
 
@@ -14,7 +15,10 @@
 #include <battle/BattleSystem.h>
 #include <battle/Action.h>
 #include <entity/Pet.h>
+#include <entity/PetBattleState.h>
+#include <entity/PetProfile.h>
 #include <entity/Player.h>
+#include <core/logger/logger.h>
 #include <core/rng/rng.h>
 
 namespace {
@@ -96,7 +100,14 @@ void printResult(const BenchResult& r) {
 int main() {
     std::printf("=== RocoArena Battle Throughput Benchmark ===\n\n");
 
+    std::printf("Layout:\n");
+    std::printf("  sizeof(Pet)            = %zu\n", sizeof(Pet));
+    std::printf("  sizeof(PetBattleState) = %zu (alignof %zu)\n", sizeof(PetBattleState), alignof(PetBattleState));
+    std::printf("  sizeof(PetProfile)     = %zu\n", sizeof(PetProfile));
+    std::printf("  sizeof(Buff)           = %zu\n\n", sizeof(Buff));
+
     // Suppress logger output for clean benchmark
+    Logger::setLevel(Logger::Level::Warn);
     printResult(runBattleBench("5-turn battles (10K)", 10000, 5));
     printResult(runBattleBench("5-turn battles (100K)", 100000, 5));
     printResult(runBattleBench("20-turn battles (10K)", 10000, 20));
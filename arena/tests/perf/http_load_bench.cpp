@@ -0,0 +1,215 @@
+// tests/perf/http_load_bench.cpp
+// Performance benchmark: HttpServer under loopback load
+//
+// Goal: Compare the legacy thread-per-connection server with the epoll reactor, and
+//       connection-per-request with keep-alive / pipelined HttpClient traffic
+// Input: N client threads, each issuing M GET /state requests over loopback
+// Metrics: requests/sec, TCP connections opened, p50 / p99 / max latency per request
+//          (per batch for the pipelined mode); pipelined responses are checked for ordering
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <core/logger/logger.h>
+#include <http_client.h>
+#include <http_server.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kClients = 32;
+constexpr int kRequestsPerClient = 200;
+constexpr int kPipelineDepth = 8;
+
+HttpResponse handleState(const HttpRequest& req) {
+    // Roughly the size of a real /state payload.
+    nlohmann::json state;
+    state["path"] = req.path;
+    state["query"] = req.query;
+    state["turn"] = 12;
+    for (int i = 0; i < 6; ++i) {
+        state["team"].push_back({ { "slot", i }, { "hp", 300 - i * 10 }, { "maxHp", 300 }, { "name", "BenchPet" } });
+    }
+    return HttpResponse{ 200, state.dump() };
+}
+
+// Sends one request on a fresh connection and reads until the server closes it.
+// Returns false on any socket error or a non-200 reply.
+bool roundTrip(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+    static const char kRequest[] = "GET /state?room=1&player=0 HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    if (send(fd, kRequest, sizeof(kRequest) - 1, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(kRequest) - 1)) {
+        close(fd);
+        return false;
+    }
+    std::string reply;
+    char buffer[4096];
+    ssize_t n = 0;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        reply.append(buffer, static_cast<std::size_t>(n));
+    }
+    close(fd);
+    return reply.compare(0, 12, "HTTP/1.1 200") == 0;
+}
+
+struct LoadResult {
+    double seconds = 0.0;
+    int ok = 0;
+    int failed = 0;
+    int connections = 0;
+    std::vector<double> latenciesUs;
+};
+
+struct ClientStats {
+    int ok = 0;
+    int failed = 0;
+    int connections = 0;
+    std::vector<double> latenciesUs;
+};
+
+double elapsedUs(Clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+}
+
+// One TCP connection per request (what every client did before keep-alive).
+void connectionPerRequest(int port, ClientStats& stats) {
+    for (int i = 0; i < kRequestsPerClient; ++i) {
+        const auto t0 = Clock::now();
+        ++stats.connections;
+        if (!roundTrip(port)) {
+            ++stats.failed;
+            continue;
+        }
+        ++stats.ok;
+        stats.latenciesUs.push_back(elapsedUs(t0));
+    }
+}
+
+// Sequential requests over one persistent HttpClient connection.
+void keepAliveClient(int port, ClientStats& stats) {
+    HttpClient client("127.0.0.1", port);
+    stats.connections = 1;
+    for (int i = 0; i < kRequestsPerClient; ++i) {
+        const auto t0 = Clock::now();
+        if (client.get("/state?room=1&player=0").status != 200) {
+            ++stats.failed;
+            continue;
+        }
+        ++stats.ok;
+        stats.latenciesUs.push_back(elapsedUs(t0));
+    }
+}
+
+// kPipelineDepth requests written back-to-back per round trip; each response must echo its
+// own sequence number, in order.
+void pipelinedClient(int port, ClientStats& stats) {
+    HttpClient client("127.0.0.1", port);
+    stats.connections = 1;
+    for (int i = 0; i < kRequestsPerClient; i += kPipelineDepth) {
+        std::vector<HttpClientRequest> batch;
+        for (int k = 0; k < kPipelineDepth; ++k) {
+            batch.push_back({ "GET", "/state?seq=" + std::to_string(i + k), "" });
+        }
+        const auto t0 = Clock::now();
+        const auto responses = client.pipeline(batch);
+        const double us = elapsedUs(t0);
+        for (int k = 0; k < kPipelineDepth; ++k) {
+            const std::string expect = "\"seq=" + std::to_string(i + k) + "\"";
+            if (responses[k].status == 200 && responses[k].body.find(expect) != std::string::npos) {
+                ++stats.ok;
+            } else {
+                ++stats.failed;
+            }
+        }
+        stats.latenciesUs.push_back(us);
+    }
+}
+
+LoadResult runLoad(const HttpServerOptions& options, void (*clientFn)(int, ClientStats&)) {
+    HttpServer server(0, options);
+    server.setHandler(handleState);
+    LoadResult result;
+    std::string error;
+    if (!server.start(&error)) {
+        std::printf("  server start failed: %s\n", error.c_str());
+        return result;
+    }
+    const int port = server.port();
+
+    std::vector<ClientStats> perClient(kClients);
+    std::vector<std::thread> clients;
+    const auto start = Clock::now();
+    for (int c = 0; c < kClients; ++c) {
+        clients.emplace_back([&, c]() { clientFn(port, perClient[c]); });
+    }
+    for (auto& t : clients) t.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    server.stop();
+
+    for (const auto& stats : perClient) {
+        result.ok += stats.ok;
+        result.failed += stats.failed;
+        result.connections += stats.connections;
+        result.latenciesUs.insert(result.latenciesUs.end(), stats.latenciesUs.begin(), stats.latenciesUs.end());
+    }
+    std::sort(result.latenciesUs.begin(), result.latenciesUs.end());
+    return result;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const std::size_t idx = std::min(sorted.size() - 1, static_cast<std::size_t>(p * (sorted.size() - 1)));
+    return sorted[idx];
+}
+
+void printResult(const char* name, const LoadResult& r) {
+    std::printf("  %-36s  %6d ok  %4d failed  %5d conns  %9.0f req/s  p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+                name, r.ok, r.failed, r.connections, r.seconds > 0 ? r.ok / r.seconds : 0.0,
+                percentile(r.latenciesUs, 0.50), percentile(r.latenciesUs, 0.99),
+                r.latenciesUs.empty() ? 0.0 : r.latenciesUs.back());
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena HTTP Loopback Load Benchmark ===\n");
+    std::printf("  %d clients x %d requests, hardware threads: %u\n\n", kClients, kRequestsPerClient,
+                std::thread::hardware_concurrency());
+
+    // Suppress logger output for clean benchmark
+    Logger::setLevel(Logger::Level::Warn);
+
+    HttpServerOptions legacy;
+    legacy.threadPerConnection = true;
+    printResult("thread-per-connection, conn/request", runLoad(legacy, connectionPerRequest));
+
+    HttpServerOptions reactor;
+    printResult("epoll reactor, conn/request", runLoad(reactor, connectionPerRequest));
+    printResult("epoll reactor, keep-alive", runLoad(reactor, keepAliveClient));
+    printResult("epoll reactor, pipelined x8", runLoad(reactor, pipelinedClient));
+
+    std::printf("\n=== Benchmark complete ===\n");
+    return 0;
+}
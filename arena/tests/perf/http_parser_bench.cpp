@@ -0,0 +1,250 @@
+// tests/perf/http_parser_bench.cpp
+// Performance benchmark: HTTP request parsing
+//
+// Goal: Compare the single-pass string_view parser (parseHttpRequest) with the parser it
+//       replaced, which framed each request by re-scanning its headers, copied it out of the
+//       receive buffer, then parsed it again through an istringstream into owned strings and a
+//       lower-cased header map
+// Input: a browser-like GET /state, a client GET /state?since= long-poll, a POST /action with
+//        a JSON body, and a pipelined batch of 16 GETs parsed out of one buffer
+// Metrics: ns per request for both parsers; both must agree on method, path, query, body and
+//          the headers the server reads
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <http_request.h>
+
+namespace {
+
+constexpr int kIterations = 100000;
+
+// ---- The previous parser, kept verbatim in behaviour as the baseline -------------------------
+
+struct LegacyRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+    std::string query;
+    std::unordered_map<std::string, std::string> headers;
+};
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    auto start = s.find_first_not_of(" \t\r\n");
+    auto end = s.find_last_not_of(" \t\r\n");
+    if (start == std::string::npos) return {};
+    return s.substr(start, end - start + 1);
+}
+
+// frameRequest(): the reactor's framing pass over the receive buffer.
+std::size_t legacyFrame(const std::string& raw, std::size_t offset) {
+    const std::size_t headerEnd = raw.find("\r\n\r\n", offset);
+    if (headerEnd == std::string::npos) return 0;
+    const std::size_t requestLineEnd = raw.find("\r\n", offset);
+    std::size_t contentLength = 0;
+    std::size_t lineStart = requestLineEnd + 2;
+    while (lineStart < headerEnd) {
+        std::size_t lineEnd = raw.find("\r\n", lineStart);
+        const std::string line = raw.substr(lineStart, lineEnd - lineStart);
+        auto pos = line.find(':');
+        if (pos != std::string::npos) {
+            const std::string key = toLower(trim(line.substr(0, pos)));
+            if (key == "content-length") {
+                try {
+                    contentLength = static_cast<std::size_t>(std::stoul(trim(line.substr(pos + 1))));
+                } catch (...) {
+                    contentLength = 0;
+                }
+            } else if (key == "connection") {
+                (void)toLower(line.substr(pos + 1));
+            }
+        }
+        lineStart = lineEnd + 2;
+    }
+    const std::size_t total = headerEnd + 4 + contentLength - offset;
+    return raw.size() - offset < total ? 0 : total;
+}
+
+// handleRawRequest(): the worker's parse of the copied-out request.
+LegacyRequest legacyParse(const std::string& raw) {
+    std::istringstream iss(raw);
+    std::string line;
+    std::getline(iss, line);
+    std::istringstream lineStream(line);
+    LegacyRequest req;
+    lineStream >> req.method;
+    std::string path;
+    lineStream >> path;
+    auto qpos = path.find('?');
+    if (qpos != std::string::npos) {
+        req.path = path.substr(0, qpos);
+        req.query = path.substr(qpos + 1);
+    } else {
+        req.path = path;
+    }
+    while (std::getline(iss, line)) {
+        if (line == "\r" || line.empty()) break;
+        auto pos = line.find(':');
+        if (pos == std::string::npos) continue;
+        req.headers[toLower(trim(line.substr(0, pos)))] = trim(line.substr(pos + 1));
+    }
+    auto it = req.headers.find("content-length");
+    int contentLen = 0;
+    if (it != req.headers.end()) {
+        try {
+            contentLen = std::stoi(it->second);
+        } catch (...) {
+            contentLen = 0;
+        }
+    }
+    if (contentLen > 0) {
+        std::string body;
+        body.resize(static_cast<std::size_t>(contentLen));
+        iss.read(body.data(), contentLen);
+        req.body = body;
+    }
+    return req;
+}
+
+// ---- Inputs -----------------------------------------------------------------------------------
+
+const std::string kBrowserGet =
+    "GET /state?room=arena-7&playerId=1 HTTP/1.1\r\n"
+    "Host: arena.example.com:8080\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: http://arena.example.com:8080/\r\n"
+    "Connection: keep-alive\r\n"
+    "If-None-Match: \"4344117235288113152-12-7-1\"\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+
+const std::string kLongPoll = "GET /state?room=arena-7&playerId=2&since=41&timeout=25000 HTTP/1.1\r\n"
+                              "Host: 127.0.0.1\r\n"
+                              "Accept: application/x-rocoarena, application/json\r\n"
+                              "\r\n";
+
+const std::string kPostAction = "POST /action HTTP/1.1\r\n"
+                                "Host: 127.0.0.1\r\n"
+                                "Content-Type: application/json\r\n"
+                                "Content-Length: 58\r\n"
+                                "\r\n"
+                                "{\"playerId\":1,\"room\":\"arena-7\",\"skillId\":3,\"type\":\"skill\"}";
+
+struct Timing {
+    double legacyNs = 0;
+    double viewNs = 0;
+    bool agree = true;
+};
+
+double nsPerRequest(std::chrono::steady_clock::time_point start, long requests) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           static_cast<double>(requests);
+}
+
+bool sameRequest(const LegacyRequest& legacy, const HttpRequest& req) {
+    if (legacy.method != req.method || legacy.path != req.path || legacy.query != req.query ||
+        legacy.body != req.body) {
+        return false;
+    }
+    for (const char* name : { "host", "accept", "if-none-match", "content-type", "connection" }) {
+        auto it = legacy.headers.find(name);
+        const std::string expected = it == legacy.headers.end() ? std::string() : it->second;
+        if (expected != req.header(name)) return false;
+    }
+    return true;
+}
+
+// Parses every request in `buffer` (one or a pipelined batch) the way each server path did.
+Timing run(const std::string& buffer, int iterations) {
+    Timing timing;
+    long requests = 0;
+    std::size_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::size_t offset = 0;
+        while (offset < buffer.size()) {
+            const std::size_t length = legacyFrame(buffer, offset);
+            if (length == 0) break;
+            const LegacyRequest req = legacyParse(buffer.substr(offset, length));
+            sink += req.path.size() + req.headers.size();
+            offset += length;
+            ++requests;
+        }
+    }
+    timing.legacyNs = nsPerRequest(start, requests);
+
+    requests = 0;
+    start = std::chrono::steady_clock::now();
+    HttpRequest req;
+    for (int i = 0; i < iterations; ++i) {
+        std::string_view rest = buffer;
+        std::size_t length = 0;
+        while (!rest.empty() && parseHttpRequest(rest, req, length) == HttpParseResult::Complete) {
+            sink += req.path.size() + req.headerCount;
+            rest.remove_prefix(length);
+            ++requests;
+        }
+    }
+    timing.viewNs = nsPerRequest(start, requests);
+    if (sink == 0) std::printf("  (sink=%zu)\n", sink);
+
+    std::size_t offset = 0;
+    std::string_view rest = buffer;
+    std::size_t length = 0;
+    while (offset < buffer.size()) {
+        const std::size_t legacyLength = legacyFrame(buffer, offset);
+        if (parseHttpRequest(rest, req, length) != HttpParseResult::Complete || length != legacyLength ||
+            !sameRequest(legacyParse(buffer.substr(offset, legacyLength)), req)) {
+            timing.agree = false;
+            break;
+        }
+        offset += length;
+        rest.remove_prefix(length);
+    }
+    return timing;
+}
+
+void print(const char* name, const Timing& t, bool& ok) {
+    ok = ok && t.agree;
+    std::printf("  %-28s  %12.1f  %12.1f  %8.1fx  %8s\n", name, t.legacyNs, t.viewNs, t.legacyNs / t.viewNs,
+                t.agree ? "ok" : "MISMATCH");
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena HTTP Request Parser Benchmark ===\n\n");
+    std::printf("  %-28s  %12s  %12s  %9s  %8s\n", "request", "legacy ns", "view ns", "speedup", "check");
+
+    std::string pipelined;
+    for (int i = 0; i < 16; ++i) {
+        pipelined += "GET /room?name=arena-" + std::to_string(i) + " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    }
+
+    bool ok = true;
+    print("browser GET /state", run(kBrowserGet, kIterations), ok);
+    print("long-poll GET /state?since", run(kLongPoll, kIterations), ok);
+    print("POST /action (JSON body)", run(kPostAction, kIterations), ok);
+    print("16 pipelined GET /room", run(pipelined, kIterations / 16), ok);
+
+    std::printf("\n=== Benchmark complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
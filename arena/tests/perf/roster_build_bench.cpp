@@ -0,0 +1,134 @@
+// tests/perf/roster_build_bench.cpp
+// Performance benchmark: random roster construction at battle start
+//
+// Goal: Compare the old buildRandomRoster (copy and shuffle every template id, then
+//       createPetFromTemplate per pet: calcRealStat, learnable-skill copy, configureSkill)
+//       with RosterSampler (partial Fisher–Yates over a kept permutation plus a copy of the
+//       prototype built at load time)
+// Input: a synthetic DataStore of 300 templates with 8 learnable skills each (60 skills);
+//        6-pet rosters as the server deals them
+// Metrics: ns per roster for both; every sampled pet must match createPetFromTemplate for its
+//          species, a roster must not repeat a template, and over 100000 rosters every template
+//          must come up within 10% of its expected count
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <data_loader.h>
+#include <entity/Player.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+constexpr int kTemplates = 300;
+constexpr int kSkills = 60;
+constexpr int kLearnable = 8;
+constexpr int kIterations = 100000;
+
+// What server.cpp and local_battle.cpp each did before.
+std::vector<std::unique_ptr<Pet>> legacyRoster(const DataStore& store, std::mt19937& rng, std::size_t count) {
+    std::vector<int> ids;
+    ids.reserve(store.pets.size());
+    for (const auto& it : store.pets) {
+        ids.push_back(it.first);
+    }
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::vector<std::unique_ptr<Pet>> roster;
+    for (std::size_t i = 0; i < ids.size() && roster.size() < count; ++i) {
+        auto it = store.pets.find(ids[i]);
+        if (it == store.pets.end()) continue;
+        auto pet = createPetFromTemplate(it->second, store.skills, 100);
+        if (pet) roster.push_back(std::move(pet));
+    }
+    return roster;
+}
+
+bool samePet(const Pet& a, const Pet& b) {
+    if (a.speciesId() != b.speciesId() || a.maxHP() != b.maxHP() || a.currentHP() != b.currentHP() ||
+        a.attack() != b.attack() || a.defense() != b.defense() || a.specialAttack() != b.specialAttack() ||
+        a.specialDefense() != b.specialDefense() || a.currentSpeed() != b.currentSpeed() ||
+        a.learnableSkills() != b.learnableSkills()) {
+        return false;
+    }
+    for (std::size_t slot = 0; slot < Pet::kMaxSkillSlots; ++slot) {
+        if (a.battleState().skillAt(slot) != b.battleState().skillAt(slot) ||
+            a.battleState().ppAt(slot) != b.battleState().ppAt(slot)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkSampler(const DataStore& store) {
+    RosterSampler sampler;
+    std::mt19937 rng(99);
+    std::unordered_map<int, int> counts;
+    bool ok = store.prototypes.size() == static_cast<std::size_t>(kTemplates);
+    for (int i = 0; i < kIterations && ok; ++i) {
+        const auto roster = sampler.draw(store, rng, Player::kMaxPets);
+        std::unordered_set<int> seen;
+        ok = roster.size() == Player::kMaxPets;
+        for (const auto& pet : roster) {
+            ok = ok && seen.insert(pet->speciesId()).second;
+            ++counts[pet->speciesId()];
+            if (i < 100) {
+                const auto fresh = createPetFromTemplate(store.pets.at(pet->speciesId()), store.skills, 100);
+                ok = ok && samePet(*pet, *fresh);
+            }
+        }
+    }
+    const double expected = static_cast<double>(kIterations) * Player::kMaxPets / kTemplates;
+    int lowest = kIterations;
+    int highest = 0;
+    for (int id = 1; id <= kTemplates; ++id) {
+        lowest = std::min(lowest, counts[id]);
+        highest = std::max(highest, counts[id]);
+    }
+    ok = ok && lowest >= expected * 0.9 && highest <= expected * 1.1;
+    ok = ok && sampler.draw(store, rng, kTemplates + 5).size() == static_cast<std::size_t>(kTemplates);
+    std::printf("  sampler: identical pets, distinct per roster, template counts %d..%d (expected %.0f): %s\n",
+                lowest, highest, expected, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+template <typename Fn>
+double nsPerRoster(Fn&& build) {
+    std::size_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) sink += build().size();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::printf("  (sink=%zu)\n", sink);
+    return ns / kIterations;
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena Roster Construction Benchmark ===\n\n");
+    const DataStore store = fixtures::makeStore(kTemplates, kSkills, kLearnable);
+    const bool ok = checkSampler(store);
+
+    std::mt19937 rng(1);
+    const double legacyNs = nsPerRoster([&] { return legacyRoster(store, rng, Player::kMaxPets); });
+    RosterSampler sampler;
+    const double sampledNs = nsPerRoster([&] { return sampler.draw(store, rng, Player::kMaxPets); });
+
+    std::printf("\n  %-44s  %10s\n", "roster of 6 from 300 templates", "ns/roster");
+    std::printf("  %-44s  %10.0f\n", "shuffle ids + createPetFromTemplate (before)", legacyNs);
+    std::printf("  %-44s  %10.0f\n", "RosterSampler: sample + prototype copy (after)", sampledNs);
+    std::printf("  speedup: %.1fx\n", legacyNs / sampledNs);
+
+    std::printf("\n=== Benchmark complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// tests/perf/state_build_bench.cpp
+// Performance benchmark: /state generation cost (BattleSession::stateForPlayer)
+//
+// Goal: Measure what a single /state poll costs the server, including the
+//       active-pet lookups done by pendingForPlayer / needsForceSwitch
+// Input: 6v6 session with 4 skills per pet; a session whose opponent roster is empty
+// Metrics: ns/call for stateForPlayer, spectatorState, pendingForPlayer, tick, and the
+//          active-pet lookup itself (old try/catch around activePet() vs activePetOrNull()),
+//          and a /state body serialised per request vs served from the per-version cache
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <battle_session.h>
+#include <core/logger/logger.h>
+#include <skill/SkillRegistry.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+using fixtures::makeRegistry;
+using fixtures::makeRoster;
+
+struct BenchResult {
+    const char* name;
+    int count;
+    double totalMs;
+    double perCallNs;
+};
+
+template <typename Fn> BenchResult runBench(const char* name, int iterations, Fn&& fn) {
+    std::size_t sink = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink += fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (sink == 0) std::printf("  (sink=%zu)\n", sink);
+    return {name, iterations, ms, ms * 1e6 / iterations};
+}
+
+void printResult(const BenchResult& r) {
+    std::printf("  %-40s  %8d calls  %8.1f ms  %9.1f ns/call\n", r.name, r.count, r.totalMs, r.perCallNs);
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena /state Generation Benchmark ===\n\n");
+
+    // Suppress logger output for clean benchmark
+    Logger::setLevel(Logger::Level::Warn);
+
+    Species sp(1, "Bench", {AttrType::Normal, AttrType::None}, BS{100, 100, 100, 100, 100, 100});
+    const SkillRegistry registry = makeRegistry();
+
+    BattleSession full(makeRoster(sp, registry, 6), makeRoster(sp, registry, 6), registry);
+    // Opponent roster empty: every opponent active-pet lookup hits the null slot.
+    BattleSession lonely(makeRoster(sp, registry, 6), makeRoster(sp, registry, 0), registry);
+
+    constexpr int kIterations = 50000;
+    printResult(runBench("stateForPlayer (6v6)", kIterations, [&] { return full.stateForPlayer(0).size(); }));
+    printResult(runBench("spectatorState (6v6)", kIterations, [&] { return full.spectatorState().size(); }));
+    printResult(runBench("pendingForPlayer x2 (6v6)", kIterations * 20, [&] {
+        return static_cast<std::size_t>(full.pendingForPlayer(0)) + static_cast<std::size_t>(full.pendingForPlayer(1)) + 1;
+    }));
+    printResult(runBench("tick (6v6, waiting for actions)", kIterations * 20, [&] {
+        full.tick();
+        return std::size_t{1};
+    }));
+    printResult(runBench("stateForPlayer (empty opponent)", kIterations, [&] { return lonely.stateForPlayer(0).size(); }));
+    printResult(runBench("pendingForPlayer (empty roster)", kIterations * 20, [&] {
+        return static_cast<std::size_t>(lonely.pendingForPlayer(1)) + 1;
+    }));
+
+    // A /state poll: dump per request, or copy the bytes cached for the current state version
+    // (server.cpp keeps one body per room and viewer role).
+    printResult(runBench("/state body, dumped per request", kIterations, [&] {
+        return full.stateForPlayer(0).dump().size();
+    }));
+    std::uint64_t cachedVersion = 0;
+    std::string cachedBody;
+    printResult(runBench("/state body, cached per state version", kIterations * 20, [&] {
+        if (cachedVersion != full.stateVersion()) {
+            cachedVersion = full.stateVersion();
+            cachedBody = full.stateForPlayer(0).dump();
+        }
+        std::string body = cachedBody;
+        return body.size();
+    }));
+
+    // The lookup pattern /state used before activePetOrNull(): throw + catch on an empty slot.
+    const Player& full1 = full.player1();
+    const Player& emptyPlayer = lonely.player2();
+    auto tryCatchLookup = [](const Player& player) -> std::size_t {
+        try {
+            return player.activePet().isFainted() ? 1 : 2;
+        } catch (...) {
+            return 3;
+        }
+    };
+    auto nullLookup = [](const Player& player) -> std::size_t {
+        const Pet* pet = player.activePetOrNull();
+        return pet ? (pet->isFainted() ? 1 : 2) : 3;
+    };
+    printResult(runBench("try/catch activePet() (occupied)", kIterations * 20, [&] { return tryCatchLookup(full1); }));
+    printResult(runBench("activePetOrNull() (occupied)", kIterations * 20, [&] { return nullLookup(full1); }));
+    printResult(runBench("try/catch activePet() (empty slot)", kIterations, [&] { return tryCatchLookup(emptyPlayer); }));
+    printResult(runBench("activePetOrNull() (empty slot)", kIterations, [&] { return nullLookup(emptyPlayer); }));
+
+    std::printf("\n=== Benchmark complete ===\n");
+    return 0;
+}
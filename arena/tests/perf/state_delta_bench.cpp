@@ -0,0 +1,142 @@
+// tests/perf/state_delta_bench.cpp
+// Performance benchmark: full /state bodies vs /state/delta patches
+//
+// Goal: Show how much smaller a delta is than the full payload a poller would otherwise
+//       download every turn, what computing it costs the server, and check that applying
+//       each delta to the previous state reproduces the next one exactly
+// Input: 6v6 sessions with 4 skills per pet played to the end (both sides use skills, force
+//        switches pick the first healthy pet); player 1 and spectator payloads per turn
+// Metrics: bytes per turn (full vs delta), ns per full dump vs ns per diff + dump, ns per
+//          apply on the client side, and whether every reconstruction matched
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <battle_session.h>
+#include <core/logger/logger.h>
+#include <skill/SkillRegistry.h>
+#include <state_delta.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+using fixtures::kSkillCount;
+using fixtures::makeRegistry;
+using fixtures::makeRoster;
+
+constexpr int kMaxTurns = 300;
+constexpr int kRepeats = 20;
+
+ActionData chooseAction(const BattleSession& session, int index, int turn) {
+    ActionData action;
+    if (session.pendingForPlayer(index) == PendingType::ForceSwitch) {
+        const auto& roster = index == 0 ? session.roster1() : session.roster2();
+        action.type = ActionType::Switch;
+        for (std::size_t i = 0; i < roster.size(); ++i) {
+            if (roster[i] && !roster[i]->isFainted()) {
+                action.switchIndex = i;
+                break;
+            }
+        }
+        return action;
+    }
+    action.type = ActionType::Skill;
+    action.skillId = 1 + (turn + index) % kSkillCount;
+    return action;
+}
+
+// Payloads a viewer would see after every turn of one battle, starting with the first.
+std::vector<nlohmann::json> playBattle(Species& sp, const SkillRegistry& registry, bool spectator) {
+    BattleSession session(makeRoster(sp, registry, 6), makeRoster(sp, registry, 6), registry);
+    std::vector<nlohmann::json> states;
+    states.push_back(spectator ? session.spectatorState() : session.stateForPlayer(0));
+    for (int turn = 0; turn < kMaxTurns && session.pendingForPlayer(0) != PendingType::BattleOver; ++turn) {
+        for (int index = 0; index < 2; ++index) {
+            const PendingType pending = session.pendingForPlayer(index);
+            if (pending == PendingType::ChooseAction || pending == PendingType::ForceSwitch) {
+                session.submitAction(index, chooseAction(session, index, turn));
+            }
+        }
+        session.tick();
+        states.push_back(spectator ? session.spectatorState() : session.stateForPlayer(0));
+    }
+    return states;
+}
+
+double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool run(const char* name, const std::vector<nlohmann::json>& states) {
+    const std::size_t steps = states.size() - 1;
+    std::size_t fullBytes = 0;
+    std::size_t deltaBytes = 0;
+    std::vector<std::string> patches;
+    patches.reserve(steps);
+    for (std::size_t i = 1; i < states.size(); ++i) {
+        fullBytes += states[i].dump().size();
+        patches.push_back(diffState(states[i - 1], states[i]).dump());
+        deltaBytes += patches.back().size();
+    }
+
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeats; ++r) {
+        for (std::size_t i = 1; i < states.size(); ++i) sink += states[i].dump().size();
+    }
+    const double dumpNs = nsSince(start) / static_cast<double>(steps * kRepeats);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeats; ++r) {
+        for (std::size_t i = 1; i < states.size(); ++i) sink += diffState(states[i - 1], states[i]).dump().size();
+    }
+    const double diffNs = nsSince(start) / static_cast<double>(steps * kRepeats);
+
+    // Client side: parse each patch and fold it into the running state.
+    bool matched = true;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeats; ++r) {
+        nlohmann::json current = states.front();
+        for (std::size_t i = 0; i < steps; ++i) {
+            applyStateDelta(current, nlohmann::json::parse(patches[i]));
+            if (r == 0 && current != states[i + 1]) matched = false;
+        }
+        sink += current.size();
+    }
+    const double applyNs = nsSince(start) / static_cast<double>(steps * kRepeats);
+    if (sink == 0) std::printf("  (sink=%zu)\n", sink);
+
+    std::printf("  %-10s  %6zu  %10.0f  %10.0f  %7.1f%%  %10.0f  %10.0f  %10.0f  %8s\n", name, steps,
+                static_cast<double>(fullBytes) / static_cast<double>(steps),
+                static_cast<double>(deltaBytes) / static_cast<double>(steps),
+                100.0 * static_cast<double>(deltaBytes) / static_cast<double>(fullBytes), dumpNs, diffNs, applyNs,
+                matched ? "ok" : "MISMATCH");
+    return matched;
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena /state/delta Benchmark ===\n\n");
+
+    // Suppress logger output for clean benchmark
+    Logger::setLevel(Logger::Level::Warn);
+
+    Species sp(1, "Bench", {AttrType::Normal, AttrType::None}, BS{100, 100, 100, 100, 100, 100});
+    const SkillRegistry registry = makeRegistry();
+
+    std::printf("  %-10s  %6s  %10s  %10s  %8s  %10s  %10s  %10s  %8s\n", "viewer", "turns", "full B", "delta B",
+                "ratio", "dump ns", "diff ns", "apply ns", "check");
+    bool ok = run("player 1", playBattle(sp, registry, false));
+    ok = run("spectator", playBattle(sp, registry, true)) && ok;
+
+    std::printf("\n=== Benchmark complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
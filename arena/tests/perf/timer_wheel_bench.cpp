@@ -0,0 +1,181 @@
+// tests/perf/timer_wheel_bench.cpp
+// Performance benchmark: room deadlines on a fixed 100 ms poll vs the hierarchical TimerWheel
+//
+// Goal: Show that the timer cost follows the number of due deadlines instead of the number of
+//       rooms, and check that wheel timers fire in order and never early
+// Input: N rooms (1k / 10k / 100k), each with a deadline 10 ms .. 60 s away; one minute of
+//        simulated time; a handful of real timers on TimerService for wake-up precision
+// Metrics: rooms visited and ns per simulated second for the poll loop and for the wheel,
+//          ns per re-arm (cancel + schedule), TimerService lateness (mean / max)
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <timer_wheel.h>
+
+namespace {
+
+using Clock = TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+constexpr milliseconds kPollInterval{100};
+constexpr milliseconds kResolution{10};
+constexpr milliseconds kSimulated{60000};
+
+double nsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct RunResult {
+    double pollNsPerSecond = 0;
+    long pollVisits = 0;
+    double wheelNsPerSecond = 0;
+    long wheelFired = 0;
+    double rearmNs = 0;
+    bool ordered = true;
+    bool early = false;
+};
+
+RunResult run(int rooms) {
+    RunResult result;
+    const Clock::time_point base{};
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> pickDelay(10, static_cast<int>(kSimulated.count()));
+    std::vector<Clock::time_point> deadlines;
+    deadlines.reserve(static_cast<std::size_t>(rooms));
+    for (int i = 0; i < rooms; ++i) {
+        deadlines.push_back(base + milliseconds(pickDelay(rng)));
+    }
+
+    // Old timer thread: every poll visits every room and compares its deadline.
+    {
+        std::vector<bool> done(deadlines.size(), false);
+        long expired = 0;
+        const auto start = Clock::now();
+        for (auto now = base; now <= base + kSimulated; now += kPollInterval) {
+            for (std::size_t i = 0; i < deadlines.size(); ++i) {
+                ++result.pollVisits;
+                if (!done[i] && now >= deadlines[i]) {
+                    done[i] = true;
+                    ++expired;
+                }
+            }
+        }
+        result.pollNsPerSecond = nsSince(start) / (kSimulated.count() / 1000.0);
+        if (expired != rooms) result.ordered = false;
+    }
+
+    // Wheel: only due timers are touched.
+    {
+        TimerWheel wheel(kResolution, base);
+        Clock::time_point now = base;
+        Clock::time_point lastDeadline = base;
+        for (int i = 0; i < rooms; ++i) {
+            const Clock::time_point deadline = deadlines[static_cast<std::size_t>(i)];
+            wheel.schedule(deadline, [&, deadline] {
+                if (now < deadline) result.early = true;
+                // Deadlines within one tick may fire in any order.
+                if (deadline + kResolution <= lastDeadline) result.ordered = false;
+                lastDeadline = std::max(lastDeadline, deadline);
+                ++result.wheelFired;
+            });
+        }
+        std::vector<TimerWheel::Callback> due;
+        const auto start = Clock::now();
+        while (auto next = wheel.nextExpiry()) {
+            now = *next;
+            wheel.advance(now, due);
+            for (auto& callback : due) callback();
+            due.clear();
+        }
+        result.wheelNsPerSecond = nsSince(start) / (kSimulated.count() / 1000.0);
+    }
+
+    // Re-arming, as a room does whenever its earliest deadline moves.
+    {
+        TimerWheel wheel(kResolution, base);
+        std::vector<TimerWheel::TimerId> ids;
+        ids.reserve(deadlines.size());
+        for (const auto& deadline : deadlines) ids.push_back(wheel.schedule(deadline, [] {}));
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            wheel.cancel(ids[i]);
+            ids[i] = wheel.schedule(deadlines[i] + milliseconds(500), [] {});
+        }
+        result.rearmNs = nsSince(start) / static_cast<double>(ids.size());
+    }
+    return result;
+}
+
+bool measureServiceLateness() {
+    constexpr int kTimers = 20;
+    TimerService service(kResolution);
+    service.start();
+    std::mutex mutex;
+    std::vector<double> lateMs;
+    std::atomic<int> fired{0};
+    const auto start = Clock::now();
+    for (int i = 1; i <= kTimers; ++i) {
+        const auto when = start + milliseconds(i * 7);
+        service.schedule(when, [&, when] {
+            std::lock_guard<std::mutex> lock(mutex);
+            lateMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - when).count());
+            ++fired;
+        });
+    }
+    // One cancelled timer must not run.
+    const auto cancelled = service.schedule(start + milliseconds(50), [&] { fired += 1000; });
+    service.cancel(cancelled);
+    while (fired.load() < kTimers && Clock::now() - start < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(milliseconds(5));
+    }
+    std::this_thread::sleep_for(milliseconds(kTimers * 7));
+    service.stop();
+
+    double sum = 0;
+    double worst = 0;
+    bool early = false;
+    for (double late : lateMs) {
+        sum += late;
+        worst = std::max(worst, late);
+        if (late < 0) early = true;
+    }
+    std::printf("  TimerService: %d/%d fired, lateness mean %.2f ms, max %.2f ms%s\n", fired.load(), kTimers,
+                lateMs.empty() ? 0.0 : sum / static_cast<double>(lateMs.size()), worst,
+                early ? "  (EARLY FIRE!)" : "");
+    return fired.load() == kTimers && !early;
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena Timer Wheel Benchmark ===\n");
+    std::printf("Simulated time: %lld ms, poll interval: %lld ms, wheel resolution: %lld ms\n\n",
+                static_cast<long long>(kSimulated.count()), static_cast<long long>(kPollInterval.count()),
+                static_cast<long long>(kResolution.count()));
+
+    bool ok = true;
+    std::printf("  %-8s  %14s  %16s  %16s  %12s  %10s\n", "rooms", "poll visits", "poll ns/sim-s", "wheel ns/sim-s",
+                "rearm ns", "check");
+    for (int rooms : {1000, 10000, 100000}) {
+        const RunResult r = run(rooms);
+        const bool good = r.ordered && !r.early && r.wheelFired == rooms;
+        ok = ok && good;
+        std::printf("  %-8d  %14ld  %16.0f  %16.0f  %12.1f  %10s\n", rooms, r.pollVisits, r.pollNsPerSecond,
+                    r.wheelNsPerSecond, r.rearmNs, good ? "ok" : "FAILED");
+    }
+    std::printf("\n");
+    ok = measureServiceLateness() && ok;
+
+    std::printf("\n=== Benchmark complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+// tests/perf/wire_format_bench.cpp
+// Performance benchmark: JSON vs the application/x-rocoarena binary encoding
+//
+// Goal: Compare size and encode/decode cost of the two wire formats for the messages the
+//       server exchanges most, and check that the binary format round-trips exactly and
+//       rejects damaged frames instead of misreading them
+// Input: stateForPlayer / spectatorState of a 6v6 session with 4 skills per pet (plus the
+//        room summary fields /state adds), a room summary, an action body
+// Metrics: bytes per message, ns per encode (dump vs encodeBinary) and per decode
+//          (parse vs decodeBinary), round-trip check, every truncation and one-byte
+//          corruption of a /state frame decoded without crashing
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <battle_session.h>
+#include <core/logger/logger.h>
+#include <skill/SkillRegistry.h>
+#include <wire_format.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+using fixtures::makeRegistry;
+using fixtures::makeRoster;
+
+constexpr int kIterations = 20000;
+
+// What server.cpp's roomSummary() produces for a full room.
+nlohmann::json makeRoomSummary() {
+    nlohmann::json room;
+    room["name"] = "room-42";
+    room["spectators"] = 2;
+    room["spectatorNames"] = {"alice", "bob"};
+    room["battleStarted"] = true;
+    room["battleOver"] = false;
+    room["winner"] = 0;
+    room["reason"] = "";
+    room["players"] = nlohmann::json::array();
+    for (int i = 1; i <= 2; ++i) {
+        room["players"].push_back({{"id", i}, {"present", true}, {"name", "player" + std::to_string(i)}, {"ready", true}});
+    }
+    return room;
+}
+
+double nsPerCall(std::chrono::steady_clock::time_point start, int calls) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+bool run(const char* name, const nlohmann::json& message) {
+    const std::string text = message.dump();
+    const std::string frame = encodeBinary(message);
+
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) sink += message.dump().size();
+    const double dumpNs = nsPerCall(start, kIterations);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) sink += encodeBinary(message).size();
+    const double encodeNs = nsPerCall(start, kIterations);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) sink += nlohmann::json::parse(text).size();
+    const double parseNs = nsPerCall(start, kIterations);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        nlohmann::json decoded;
+        if (decodeBinary(frame, decoded)) sink += decoded.size();
+    }
+    const double decodeNs = nsPerCall(start, kIterations);
+    if (sink == 0) std::printf("  (sink=%zu)\n", sink);
+
+    nlohmann::json decoded;
+    std::string error;
+    const bool roundTrip = decodeBinary(frame, decoded, &error) && decoded == message && decoded.dump() == text;
+    std::printf("  %-20s  %7zu  %7zu  %9.0f  %9.0f  %9.0f  %9.0f  %8s%s\n", name, text.size(), frame.size(), dumpNs,
+                encodeNs, parseNs, decodeNs, roundTrip ? "ok" : "MISMATCH", error.c_str());
+    return roundTrip;
+}
+
+// Every strict prefix must be rejected; a flipped byte may decode to something else but must
+// never crash or read past the frame.
+bool checkDamagedFrames(const nlohmann::json& message) {
+    const std::string frame = encodeBinary(message);
+    std::size_t accepted = 0;
+    for (std::size_t length = 0; length < frame.size(); ++length) {
+        nlohmann::json value;
+        if (decodeBinary(frame.substr(0, length), value)) ++accepted;
+    }
+    std::size_t corruptedDecoded = 0;
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            std::string damaged = frame;
+            damaged[i] = static_cast<char>(damaged[i] ^ (1 << bit));
+            nlohmann::json value;
+            if (decodeBinary(damaged, value)) ++corruptedDecoded;
+        }
+    }
+    std::printf("  truncated frames accepted: %zu of %zu; bit flips that still decode: %zu of %zu\n", accepted,
+                frame.size(), corruptedDecoded, frame.size() * 8);
+    return accepted == 0;
+}
+
+} // namespace
+
+int main() {
+    std::printf("=== RocoArena Wire Format Benchmark (JSON vs %s v%u) ===\n\n", kBinaryMediaType, kWireFormatVersion);
+
+    // Suppress logger output for clean benchmark
+    Logger::setLevel(Logger::Level::Warn);
+
+    Species sp(1, "Bench", {AttrType::Normal, AttrType::None}, BS{100, 100, 100, 100, 100, 100});
+    const SkillRegistry registry = makeRegistry();
+    BattleSession session(makeRoster(sp, registry, 6), makeRoster(sp, registry, 6), registry);
+
+    nlohmann::json playerState = session.stateForPlayer(0);
+    playerState["room"] = makeRoomSummary();
+    playerState["version"] = 1234;
+    nlohmann::json spectatorState = session.spectatorState();
+    spectatorState["room"] = makeRoomSummary();
+    spectatorState["version"] = 1234;
+    const nlohmann::json action = {{"room", "room-42"}, {"playerId", 1}, {"type", "skill"}, {"skillId", 3}};
+
+    std::printf("  %-20s  %7s  %7s  %9s  %9s  %9s  %9s  %8s\n", "message", "json B", "bin B", "dump ns", "encode ns",
+                "parse ns", "decode ns", "check");
+    bool ok = run("/state (player)", playerState);
+    ok = run("/state (spectator)", spectatorState) && ok;
+    ok = run("/room", makeRoomSummary()) && ok;
+    ok = run("POST /action", action) && ok;
+    ok = run("mixed values", {{"negative", -5}, {"big", 1ull << 40}, {"ratio", 0.25}, {"none", nullptr},
+                              {"nested", {{"list", {1, "two", false}}}}}) && ok;
+    std::printf("\n");
+    ok = checkDamagedFrames(playerState) && ok;
+
+    std::printf("\n=== Benchmark complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
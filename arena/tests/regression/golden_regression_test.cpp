@@ -1,9 +1,12 @@
 // tests/regression/golden_regression_test.cpp
 // Strategy tests #26-30: Golden/snapshot regression tests with fixed RNG seeds
 
+#include <cmath>
+
 #include <gtest/gtest.h>
 #include <battle/BattleSystem.h>
 #include <battle/Action.h>
+#include <battle/DamageCalc.h>
 #include <entity/Pet.h>
 #include <entity/Player.h>
 #include <core/rng/rng.h>
@@ -61,6 +64,33 @@ BattleSnapshot takeSnapshot(const BattleSystem& battle, const Pet& p1, const Pet
              battle.isBattleOver(), p1.isFainted(), p2.isFainted() };
 }
 
+// The float pipeline is only "exact" when no intermediate lands next to an integer
+// boundary; there double rounding may truncate k - epsilon down to k - 1.
+bool nearInteger(double x) {
+    return std::fabs(x - std::round(x)) < 1e-9;
+}
+
+bool floatPipelineExact(const PowerDamageInput& in, int randFactor) {
+    const double base = ((in.level * 0.4 + 2.0) * in.power * in.attack / in.defense) / 50.0 + 2.0;
+    const double attr = AttrChart::getAttrAdvantage(in.skillAttr, in.defenderAttrs);
+    const double scaled = static_cast<int>(base) * attr * randFactor / 255.0;
+    return !nearInteger(base) && !nearInteger(scaled);
+}
+
+PowerDamageInput randomDamageInput(RNG& rng) {
+    PowerDamageInput in;
+    in.level = rng.range<int>(1, 100);
+    in.power = rng.range<int>(1, 250);
+    in.attack = rng.range<int>(1, 3000);
+    in.defense = rng.range<int>(1, 3000);
+    in.skillAttr = static_cast<AttrType>(rng.range<int>(0, static_cast<int>(AttrType::COUNT) - 1));
+    in.defenderAttrs[0] = static_cast<AttrType>(rng.range<int>(0, static_cast<int>(AttrType::COUNT) - 1));
+    in.defenderAttrs[1] = rng.chance(0.5)
+                              ? AttrType::None
+                              : static_cast<AttrType>(rng.range<int>(0, static_cast<int>(AttrType::COUNT) - 1));
+    return in;
+}
+
 } // namespace
 
 // =============================================================================
@@ -250,3 +280,53 @@ TEST(GoldenRegression, SpeedTieResolutionSequence) {
     EXPECT_EQ(results[0], results[1]);
     EXPECT_EQ(results[1], results[2]);
 }
+
+// =============================================================================
+// #31: GoldenRegression_FixedPoint_Damage_Matches_Float
+// Integer damage pipeline is bit-identical to the float one wherever the float
+// result is exact, across the golden seeds
+// =============================================================================
+
+TEST(GoldenRegression, FixedPointDamageMatchesFloat) {
+    for (std::uint64_t seed : { 42u, 123u, 777u, 456u }) {
+        RNG rng(seed);
+        int compared = 0;
+        for (int i = 0; i < 50000; ++i) {
+            PowerDamageInput in = randomDamageInput(rng);
+            const int randFactor = rng.range<int>(DamageCalc::kRandMin, DamageCalc::kRandMax);
+            if (!floatPipelineExact(in, randFactor)) continue;
+            ++compared;
+            ASSERT_EQ(DamageCalc::finalDamageFloat(in, randFactor), DamageCalc::finalDamageFixed(in, randFactor))
+                << "seed=" << seed << " level=" << in.level << " power=" << in.power << " atk=" << in.attack
+                << " def=" << in.defense << " rand=" << randFactor;
+        }
+        EXPECT_GT(compared, 45000);
+    }
+}
+
+// =============================================================================
+// #32: GoldenRegression_FixedPoint_Stage_And_Multiplier
+// Staged stats and dyadic damage multipliers agree between both pipelines
+// =============================================================================
+
+TEST(GoldenRegression, FixedPointStageAndMultiplier) {
+    for (int base = 0; base <= 2000; ++base) {
+        for (int stage = -6; stage <= 6; ++stage) {
+            Buff buff;
+            buff.changeStage(Stat::Atk, stage);
+            const double factor = static_cast<double>(std::abs(stage)) / 2.0 + 1.0;
+            const int expected = (stage == 0 || base <= 0)
+                                     ? base
+                                     : static_cast<int>(stage > 0 ? base * factor : base / factor);
+            ASSERT_EQ(DamageCalc::applyStageFixed(base, stage), expected) << "base=" << base << " stage=" << stage;
+            ASSERT_EQ(buff.applyStageToStat(Stat::Atk, base), expected);
+        }
+    }
+
+    for (double m : { 0.0, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0 }) {
+        const auto q16 = static_cast<std::int32_t>(m * DamageCalc::kQ16One);
+        for (int amount = 0; amount <= 5000; ++amount) {
+            ASSERT_EQ(DamageCalc::applyMultiplier(amount, m), DamageCalc::applyMultiplier(amount, q16));
+        }
+    }
+}
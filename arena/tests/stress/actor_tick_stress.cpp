@@ -0,0 +1,203 @@
+// tests/stress/actor_tick_stress.cpp
+// Stress test: room ticks and actions on one timer thread vs an ActorPool of room workers
+//
+// Goal: Show that handing each room to the worker its id maps to lets session ticks, turn
+//       resolution and actions for different rooms use every core, while the work for any one
+//       room still never overlaps and runs in the order it was posted
+// Input: R rooms (default 512) each holding a 6v6 BattleSession, serviced for N rounds (default
+//        40): both players act, the session ticks and the player-1 /state body is built, as
+//        serviceRoom + submitRoomAction do. Once on a single thread (what the timer thread did),
+//        then posted to an ActorPool of W workers (default hardware concurrency) by one timer
+//        thread and H "handler" threads (default 4) posting at the same time
+// Assertions:
+//   - Every posted task runs exactly once
+//   - No two tasks for the same room ever run at the same time
+//   - Tasks from one poster to one room run in the order posted
+// Metrics: room services/sec for both; speedup
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <actor_pool.h>
+#include <battle_session.h>
+#include <core/logger/logger.h>
+#include <data_loader.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+constexpr int kTemplates = 120;
+constexpr int kSkills = 24;
+constexpr int kLearnable = 4;
+constexpr int kPosters = 16; // timer thread + handler threads, at most
+
+struct StressRoom {
+    std::uint64_t id = 0;
+    std::mutex mutex; // what LockedRoom takes; uncontended when only the room's worker mutates it
+    std::unique_ptr<BattleSession> session;
+    RosterSampler sampler;
+    std::mt19937 rng;
+    std::atomic<bool> busy{ false };
+    std::array<long, kPosters> lastSeq{};
+    long services = 0;
+    std::size_t published = 0;
+};
+
+struct Totals {
+    std::atomic<long> ran{ 0 };
+    std::atomic<long> overlaps{ 0 };
+    std::atomic<long> outOfOrder{ 0 };
+};
+
+ActionData chooseAction(BattleSession& session, int index) {
+    const auto& roster = index == 0 ? session.roster1() : session.roster2();
+    if (session.pendingForPlayer(index) == PendingType::ForceSwitch) {
+        for (std::size_t i = 0; i < roster.size(); ++i) {
+            if (roster[i] && !roster[i]->isFainted()) return ActionData{ ActionType::Switch, 0, i };
+        }
+        return ActionData{};
+    }
+    const Player& player = index == 0 ? session.player1() : session.player2();
+    const Pet* pet = player.activePetOrNull();
+    const SkillBase* skill = pet ? pet->battleState().skillAt(0) : nullptr;
+    return skill ? ActionData{ ActionType::Skill, skill->id(), 0 } : ActionData{};
+}
+
+void startBattle(StressRoom& room, const DataStore& store) {
+    BattleSession::PrototypeRoster roster1{};
+    BattleSession::PrototypeRoster roster2{};
+    room.sampler.sample(store, room.rng, roster1);
+    room.sampler.sample(store, room.rng, roster2);
+    if (room.session) {
+        room.session->reset(roster1, roster2, store.skills);
+    } else {
+        room.session = std::make_unique<BattleSession>(roster1, roster2, store.skills);
+    }
+    room.session->tick();
+}
+
+// One action per player + tick + the /state body a publish would build.
+void serviceRoom(StressRoom& room, const DataStore& store) {
+    std::lock_guard<std::mutex> lock(room.mutex);
+    if (room.session->outcome().ended) startBattle(room, store);
+    for (int index = 0; index < 2; ++index) {
+        const PendingType pending = room.session->pendingForPlayer(index);
+        if (pending == PendingType::ChooseAction || pending == PendingType::ForceSwitch) {
+            room.session->submitAction(index, chooseAction(*room.session, index));
+        }
+    }
+    room.session->tick();
+    room.published += room.session->stateForPlayer(0).dump().size();
+    ++room.services;
+}
+
+std::vector<std::unique_ptr<StressRoom>> makeRooms(const DataStore& store, int roomCount) {
+    std::vector<std::unique_ptr<StressRoom>> rooms;
+    for (int i = 0; i < roomCount; ++i) {
+        auto room = std::make_unique<StressRoom>();
+        room->id = 0x5000000000ull + static_cast<std::uint64_t>(i);
+        room->rng.seed(static_cast<unsigned>(i));
+        startBattle(*room, store);
+        rooms.push_back(std::move(room));
+    }
+    return rooms;
+}
+
+double runSerial(const DataStore& store, int roomCount, int rounds) {
+    auto rooms = makeRooms(store, roomCount);
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (auto& room : rooms) serviceRoom(*room, store);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double rate = static_cast<double>(roomCount) * rounds / seconds;
+    std::printf("  %-34s %8d rooms x %3d rounds  %10.0f services/sec\n", "timer thread, serial (before)", roomCount,
+                rounds, rate);
+    return rate;
+}
+
+bool runActors(const DataStore& store, int roomCount, int rounds, std::size_t workers, int handlerThreads,
+               double& rate) {
+    auto rooms = makeRooms(store, roomCount);
+    ActorPool actors(workers);
+    actors.start();
+    Totals totals;
+    const int posters = 1 + handlerThreads;
+
+    const auto start = std::chrono::steady_clock::now();
+    // Poster 0 plays the timer thread (every room, every round); the others play /action handlers
+    // (random rooms, as many posts between them).
+    std::vector<std::thread> threads;
+    std::atomic<long> posted{ 0 };
+    for (int poster = 0; poster < posters; ++poster) {
+        threads.emplace_back([&, poster]() {
+            std::mt19937 rng(1000 + poster);
+            std::vector<long> seq(rooms.size(), 0);
+            const long posts = poster == 0 ? static_cast<long>(roomCount) * rounds
+                                           : static_cast<long>(roomCount) * rounds / handlerThreads;
+            for (long i = 0; i < posts; ++i) {
+                const std::size_t pick =
+                    poster == 0 ? static_cast<std::size_t>(i) % rooms.size() : rng() % rooms.size();
+                StressRoom* room = rooms[pick].get();
+                const long mySeq = ++seq[pick];
+                ++posted;
+                actors.post(room->id, [&, room, poster, mySeq]() {
+                    if (room->busy.exchange(true)) ++totals.overlaps;
+                    if (room->lastSeq[static_cast<std::size_t>(poster)] + 1 != mySeq) ++totals.outOfOrder;
+                    room->lastSeq[static_cast<std::size_t>(poster)] = mySeq;
+                    serviceRoom(*room, store);
+                    room->busy.store(false);
+                    ++totals.ran;
+                });
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    while (totals.ran.load() < posted.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    actors.stop();
+
+    long services = 0;
+    for (auto& room : rooms) services += room->services;
+    rate = static_cast<double>(services) / seconds;
+    const bool ok = totals.ran == posted && services == posted && totals.overlaps == 0 && totals.outOfOrder == 0;
+    std::printf("  %-34s %8d rooms  %2zu workers  %10.0f services/sec  %s\n", "ActorPool (after)", roomCount,
+                actors.size(), rate, ok ? "ok" : "MISMATCH");
+    std::printf("    posted %ld  ran %ld  overlapping %ld  out of order %ld\n", posted.load(), totals.ran.load(),
+                totals.overlaps.load(), totals.outOfOrder.load());
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int roomCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : 512;
+    const int rounds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 40;
+    const std::size_t workers = argc > 3 ? static_cast<std::size_t>(std::max(0, std::atoi(argv[3]))) : 0;
+    const int handlerThreads = std::clamp(argc > 4 ? std::atoi(argv[4]) : 4, 1, kPosters - 1);
+    Logger::setLevel(Logger::Level::Warn);
+    std::printf("=== RocoArena Actor Tick Stress Test ===\n\n");
+
+    const DataStore store = fixtures::makeStore(kTemplates, kSkills, kLearnable);
+    const double serialRate = runSerial(store, roomCount, rounds);
+    double actorRate = 0;
+    const bool ok = runActors(store, roomCount, rounds, workers, handlerThreads, actorRate);
+    std::printf("  speedup: %.1fx on %u hardware threads\n", actorRate / serialRate,
+                std::thread::hardware_concurrency());
+
+    std::printf("\n=== Stress test complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,279 @@
+// tests/stress/battle_pool_alloc_stress.cpp
+// Stress test: heap allocations per battle with and without pooled BattleSessions
+//
+// Goal: Show that once the session pool is warm, starting, playing and retiring a battle the way
+//       the server does (RosterSampler::sample + BattleSession::reset, ObjectPool take/give)
+//       allocates nothing, where dealing fresh rosters into a new session allocated every time
+// Input: a synthetic DataStore of 120 templates (4 learnable skills each, no scripts); B battles
+//        (default 2000) of 6v6 played to the end with each side using its active pet's first
+//        skill, plus T threads (default 4) retiring and starting battles on one shared pool
+// Assertions:
+//   - A reset session reports exactly what a freshly constructed one does for the same prototypes
+//   - Pooled path, after warm-up: 0 allocations per battle start/retire and 0 per turn
+//   - Every battle ends; the pool never holds more sessions than were ever in flight
+// Metrics: allocations and bytes per battle for both paths; us per battle setup; battles/sec
+//          for the threaded churn
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <battle_session.h>
+#include <core/logger/logger.h>
+#include <core/rng/rng.h>
+#include <data_loader.h>
+#include <object_pool.h>
+
+#include "../test_fixtures.h"
+
+namespace {
+
+std::atomic<long> gAllocations{ 0 };
+std::atomic<long> gBytes{ 0 };
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+constexpr int kTemplates = 120;
+constexpr int kSkills = 24;
+constexpr int kLearnable = 4;
+constexpr int kMaxTurns = 400;
+constexpr int kWarmupBattles = 16;
+
+struct Counts {
+    long allocations = 0;
+    long bytes = 0;
+};
+
+Counts snapshot() {
+    return Counts{ gAllocations.load(std::memory_order_relaxed), gBytes.load(std::memory_order_relaxed) };
+}
+
+Counts since(const Counts& start) {
+    const Counts now = snapshot();
+    return Counts{ now.allocations - start.allocations, now.bytes - start.bytes };
+}
+
+// Each side uses its active pet's first skill, or switches to its first usable pet when it must.
+ActionData chooseAction(BattleSession& session, int index) {
+    const auto& roster = index == 0 ? session.roster1() : session.roster2();
+    if (session.pendingForPlayer(index) == PendingType::ForceSwitch) {
+        for (std::size_t i = 0; i < roster.size(); ++i) {
+            if (roster[i] && !roster[i]->isFainted()) return ActionData{ ActionType::Switch, 0, i };
+        }
+        return ActionData{};
+    }
+    const Player& player = index == 0 ? session.player1() : session.player2();
+    const Pet* pet = player.activePetOrNull();
+    const SkillBase* skill = pet ? pet->battleState().skillAt(0) : nullptr;
+    return skill ? ActionData{ ActionType::Skill, skill->id(), 0 } : ActionData{};
+}
+
+// Plays the battle to the end; returns the number of turns, or -1 if it did not end.
+int playOut(BattleSession& session) {
+    for (int step = 0; step < kMaxTurns * 4; ++step) {
+        if (session.outcome().ended) return session.currentTurn();
+        for (int index = 0; index < 2; ++index) {
+            const PendingType pending = session.pendingForPlayer(index);
+            if (pending == PendingType::ChooseAction || pending == PendingType::ForceSwitch) {
+                session.submitAction(index, chooseAction(session, index));
+            }
+        }
+        session.tick();
+    }
+    return -1;
+}
+
+// What startBattle did before: two fresh rosters and a new session, freed when the room went.
+bool runLegacy(const DataStore& store, int battles, double& allocsPerBattle) {
+    RosterSampler sampler;
+    std::mt19937 rng(7);
+    bool ok = true;
+    const Counts start = snapshot();
+    for (int i = 0; i < battles; ++i) {
+        auto roster1 = sampler.draw(store, rng, Player::kMaxPets);
+        auto roster2 = sampler.draw(store, rng, Player::kMaxPets);
+        auto session = std::make_unique<BattleSession>(std::move(roster1), std::move(roster2), store.skills);
+        session->tick();
+        ok = playOut(*session) >= 0 && ok;
+    }
+    const Counts used = since(start);
+    allocsPerBattle = static_cast<double>(used.allocations) / battles;
+    std::printf("  %-34s %10.1f allocs/battle  %10.0f bytes/battle  %s\n", "new session per battle (before)",
+                allocsPerBattle, static_cast<double>(used.bytes) / battles, ok ? "ok" : "UNFINISHED");
+    return ok;
+}
+
+// What startBattle / retireRoom do now.
+std::unique_ptr<BattleSession> startPooled(ObjectPool<BattleSession>& pool, const DataStore& store,
+                                           RosterSampler& sampler, std::mt19937& rng) {
+    BattleSession::PrototypeRoster roster1{};
+    BattleSession::PrototypeRoster roster2{};
+    sampler.sample(store, rng, roster1);
+    sampler.sample(store, rng, roster2);
+    auto session = pool.take();
+    if (session) {
+        session->reset(roster1, roster2, store.skills);
+    } else {
+        session = std::make_unique<BattleSession>(roster1, roster2, store.skills);
+    }
+    session->tick();
+    return session;
+}
+
+bool runPooled(const DataStore& store, int battles) {
+    ObjectPool<BattleSession> pool;
+    RosterSampler sampler;
+    std::mt19937 rng(7);
+    bool ok = true;
+    for (int i = 0; i < kWarmupBattles; ++i) {
+        auto session = startPooled(pool, store, sampler, rng);
+        ok = playOut(*session) >= 0 && ok;
+        pool.give(std::move(session));
+    }
+
+    Counts setup{};
+    Counts turns{};
+    long turnCount = 0;
+    const auto started = std::chrono::steady_clock::now();
+    double setupUs = 0;
+    for (int i = 0; i < battles; ++i) {
+        const auto setupStart = std::chrono::steady_clock::now();
+        Counts mark = snapshot();
+        auto session = startPooled(pool, store, sampler, rng);
+        Counts used = since(mark);
+        setupUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - setupStart).count();
+        setup.allocations += used.allocations;
+        setup.bytes += used.bytes;
+
+        mark = snapshot();
+        const int played = playOut(*session);
+        used = since(mark);
+        turns.allocations += used.allocations;
+        turns.bytes += used.bytes;
+        ok = played >= 0 && ok;
+        turnCount += std::max(played, 0);
+
+        mark = snapshot();
+        pool.give(std::move(session));
+        used = since(mark);
+        setup.allocations += used.allocations;
+        setup.bytes += used.bytes;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    ok = ok && setup.allocations == 0 && turns.allocations == 0 && pool.idle() == 1;
+    std::printf("  %-34s %10.1f allocs/battle  %10.0f bytes/battle  %s\n", "pooled session (after)",
+                static_cast<double>(setup.allocations + turns.allocations) / battles,
+                static_cast<double>(setup.bytes + turns.bytes) / battles, ok ? "ok" : "ALLOCATES");
+    std::printf("    start+retire: %ld allocs   turns: %ld allocs over %ld turns   %.2f us/setup   %.0f battles/sec\n",
+                setup.allocations, turns.allocations, turnCount, setupUs / battles, battles / seconds);
+    return ok;
+}
+
+// A session reset over a finished battle must look exactly like a new one, before and after play.
+bool checkReset(const DataStore& store) {
+    RosterSampler sampler;
+    std::mt19937 rng(3);
+    bool ok = true;
+    std::unique_ptr<BattleSession> reused;
+    for (int i = 0; i < 50 && ok; ++i) {
+        BattleSession::PrototypeRoster roster1{};
+        BattleSession::PrototypeRoster roster2{};
+        // Short rosters now and then, so reset has to shrink and regrow them.
+        const std::size_t size1 = i % 7 == 3 ? 2 : Player::kMaxPets;
+        sampler.sample(store, rng, roster1);
+        sampler.sample(store, rng, roster2);
+        std::fill(roster1.begin() + static_cast<std::ptrdiff_t>(size1), roster1.end(), nullptr);
+
+        if (reused) {
+            reused->reset(roster1, roster2, store.skills);
+        } else {
+            reused = std::make_unique<BattleSession>(roster1, roster2, store.skills);
+        }
+        BattleSession fresh(roster1, roster2, store.skills);
+        ok = reused->stateForPlayer(0) == fresh.stateForPlayer(0) &&
+             reused->stateForPlayer(1) == fresh.stateForPlayer(1) && reused->spectatorState() == fresh.spectatorState() &&
+             reused->stateVersion() == fresh.stateVersion() && !reused->outcome().ended;
+        fresh.tick();
+        reused->tick();
+        RNG::instance().reseed(1000 + i); // damage rolls come from here; replay them for both
+        const int turnsFresh = playOut(fresh);
+        RNG::instance().reseed(1000 + i);
+        const int turnsReused = playOut(*reused);
+        ok = ok && turnsFresh >= 0 && turnsFresh == turnsReused &&
+             reused->outcome().winner == fresh.outcome().winner && reused->outcome().reason == fresh.outcome().reason;
+    }
+    std::printf("  reset session matches a fresh one: %s\n", ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// Rooms retiring and starting battles from several threads, all on one pool.
+bool runChurn(const DataStore& store, int threadCount, int battlesPerThread) {
+    ObjectPool<BattleSession> pool;
+    std::atomic<int> unfinished{ 0 };
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            RosterSampler sampler;
+            std::mt19937 rng(100 + t);
+            for (int i = 0; i < battlesPerThread; ++i) {
+                auto session = startPooled(pool, store, sampler, rng);
+                if (playOut(*session) < 0) ++unfinished;
+                pool.give(std::move(session));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const bool ok = unfinished == 0 && pool.idle() >= 1 && pool.idle() <= static_cast<std::size_t>(threadCount);
+    std::printf("  churn, %d threads: %d battles  %.0f battles/sec  %zu sessions pooled  %s\n", threadCount,
+                threadCount * battlesPerThread, threadCount * battlesPerThread / seconds, pool.idle(),
+                ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int battles = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2000;
+    const int threadCount = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    Logger::setLevel(Logger::Level::Warn);
+    std::printf("=== RocoArena Battle Session Pool Allocation Stress Test ===\n\n");
+
+    const DataStore store = fixtures::makeStore(kTemplates, kSkills, kLearnable);
+    bool ok = checkReset(store);
+    double legacyAllocs = 0;
+    ok = runLegacy(store, battles, legacyAllocs) && ok;
+    ok = runPooled(store, battles) && ok;
+    ok = runChurn(store, threadCount, battles / threadCount + 1) && ok;
+
+    std::printf("\n=== Stress test complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,515 @@
+// tests/stress/http_admission_stress.cpp
+// Stress test: HttpServer admission control against slow, idle, oversized and excess clients
+//
+// Goal: Show that the server's limits keep it answering healthy clients promptly instead of
+//       letting misbehaving ones pin connections, threads and memory: slowloris connections are
+//       closed at the read deadline, connections over the cap and batches over the task queue
+//       bound are answered 503 straight away, oversized requests 413
+// Input: for both the epoll reactor and the thread-per-connection server:
+//        - S slowloris clients (default 64) that send a partial request head and then one more
+//          header byte every 50 ms, next to a healthy client issuing sequential GET /ping
+//          requests; readTimeout 300 ms
+//        - maxConnections 16: 16 idle connections, then one more, then one more after the idle
+//          ones have been timed out
+//        - maxRequestBytes 64 KB: a POST declaring and sending more than that
+//        reactor only: one worker, maxQueuedRequests 2, a 20 ms handler and C clients (default 32)
+//        each sending one request at the same moment; and, with maxRequestBytes 4 KB, 1000
+//        pipelined GETs (far more than 4 KB together) followed by one request over the limit;
+//        a malformed request arriving while the queue is full; 64 MB sent by the peer of an
+//        event stream, and 64 MB of WebSocket messages sent while the message handler is blocked
+// Assertions:
+//   - Every slowloris connection is closed by the server within 3x the read deadline, even
+//     though it keeps sending
+//   - Every healthy request is answered 200
+//   - The connection over the cap is answered 503 (with Retry-After); once the idle connections
+//     expire a new one is served 200
+//   - The oversized request is answered 413
+//   - Every pipelined GET is answered 200, in well under the read deadline, and the oversized
+//     request behind them 413: the limit is per request, not per buffered bytes
+//   - Every queued client gets a 200 or a 503, at least one of each, none after the deadline
+//   - The malformed request is answered 400, not 503, even when the queue is full
+//   - Neither flood grows the server's resident memory by more than 32 MB, and every WebSocket
+//     message is still delivered once the handler is released
+// Metrics: slowloris close time, healthy request latency (max), 503s shed and shed latency
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <core/logger/logger.h>
+#include <http_server.h>
+#include <websocket.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kReadTimeout = std::chrono::milliseconds(300);
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int connectTo(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    // Nothing in this test should wait longer than this for a byte.
+    timeval timeout{ 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    std::size_t offset = 0;
+    while (offset < data.size()) {
+        const ssize_t n = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        offset += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Reads one response; returns its status (0 if the connection ended or timed out first).
+// `head` receives the status line and headers.
+int readStatus(int fd, std::string* head = nullptr) {
+    std::string in;
+    char chunk[4096];
+    std::size_t headEnd = std::string::npos;
+    while ((headEnd = in.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return 0;
+        in.append(chunk, static_cast<std::size_t>(n));
+    }
+    if (in.compare(0, 9, "HTTP/1.1 ") != 0) return 0;
+    if (head) *head = in.substr(0, headEnd);
+    return std::atoi(in.c_str() + 9);
+}
+
+// One GET on a fresh connection; the status, or 0 on failure.
+int requestOnce(int port, const std::string& target, std::string* head = nullptr) {
+    const int fd = connectTo(port);
+    if (fd < 0) return 0;
+    int status = 0;
+    if (sendAll(fd, "GET " + target + " HTTP/1.1\r\nConnection: close\r\n\r\n")) status = readStatus(fd, head);
+    close(fd);
+    return status;
+}
+
+// True once the server has closed the connection (EOF or reset), false if it is still open.
+bool serverClosed(int fd) {
+    char byte = 0;
+    const ssize_t n = recv(fd, &byte, 1, MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+HttpServerOptions baseOptions(bool threadPerConnection) {
+    HttpServerOptions options;
+    options.threadPerConnection = threadPerConnection;
+    options.workerThreads = 2;
+    options.readTimeout = kReadTimeout;
+    return options;
+}
+
+bool startServer(HttpServer& server, const char* name) {
+    server.setHandler([](const HttpRequest&) { return HttpResponse{ 200, "{\"ok\":true}" }; });
+    std::string error;
+    if (server.start(&error)) return true;
+    std::printf("  %s: server failed to start: %s\n", name, error.c_str());
+    return false;
+}
+
+// Slowloris connections trickle header bytes while a healthy client keeps requesting.
+bool runSlowloris(const char* name, bool threadPerConnection, int slowClients) {
+    HttpServerOptions options = baseOptions(threadPerConnection);
+    options.maxConnections = static_cast<std::size_t>(slowClients) + 16;
+    HttpServer server(0, options);
+    if (!startServer(server, name)) return false;
+
+    std::vector<int> slow;
+    const auto opened = Clock::now();
+    for (int i = 0; i < slowClients; ++i) {
+        const int fd = connectTo(server.port());
+        if (fd >= 0 && sendAll(fd, "GET /ping HTTP/1.1\r\nX-Slow: ")) slow.push_back(fd);
+    }
+
+    std::atomic<bool> healthyDone{ false };
+    long healthyOk = 0;
+    long healthyFailed = 0;
+    double healthyMaxMs = 0;
+    std::thread healthy([&]() {
+        while (!healthyDone) {
+            const auto start = Clock::now();
+            if (requestOnce(server.port(), "/ping") == 200) {
+                ++healthyOk;
+            } else {
+                ++healthyFailed;
+            }
+            healthyMaxMs = std::max(healthyMaxMs, msSince(start));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    // Keep trickling; record when each connection is closed by the server.
+    std::vector<double> closedAtMs(slow.size(), -1);
+    const auto giveUp = opened + kReadTimeout * 3;
+    std::size_t open = slow.size();
+    while (open > 0 && Clock::now() < giveUp) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        for (std::size_t i = 0; i < slow.size(); ++i) {
+            if (closedAtMs[i] >= 0) continue;
+            if (serverClosed(slow[i]) || !sendAll(slow[i], "x")) {
+                closedAtMs[i] = msSince(opened);
+                --open;
+            }
+        }
+    }
+    healthyDone = true;
+    healthy.join();
+    for (int fd : slow) close(fd);
+    server.stop();
+
+    double lastCloseMs = 0;
+    for (double at : closedAtMs) lastCloseMs = std::max(lastCloseMs, at);
+    const bool ok = static_cast<int>(slow.size()) == slowClients && open == 0 && healthyFailed == 0 && healthyOk > 0;
+    std::printf("  %-30s slowloris %3zu/%d closed by %6.0f ms   healthy %4ld ok %ld failed, max %6.1f ms  %s\n", name,
+                slow.size() - open, slowClients, lastCloseMs, healthyOk, healthyFailed, healthyMaxMs,
+                ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Idle connections fill the cap; the next is refused, and admitted again once they expire.
+bool runConnectionCap(const char* name, bool threadPerConnection) {
+    constexpr int kCap = 16;
+    HttpServerOptions options = baseOptions(threadPerConnection);
+    options.maxConnections = kCap;
+    HttpServer server(0, options);
+    if (!startServer(server, name)) return false;
+
+    std::vector<int> idle;
+    for (int i = 0; i < kCap; ++i) {
+        const int fd = connectTo(server.port());
+        if (fd >= 0) idle.push_back(fd);
+    }
+    // Let the server accept them all before the extra one queues behind them.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::string head;
+    const auto refusedStart = Clock::now();
+    const int refused = requestOnce(server.port(), "/ping", &head);
+    const double refusedMs = msSince(refusedStart);
+    const bool retryAfter = head.find("Retry-After: 1") != std::string::npos;
+
+    std::this_thread::sleep_for(kReadTimeout * 2);
+    const int admitted = requestOnce(server.port(), "/ping");
+    for (int fd : idle) close(fd);
+    server.stop();
+
+    const bool ok = static_cast<int>(idle.size()) == kCap && refused == 503 && retryAfter && admitted == 200;
+    std::printf("  %-30s cap %d: extra connection %d in %.1f ms%s, after idle expiry %d  %s\n", name, kCap, refused,
+                refusedMs, retryAfter ? " (Retry-After)" : "", admitted, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+bool runOversized(const char* name, bool threadPerConnection) {
+    constexpr std::size_t kLimit = 64 * 1024;
+    HttpServerOptions options = baseOptions(threadPerConnection);
+    options.maxRequestBytes = kLimit;
+    HttpServer server(0, options);
+    if (!startServer(server, name)) return false;
+
+    int status = 0;
+    const int fd = connectTo(server.port());
+    if (fd >= 0) {
+        const std::string body(kLimit + 1024, 'x');
+        std::string request = "POST /upload HTTP/1.1\r\nContent-Length: " + std::to_string(4 * kLimit) + "\r\n\r\n";
+        request += body;
+        sendAll(fd, request);
+        status = readStatus(fd);
+        close(fd);
+    }
+    const int small = requestOnce(server.port(), "/ping");
+    server.stop();
+
+    const bool ok = status == 413 && small == 200;
+    std::printf("  %-30s %zu KB limit: oversized request %d, next request %d  %s\n", name, kLimit / 1024, status, small,
+                ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Splits everything read until the server closed into response statuses.
+std::vector<int> readStatusesUntilClose(int fd) {
+    std::string in;
+    char chunk[65536];
+    ssize_t n = 0;
+    while ((n = recv(fd, chunk, sizeof(chunk), 0)) > 0) in.append(chunk, static_cast<std::size_t>(n));
+    std::vector<int> statuses;
+    std::size_t offset = 0;
+    std::size_t headEnd = std::string::npos;
+    while ((headEnd = in.find("\r\n\r\n", offset)) != std::string::npos) {
+        if (in.compare(offset, 9, "HTTP/1.1 ") != 0) break;
+        statuses.push_back(std::atoi(in.c_str() + offset + 9));
+        const std::size_t lengthPos = in.find("Content-Length: ", offset);
+        if (lengthPos == std::string::npos || lengthPos > headEnd) break;
+        offset = headEnd + 4 + static_cast<std::size_t>(std::strtoull(in.c_str() + lengthPos + 16, nullptr, 10));
+    }
+    return statuses;
+}
+
+// Many small pipelined requests add up to far more than maxRequestBytes; only the last is too large.
+bool runPipelined() {
+    constexpr std::size_t kLimit = 4096;
+    constexpr int kRequests = 1000;
+    HttpServerOptions options = baseOptions(false);
+    options.maxRequestBytes = kLimit;
+    HttpServer server(0, options);
+    if (!startServer(server, "pipelined")) return false;
+
+    std::vector<int> statuses;
+    const auto start = Clock::now();
+    const int fd = connectTo(server.port());
+    if (fd >= 0) {
+        std::string requests;
+        for (int i = 0; i < kRequests; ++i) requests += "GET /ping HTTP/1.1\r\nX-N: 1\r\n\r\n";
+        requests += "GET /ping HTTP/1.1\r\nX-Pad: " + std::string(kLimit, 'x') + "\r\n\r\n";
+        sendAll(fd, requests);
+        statuses = readStatusesUntilClose(fd);
+        close(fd);
+    }
+    const double elapsedMs = msSince(start);
+    server.stop();
+
+    const long served = std::count(statuses.begin(), statuses.end(), 200);
+    const int last = statuses.empty() ? 0 : statuses.back();
+    const bool ok = static_cast<int>(statuses.size()) == kRequests + 1 && served == kRequests && last == 413 &&
+                    elapsedMs < static_cast<double>(kReadTimeout.count());
+    std::printf("  %-30s %d GETs + 1 over %zu KB: %ld answered 200, last %d, in %.1f ms  %s\n",
+                "epoll reactor, pipelined", kRequests, kLimit / 1024, served, last, elapsedMs, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// More simultaneous requests than one slow worker and a 2-deep queue can hold.
+bool runQueueShedding(int clients) {
+    HttpServerOptions options = baseOptions(false);
+    options.workerThreads = 1;
+    options.maxQueuedRequests = 2;
+    HttpServer server(0, options);
+    server.setHandler([](const HttpRequest&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return HttpResponse{ 200, "{\"ok\":true}" };
+    });
+    std::string error;
+    if (!server.start(&error)) {
+        std::printf("  queue shedding: server failed to start: %s\n", error.c_str());
+        return false;
+    }
+
+    std::vector<int> fds;
+    for (int i = 0; i < clients; ++i) {
+        const int fd = connectTo(server.port());
+        if (fd >= 0) fds.push_back(fd);
+    }
+    const auto start = Clock::now();
+    for (int fd : fds) sendAll(fd, "GET /slow HTTP/1.1\r\n\r\n");
+    std::atomic<long> served{ 0 };
+    std::atomic<long> shed{ 0 };
+    std::atomic<long> failed{ 0 };
+    std::vector<double> shedMs(fds.size(), 0);
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        readers.emplace_back([&, i]() {
+            std::string head;
+            const int status = readStatus(fds[i], &head);
+            if (status == 200) {
+                ++served;
+            } else if (status == 503 && head.find("Retry-After") != std::string::npos) {
+                shedMs[i] = msSince(start);
+                ++shed;
+            } else {
+                ++failed;
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    for (int fd : fds) close(fd);
+    server.stop();
+
+    double shedMaxMs = 0;
+    for (double ms : shedMs) shedMaxMs = std::max(shedMaxMs, ms);
+    const bool ok = static_cast<int>(fds.size()) == clients && failed == 0 && served > 0 && shed > 0;
+    std::printf("  %-30s %d clients: %ld served, %ld shed 503 (slowest shed %.1f ms), %ld failed  %s\n",
+                "epoll reactor, queue bound 2", clients, served.load(), shed.load(), shedMaxMs, failed.load(),
+                ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// A malformed request that finds the queue full is still answered 400, not told to retry.
+bool runShedInvalid() {
+    HttpServerOptions options = baseOptions(false);
+    options.workerThreads = 1;
+    options.maxQueuedRequests = 1;
+    HttpServer server(0, options);
+    server.setHandler([](const HttpRequest&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return HttpResponse{ 200, "{\"ok\":true}" };
+    });
+    std::string error;
+    if (!server.start(&error)) {
+        std::printf("  shed invalid: server failed to start: %s\n", error.c_str());
+        return false;
+    }
+
+    // One request on the worker, one filling the queue, then the malformed one.
+    const int running = connectTo(server.port());
+    sendAll(running, "GET /slow HTTP/1.1\r\n\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const int queued = connectTo(server.port());
+    sendAll(queued, "GET /slow HTTP/1.1\r\n\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int bad = connectTo(server.port());
+    sendAll(bad, "NOT A REQUEST\r\n\r\n");
+    const int badStatus = readStatus(bad);
+    const bool badClosed = readStatus(bad) == 0;
+    const int queuedStatus = readStatus(queued);
+    const int runningStatus = readStatus(running);
+    for (int fd : { running, queued, bad }) close(fd);
+    server.stop();
+
+    const bool ok = badStatus == 400 && badClosed && runningStatus == 200 && queuedStatus == 200;
+    std::printf("  %-30s malformed request %d%s, running %d, queued %d  %s\n", "epoll reactor, queue bound 1",
+                badStatus, badClosed ? " and closed" : "", runningStatus, queuedStatus, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+long residentKb() {
+    long pages = 0;
+    long resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+        std::fclose(f);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Peers that keep sending on an event stream, or faster than their WebSocket handler keeps up.
+bool runStreamFlood() {
+    constexpr std::size_t kFloodBytes = 64 * 1024 * 1024;
+    constexpr std::size_t kMessageBytes = 16 * 1024;
+    constexpr long kMaxGrowthKb = 32 * 1024;
+
+    std::mutex gateMutex;
+    std::condition_variable gateCv;
+    bool released = false;
+    std::atomic<long> delivered{ 0 };
+    std::vector<std::shared_ptr<HttpStream>> streams;
+    HttpServer server(0, baseOptions(false));
+    server.setHandler([&](const HttpRequest& req) {
+        HttpResponse resp{ 200, "", "text/event-stream" };
+        if (req.websocket) {
+            resp.websocket = std::make_shared<WebSocket>([&](WebSocket&, const std::string&) {
+                std::unique_lock<std::mutex> lock(gateMutex);
+                gateCv.wait(lock, [&]() { return released; });
+                ++delivered;
+            });
+            return resp;
+        }
+        resp.stream = std::make_shared<HttpStream>();
+        streams.push_back(resp.stream); // handlers run on the one worker thread
+        return resp;
+    });
+    std::string error;
+    if (!server.start(&error)) {
+        std::printf("  stream flood: server failed to start: %s\n", error.c_str());
+        return false;
+    }
+    const std::string chunk(64 * 1024, 'x');
+
+    // Event stream: everything the peer sends after its request is discarded.
+    long baseline = residentKb();
+    int fd = connectTo(server.port());
+    bool sseOk = fd >= 0 && sendAll(fd, "GET /events HTTP/1.1\r\n\r\n") && readStatus(fd) == 200;
+    for (std::size_t sent = 0; sseOk && sent < kFloodBytes; sent += chunk.size()) sseOk = sendAll(fd, chunk);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const long sseGrowthKb = residentKb() - baseline;
+    if (fd >= 0) close(fd);
+
+    // WebSocket: the handler blocks on the first message while the peer keeps sending.
+    baseline = residentKb();
+    fd = connectTo(server.port());
+    const std::string upgrade = "GET /ws HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    bool wsOk = fd >= 0 && sendAll(fd, upgrade) && readStatus(fd) == 101;
+    const long messages = static_cast<long>(kFloodBytes / kMessageBytes);
+    std::atomic<bool> sendOk{ wsOk };
+    std::thread sender([&]() {
+        const std::string frame = encodeWebSocketFrame(WebSocketOpcode::Binary, std::string(kMessageBytes, 'm'), true);
+        for (long i = 0; sendOk && i < messages; ++i) sendOk = sendAll(fd, frame);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    const long wsGrowthKb = residentKb() - baseline;
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        released = true;
+    }
+    gateCv.notify_all();
+    sender.join();
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    while (delivered < messages && Clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (fd >= 0) close(fd);
+    server.stop();
+
+    sseOk = sseOk && sseGrowthKb < kMaxGrowthKb;
+    wsOk = wsOk && sendOk && delivered == messages && wsGrowthKb < kMaxGrowthKb;
+    std::printf("  %-30s event stream: %zu MB in, RSS +%ld KB  %s\n", "epoll reactor, stream flood",
+                kFloodBytes >> 20, sseGrowthKb, sseOk ? "ok" : "FAIL");
+    std::printf("  %-30s WebSocket: %ld messages sent, RSS +%ld KB, %ld delivered after release  %s\n",
+                "epoll reactor, stream flood", messages, wsGrowthKb, delivered.load(), wsOk ? "ok" : "FAIL");
+    return sseOk && wsOk;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int slowClients = argc > 1 ? std::max(1, std::atoi(argv[1])) : 64;
+    const int queueClients = argc > 2 ? std::max(4, std::atoi(argv[2])) : 32;
+    std::printf("=== RocoArena HTTP Admission Stress Test (read deadline %lld ms) ===\n\n",
+                static_cast<long long>(kReadTimeout.count()));
+
+    Logger::setLevel(Logger::Level::Warn);
+
+    bool ok = true;
+    for (const bool threadPerConnection : { false, true }) {
+        const char* name = threadPerConnection ? "thread-per-connection" : "epoll reactor";
+        ok = runSlowloris(name, threadPerConnection, slowClients) && ok;
+        ok = runConnectionCap(name, threadPerConnection) && ok;
+        ok = runOversized(name, threadPerConnection) && ok;
+    }
+    ok = runQueueShedding(queueClients) && ok;
+    ok = runPipelined() && ok;
+    ok = runShedInvalid() && ok;
+    ok = runStreamFlood() && ok;
+
+    std::printf("\n=== Stress test complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// tests/stress/http_parser_corpus.cpp
+// Stress test: parseHttpRequest over a hand-written corpus and mutated inputs
+//
+// Goal: Pin down what the in-place HTTP parser accepts, rejects and waits for, and show that no
+//       byte sequence makes it crash, loop or hand out a view outside the receive buffer
+// Input: a corpus of valid, invalid and incomplete requests with the expected outcome, then
+//        N rounds (default 200000) of random mutations of the valid ones: truncation, byte
+//        flips, inserted CR/LF/NUL/space/colon, spliced halves and pipelined concatenations
+// Assertions:
+//   - Every corpus entry parses to its expected result, method, path, query, body and flags
+//   - Every strict prefix of a complete request is Incomplete or Invalid, never Complete
+//   - On Complete, length <= buffer size and every view lies inside [0, length)
+//   - A pipelined buffer parses back into the same requests in order
+// Metrics: counts of Complete / Incomplete / Invalid over the mutated inputs
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <http_request.h>
+
+namespace {
+
+struct Case {
+    const char* name;
+    std::string input;
+    HttpParseResult expected;
+    // Checked for Complete only.
+    std::string method = {};
+    std::string path = {};
+    std::string query = {};
+    std::string body = {};
+    bool keepAlive = false;
+    bool websocket = false;
+};
+
+int failures = 0;
+
+void fail(const char* what, const std::string& detail) {
+    ++failures;
+    if (failures <= 20) std::printf("  FAIL %s: %s\n", what, detail.c_str());
+}
+
+const char* resultName(HttpParseResult r) {
+    switch (r) {
+        case HttpParseResult::Complete: return "Complete";
+        case HttpParseResult::Incomplete: return "Incomplete";
+        case HttpParseResult::Invalid: return "Invalid";
+    }
+    return "?";
+}
+
+bool inside(std::string_view view, std::string_view buffer, std::size_t length) {
+    if (view.empty()) return true;
+    return view.data() >= buffer.data() && view.data() + view.size() <= buffer.data() + length;
+}
+
+// The invariants that hold for any input, whatever the result.
+HttpParseResult checkedParse(std::string_view buffer, HttpRequest& req, std::size_t& length) {
+    const HttpParseResult result = parseHttpRequest(buffer, req, length);
+    if (result != HttpParseResult::Complete) {
+        if (length != 0 || !req.method.empty()) fail("non-complete result", "length or method set");
+        return result;
+    }
+    if (length == 0 || length > buffer.size()) fail("length", std::to_string(length));
+    if (req.method.empty() || req.path.empty()) fail("empty method/path on Complete", std::string(buffer));
+    bool ok = inside(req.method, buffer, length) && inside(req.path, buffer, length) &&
+              inside(req.query, buffer, length) && inside(req.body, buffer, length);
+    for (std::size_t i = 0; i < req.headerCount; ++i) {
+        ok = ok && inside(req.headers[i].name, buffer, length) && inside(req.headers[i].value, buffer, length);
+    }
+    if (req.headerCount > HttpRequest::kMaxHeaders) ok = false;
+    if (!ok) fail("view outside request", std::string(buffer.substr(0, 80)));
+    return result;
+}
+
+std::vector<Case> makeCorpus() {
+    std::vector<Case> c;
+    c.push_back({ "simple GET", "GET /rooms HTTP/1.1\r\nHost: x\r\n\r\n", HttpParseResult::Complete, "GET",
+                  "/rooms", "", "", true });
+    c.push_back({ "query", "GET /state?room=a&playerId=1 HTTP/1.1\r\n\r\n", HttpParseResult::Complete, "GET",
+                  "/state", "room=a&playerId=1", "", true });
+    c.push_back({ "empty query", "GET /state? HTTP/1.1\r\n\r\n", HttpParseResult::Complete, "GET", "/state", "", "",
+                  true });
+    c.push_back({ "bare LF", "GET / HTTP/1.1\nHost: x\n\n", HttpParseResult::Complete, "GET", "/", "", "", true });
+    c.push_back({ "POST body", "POST /action HTTP/1.1\r\nContent-Length: 7\r\n\r\n{\"a\":1}",
+                  HttpParseResult::Complete, "POST", "/action", "", "{\"a\":1}", true });
+    c.push_back({ "trailing bytes", "POST /x HTTP/1.1\r\nContent-Length: 2\r\n\r\nabGET", HttpParseResult::Complete,
+                  "POST", "/x", "", "ab", true });
+    c.push_back({ "content-length any case", "POST /x HTTP/1.1\r\ncOnTeNt-LeNgTh:   3  \r\n\r\nabc",
+                  HttpParseResult::Complete, "POST", "/x", "", "abc", true });
+    c.push_back({ "same length twice", "POST /x HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\na",
+                  HttpParseResult::Complete, "POST", "/x", "", "a", true });
+    c.push_back({ "HTTP/1.0", "GET / HTTP/1.0\r\n\r\n", HttpParseResult::Complete, "GET", "/", "", "", false });
+    c.push_back({ "HTTP/1.0 keep-alive", "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n",
+                  HttpParseResult::Complete, "GET", "/", "", "", true });
+    c.push_back({ "close", "GET / HTTP/1.1\r\nConnection: foo, close\r\n\r\n", HttpParseResult::Complete, "GET",
+                  "/", "", "", false });
+    c.push_back({ "websocket",
+                  "GET /ws HTTP/1.1\r\nUpgrade: websocket\r\nConnection: keep-alive, Upgrade\r\n"
+                  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n\r\n",
+                  HttpParseResult::Complete, "GET", "/ws", "", "", true, true });
+    c.push_back({ "websocket without key", "GET /ws HTTP/1.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\r\n",
+                  HttpParseResult::Complete, "GET", "/ws", "", "", true, false });
+    c.push_back({ "empty header value", "GET / HTTP/1.1\r\nX-Empty:\r\n\r\n", HttpParseResult::Complete, "GET", "/",
+                  "", "", true });
+
+    c.push_back({ "empty", "", HttpParseResult::Incomplete });
+    c.push_back({ "partial request line", "GET /rooms HT", HttpParseResult::Incomplete });
+    c.push_back({ "no blank line", "GET / HTTP/1.1\r\nHost: x\r\n", HttpParseResult::Incomplete });
+    c.push_back({ "short body", "POST /x HTTP/1.1\r\nContent-Length: 10\r\n\r\nabc", HttpParseResult::Incomplete });
+
+    c.push_back({ "no version", "GET /\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "HTTP/2", "GET / HTTP/2.0\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "lower-case version", "GET / http/1.1\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "double space", "GET  / HTTP/1.1\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "query without path", "GET ?a=b HTTP/1.1\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "method with slash", "G/T / HTTP/1.1\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "control in target", std::string("GET /a\x01 HTTP/1.1\r\n\r\n"), HttpParseResult::Invalid });
+    c.push_back({ "header without colon", "GET / HTTP/1.1\r\nHost x\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "space before colon", "GET / HTTP/1.1\r\nHost : x\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "folded header", "GET / HTTP/1.1\r\nX-A: 1\r\n  2\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "negative length", "POST /x HTTP/1.1\r\nContent-Length: -1\r\n\r\n", HttpParseResult::Invalid });
+    c.push_back({ "length with sign", "POST /x HTTP/1.1\r\nContent-Length: +1\r\n\r\na", HttpParseResult::Invalid });
+    c.push_back({ "overflowing length", "POST /x HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n",
+                  HttpParseResult::Invalid });
+    c.push_back({ "conflicting lengths", "POST /x HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab",
+                  HttpParseResult::Invalid });
+    c.push_back({ "chunked", "POST /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+                  HttpParseResult::Invalid });
+
+    std::string many = "GET / HTTP/1.1\r\n";
+    for (std::size_t i = 0; i < HttpRequest::kMaxHeaders; ++i) many += "X-" + std::to_string(i) + ": v\r\n";
+    c.push_back({ "kMaxHeaders headers", many + "\r\n", HttpParseResult::Complete, "GET", "/", "", "", true });
+    c.push_back({ "too many headers", many + "X-Last: v\r\n\r\n", HttpParseResult::Invalid });
+    return c;
+}
+
+void runCorpus(const std::vector<Case>& corpus) {
+    HttpRequest req;
+    std::size_t length = 0;
+    for (const Case& c : corpus) {
+        const HttpParseResult result = checkedParse(c.input, req, length);
+        if (result != c.expected) {
+            fail(c.name, std::string("got ") + resultName(result) + ", expected " + resultName(c.expected));
+            continue;
+        }
+        if (result != HttpParseResult::Complete) continue;
+        if (req.method != c.method || req.path != c.path || req.query != c.query || req.body != c.body ||
+            req.keepAlive != c.keepAlive || req.websocket != c.websocket) {
+            fail(c.name, "fields differ");
+        }
+        // No strict prefix of a complete request may itself parse as Complete.
+        for (std::size_t cut = 0; cut < length; ++cut) {
+            HttpRequest partial;
+            std::size_t partialLength = 0;
+            if (checkedParse(std::string_view(c.input).substr(0, cut), partial, partialLength) ==
+                HttpParseResult::Complete) {
+                fail(c.name, "prefix of " + std::to_string(cut) + " bytes is Complete");
+                break;
+            }
+        }
+    }
+    if (HttpRequest{}.header("host").data() != nullptr) fail("header() on empty request", "non-null view");
+    std::printf("  corpus: %zu cases\n", corpus.size());
+}
+
+std::string mutate(const std::string& base, const std::vector<std::string>& valid, std::mt19937& rng) {
+    static const char kSpecial[] = { '\r', '\n', '\0', ' ', ':', '\t', '?', '\x7f', '\xff' };
+    std::string s = base;
+    const int edits = 1 + static_cast<int>(rng() % 3);
+    for (int e = 0; e < edits; ++e) {
+        const std::size_t at = s.empty() ? 0 : rng() % s.size();
+        switch (rng() % 6) {
+            case 0:
+                s.resize(at);
+                break;
+            case 1:
+                if (!s.empty()) s[at] = static_cast<char>(s[at] ^ (1 << (rng() % 8)));
+                break;
+            case 2:
+                s.insert(at, 1, kSpecial[rng() % sizeof(kSpecial)]);
+                break;
+            case 3:
+                if (!s.empty()) s.erase(at, 1 + rng() % 4);
+                break;
+            case 4: {
+                const std::string& other = valid[rng() % valid.size()];
+                s = s.substr(0, at) + other.substr(rng() % (other.size() + 1));
+                break;
+            }
+            default:
+                s += valid[rng() % valid.size()];
+                break;
+        }
+    }
+    return s;
+}
+
+void runMutations(const std::vector<std::string>& valid, int rounds) {
+    std::mt19937 rng(20261018);
+    long counts[3] = { 0, 0, 0 };
+    HttpRequest req;
+    std::size_t length = 0;
+    for (int i = 0; i < rounds; ++i) {
+        const std::string input = mutate(valid[rng() % valid.size()], valid, rng);
+        // Parse everything the buffer holds, the way the reactor drains a connection.
+        std::string_view rest = input;
+        for (int guard = 0; guard <= 64; ++guard) {
+            const HttpParseResult result = checkedParse(rest, req, length);
+            ++counts[static_cast<int>(result)];
+            if (result != HttpParseResult::Complete || length == rest.size()) break;
+            rest.remove_prefix(length);
+        }
+    }
+    std::printf("  mutations: %d inputs -> %ld complete, %ld incomplete, %ld invalid\n", rounds,
+                counts[static_cast<int>(HttpParseResult::Complete)],
+                counts[static_cast<int>(HttpParseResult::Incomplete)],
+                counts[static_cast<int>(HttpParseResult::Invalid)]);
+}
+
+// Concatenations of valid requests come back out one by one, in order and unchanged.
+void runPipelines(const std::vector<Case>& corpus, int rounds) {
+    std::vector<const Case*> complete;
+    for (const Case& c : corpus) {
+        if (c.expected == HttpParseResult::Complete && c.name != std::string("trailing bytes")) {
+            complete.push_back(&c);
+        }
+    }
+    std::mt19937 rng(42);
+    HttpRequest req;
+    std::size_t length = 0;
+    for (int i = 0; i < rounds; ++i) {
+        std::vector<const Case*> batch;
+        std::string buffer;
+        const std::size_t n = 1 + rng() % 8;
+        for (std::size_t k = 0; k < n; ++k) {
+            batch.push_back(complete[rng() % complete.size()]);
+            buffer += batch.back()->input;
+        }
+        std::string_view rest = buffer;
+        for (const Case* c : batch) {
+            if (checkedParse(rest, req, length) != HttpParseResult::Complete || length != c->input.size() ||
+                req.path != c->path || req.body != c->body) {
+                fail("pipeline", c->name);
+                break;
+            }
+            rest.remove_prefix(length);
+        }
+        if (!rest.empty() && failures == 0) fail("pipeline", "bytes left over");
+    }
+    std::printf("  pipelines: %d buffers of 1..8 requests\n", rounds);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+    std::printf("=== RocoArena HTTP Parser Corpus Stress Test ===\n\n");
+
+    const std::vector<Case> corpus = makeCorpus();
+    runCorpus(corpus);
+
+    std::vector<std::string> valid;
+    for (const Case& c : corpus) {
+        if (c.expected == HttpParseResult::Complete) valid.push_back(c.input);
+    }
+    runMutations(valid, rounds);
+    runPipelines(corpus, rounds / 10);
+
+    std::printf("\n=== Stress test complete: %s (%d failures) ===\n", failures == 0 ? "PASSED" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+// tests/stress/matchmaker_load_stress.cpp
+// Stress test: rating-bucketed Matchmaker under a simulated population of synthetic players
+//
+// Goal: Show that batched pairing stays cheap with tens of thousands of players queued, that it
+//       only pairs players within each other's rating window, and that RatingBook turns battle
+//       outcomes into ratings that track the players' real strength
+// Input: P synthetic players (default 40000) with a hidden strength ~ N(1500, 350), all queued
+//        at once and re-queued a few simulated seconds after each battle; battles are won with
+//        the Elo probability of the hidden strengths; 2% of queue entries give up while waiting.
+//        A batch runs every 250 ms of simulated time for 60 s, then 30 s more without re-queues.
+//        Separately, a single batch over a backlog of N players against a full scan for the
+//        closest acceptable partner
+// Assertions:
+//   - No ticket is paired twice, with itself, after leaving, or outside either player's window
+//   - When the queue drains, no two players left waiting could have been paired
+//   - Final ratings correlate with hidden strength (Pearson r > 0.6)
+//   - A backlog batch pairs within 1% as many players as the full scan
+// Metrics: batch time (mean / max), matches, rating gap of matches (mean / p95), waiting time
+//          (p50 / p95 / max), peak queue size; per-player pairing cost vs the full scan
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <matchmaker.h>
+
+namespace {
+
+using Clock = Matchmaker::Clock;
+constexpr auto kBatchInterval = std::chrono::milliseconds(250);
+constexpr auto kLoadPhase = std::chrono::seconds(60);
+constexpr auto kDrainPhase = std::chrono::seconds(30);
+
+double windowAt(const MatchmakerOptions& options, Clock::time_point enqueued, Clock::time_point now) {
+    const double waited = std::chrono::duration<double>(now - enqueued).count();
+    return std::min(options.maxWindow, options.baseWindow + options.widenPerSecond * waited);
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Queued {
+    int player;
+    Clock::time_point enqueued;
+};
+
+// Something due at a simulated time: a player queueing again, or a queue entry giving up.
+struct Event {
+    Clock::time_point when;
+    int player;
+    Matchmaker::Ticket cancel; // 0: queue the player
+    bool operator>(const Event& other) const { return when > other.when; }
+};
+
+bool runPopulation(int playerCount) {
+    const MatchmakerOptions options;
+    Matchmaker matchmaker(options);
+    RatingBook ratings;
+    std::mt19937 rng(2024);
+    std::normal_distribution<double> strengthDist(1500.0, 350.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::vector<double> strength(static_cast<std::size_t>(playerCount));
+    std::vector<std::string> names(strength.size());
+    for (std::size_t i = 0; i < strength.size(); ++i) {
+        strength[i] = strengthDist(rng);
+        names[i] = "p" + std::to_string(i);
+    }
+
+    const Clock::time_point t0{};
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::unordered_map<Matchmaker::Ticket, Queued> queued;
+    std::unordered_set<Matchmaker::Ticket> gone; // paired or left
+    Matchmaker::Ticket nextTicket = 1;
+    for (int p = 0; p < playerCount; ++p) events.push(Event{ t0, p, 0 });
+
+    bool ok = true;
+    std::size_t peak = 0;
+    long matches = 0;
+    long cancels = 0;
+    std::vector<double> gaps;
+    std::vector<double> waits;
+    std::vector<double> batchMs;
+    for (Clock::time_point now = t0; now <= t0 + kLoadPhase + kDrainPhase; now += kBatchInterval) {
+        while (!events.empty() && events.top().when <= now) {
+            const Event event = events.top();
+            events.pop();
+            if (event.cancel != 0) {
+                if (matchmaker.cancel(event.cancel)) {
+                    queued.erase(event.cancel);
+                    gone.insert(event.cancel);
+                    ++cancels;
+                }
+                continue;
+            }
+            const Matchmaker::Ticket ticket = nextTicket++;
+            const auto player = static_cast<std::size_t>(event.player);
+            ok = ok && matchmaker.enqueue(ticket, names[player], ratings.rating(names[player]), event.when);
+            queued[ticket] = Queued{ event.player, event.when };
+            if (unit(rng) < 0.02) {
+                events.push(Event{ event.when + std::chrono::milliseconds(rng() % 5000), event.player, ticket });
+            }
+        }
+        peak = std::max(peak, matchmaker.size());
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<Matchmaker::Match> batch = matchmaker.pairBatch(now);
+        batchMs.push_back(msSince(start));
+
+        for (const Matchmaker::Match& match : batch) {
+            auto first = queued.find(match.first);
+            auto second = queued.find(match.second);
+            if (match.first == match.second || first == queued.end() || second == queued.end()) {
+                std::printf("  FAIL ticket %llu / %llu paired while not queued\n",
+                            static_cast<unsigned long long>(match.first), static_cast<unsigned long long>(match.second));
+                ok = false;
+                continue;
+            }
+            const auto a = static_cast<std::size_t>(first->second.player);
+            const auto b = static_cast<std::size_t>(second->second.player);
+            const double ratingA = ratings.rating(names[a]);
+            const double ratingB = ratings.rating(names[b]);
+            const double gap = std::fabs(ratingA - ratingB);
+            const double limit = std::min(windowAt(options, first->second.enqueued, now),
+                                          windowAt(options, second->second.enqueued, now));
+            if (a == b || gap > limit + 1e-9) {
+                std::printf("  FAIL players %zu / %zu paired with gap %.1f over window %.1f\n", a, b, gap, limit);
+                ok = false;
+            }
+            gaps.push_back(gap);
+            waits.push_back(std::chrono::duration<double>(now - first->second.enqueued).count());
+            waits.push_back(std::chrono::duration<double>(now - second->second.enqueued).count());
+            queued.erase(first);
+            queued.erase(second);
+            ok = ok && gone.insert(match.first).second && gone.insert(match.second).second;
+            ++matches;
+
+            const double expectedA = 1.0 / (1.0 + std::pow(10.0, (strength[b] - strength[a]) / 400.0));
+            ratings.record(names[a], names[b], unit(rng) < expectedA ? 1 : 2);
+            if (now < t0 + kLoadPhase) {
+                const auto back = now + std::chrono::milliseconds(2000 + rng() % 4000);
+                events.push(Event{ back, static_cast<int>(a), 0 });
+                events.push(Event{ back, static_cast<int>(b), 0 });
+            }
+        }
+    }
+
+    // Nobody left waiting may have an acceptable partner at the widest window.
+    std::vector<const Queued*> left;
+    for (const auto& kv : queued) left.push_back(&kv.second);
+    for (std::size_t i = 0; i < left.size() && left.size() <= 64; ++i) {
+        for (std::size_t j = i + 1; j < left.size(); ++j) {
+            const double gap = std::fabs(ratings.rating(names[static_cast<std::size_t>(left[i]->player)]) -
+                                         ratings.rating(names[static_cast<std::size_t>(left[j]->player)]));
+            ok = ok && gap > options.maxWindow;
+        }
+    }
+    ok = ok && left.size() <= 64 && left.size() == matchmaker.size();
+
+    // Pearson correlation of hidden strength and final rating.
+    double meanS = 0, meanR = 0;
+    for (std::size_t i = 0; i < strength.size(); ++i) {
+        meanS += strength[i];
+        meanR += ratings.rating(names[i]);
+    }
+    meanS /= static_cast<double>(strength.size());
+    meanR /= static_cast<double>(strength.size());
+    double cov = 0, varS = 0, varR = 0;
+    for (std::size_t i = 0; i < strength.size(); ++i) {
+        const double ds = strength[i] - meanS;
+        const double dr = ratings.rating(names[i]) - meanR;
+        cov += ds * dr;
+        varS += ds * ds;
+        varR += dr * dr;
+    }
+    const double correlation = cov / std::sqrt(varS * varR);
+    ok = ok && correlation > 0.6;
+
+    double totalMs = 0;
+    for (double ms : batchMs) totalMs += ms;
+    std::printf("  population %d: %zu batches, %.3f ms mean, %.3f ms max; peak queue %zu\n", playerCount,
+                batchMs.size(), totalMs / static_cast<double>(batchMs.size()),
+                *std::max_element(batchMs.begin(), batchMs.end()), peak);
+    std::printf("  %ld matches, %ld left the queue; rating gap mean %.1f p95 %.1f\n", matches, cancels,
+                gaps.empty() ? 0.0 : [&] {
+                    double sum = 0;
+                    for (double g : gaps) sum += g;
+                    return sum / static_cast<double>(gaps.size());
+                }(),
+                percentile(gaps, 0.95));
+    std::printf("  wait p50 %.2f s  p95 %.2f s  max %.2f s; %zu still waiting after the drain\n",
+                percentile(waits, 0.5), percentile(waits, 0.95), percentile(waits, 1.0), left.size());
+    std::printf("  strength/rating correlation r = %.3f: %s\n", correlation, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+// A single batch over `count` players queued over the last 2 s: the Matchmaker against a scan of
+// every other player for the closest acceptable one.
+bool runBacklog(int count) {
+    const MatchmakerOptions options;
+    std::mt19937 rng(7 + count);
+    std::normal_distribution<double> ratingDist(1500.0, 350.0);
+    const Clock::time_point now = Clock::time_point{} + std::chrono::seconds(10);
+    std::vector<double> rating(static_cast<std::size_t>(count));
+    std::vector<Clock::time_point> enqueued(rating.size());
+    for (std::size_t i = 0; i < rating.size(); ++i) {
+        rating[i] = ratingDist(rng);
+        enqueued[i] = now - std::chrono::milliseconds(2000 * (rating.size() - i) / rating.size());
+    }
+
+    Matchmaker matchmaker(options);
+    for (std::size_t i = 0; i < rating.size(); ++i) {
+        matchmaker.enqueue(i + 1, "p" + std::to_string(i), rating[i], enqueued[i]);
+    }
+    auto start = std::chrono::steady_clock::now();
+    const std::size_t bucketed = matchmaker.pairBatch(now).size();
+    const double bucketedMs = msSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<bool> paired(rating.size(), false);
+    std::size_t scanned = 0;
+    for (std::size_t i = 0; i < rating.size(); ++i) {
+        if (paired[i]) continue;
+        const double window = windowAt(options, enqueued[i], now);
+        std::size_t best = rating.size();
+        double bestGap = 0;
+        for (std::size_t j = 0; j < rating.size(); ++j) {
+            if (j == i || paired[j]) continue;
+            const double gap = std::fabs(rating[i] - rating[j]);
+            if (gap > window || gap > windowAt(options, enqueued[j], now)) continue;
+            if (best == rating.size() || gap < bestGap) {
+                best = j;
+                bestGap = gap;
+            }
+        }
+        if (best == rating.size()) continue;
+        paired[i] = paired[best] = true;
+        ++scanned;
+    }
+    const double scanMs = msSince(start);
+
+    // Nearest bucket rather than nearest rating may cost a pair here and there, never more.
+    const bool ok = bucketed + rating.size() / 100 >= scanned;
+    std::printf("  backlog %6d: bucketed %6zu pairs %9.2f ms (%6.0f ns/player)  full scan %6zu pairs %9.2f ms "
+                "(%8.0f ns/player)  %s\n",
+                count, bucketed, bucketedMs, bucketedMs * 1e6 / count, scanned, scanMs, scanMs * 1e6 / count,
+                ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int population = argc > 1 ? std::max(100, std::atoi(argv[1])) : 40000;
+    std::printf("=== RocoArena Matchmaker Load Stress Test ===\n\n");
+
+    bool ok = true;
+    for (int count : { 1000, 4000, 16000 }) ok = runBacklog(count) && ok;
+    std::printf("\n");
+    ok = runPopulation(population) && ok;
+
+    std::printf("\n=== Stress test complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,239 @@
+// tests/stress/open_room_queue_stress.cpp
+// Stress test: /join_random from the open-room FIFO vs scanning every room
+//
+// Goal: Show that seating a player through OpenRoomQueue costs the same however many rooms
+//       exist, that it hands out rooms oldest first, and that the queue stays in step with the
+//       rooms while they are created, joined, left and retired concurrently
+// Input: a RoomRegistry of R rooms (default 20000) of which 1 in 50 waits for a second player,
+//        joined once by a registry snapshot scan (what /join_random did) and once from the
+//        queue; then T threads (default 8) creating, joining, leaving and retiring rooms the way
+//        the server's routes do, with the same locking
+// Assertions:
+//   - Both strategies seat every joiner; the queue seats them in room creation order
+//   - After the churn every room is queued exactly when it is open, the queue holds nothing
+//     else, and retired rooms are freed
+// Metrics: us per join for each strategy; churn operations/sec
+//
+// This is a standalone executable, not gtest. Outputs structured results.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <open_room_queue.h>
+#include <room_registry.h>
+
+namespace {
+
+constexpr std::size_t kShards = 32;
+constexpr int kOpenEvery = 50;
+constexpr int kChurnOpsPerThread = 20000;
+
+// The parts of the server's Room that decide whether it is open.
+struct Room {
+    std::mutex mutex;
+    bool closed = false;
+    std::string name;
+    std::uint64_t order = 0;
+    std::array<bool, 2> seats{};
+    bool session = false;
+    OpenRoomLink<Room> openLink;
+};
+
+bool roomOpen(const Room& room) {
+    return !room.closed && !room.session && room.seats[0] != room.seats[1];
+}
+
+struct World {
+    RoomRegistry<Room> rooms{ kShards };
+    OpenRoomQueue<Room> openRooms;
+    std::atomic<std::uint64_t> nextRoom{ 0 };
+};
+
+// What LockedRoom's destructor does: called with the room locked.
+void syncOpenRoom(World& world, const std::shared_ptr<Room>& room) {
+    const bool open = roomOpen(*room);
+    if (open == room->openLink.linked) return;
+    if (open) {
+        world.openRooms.push(room);
+    } else {
+        world.openRooms.remove(*room);
+    }
+}
+
+std::shared_ptr<Room> createRoom(World& world, bool full) {
+    auto room = std::make_shared<Room>();
+    room->order = world.nextRoom++;
+    room->name = "room-" + std::to_string(room->order);
+    room->seats[0] = true;
+    room->seats[1] = full;
+    world.rooms.insert(room->name, room);
+    std::lock_guard<std::mutex> lock(room->mutex);
+    syncOpenRoom(world, room);
+    return room;
+}
+
+bool seat(Room& room) {
+    for (bool& taken : room.seats) {
+        if (!taken) return taken = true;
+    }
+    return false;
+}
+
+// The old /join_random: every room, locked in turn, until one has a free seat.
+std::shared_ptr<Room> joinByScan(World& world) {
+    for (auto& room : world.rooms.snapshot()) {
+        std::unique_lock<std::mutex> lock(room->mutex);
+        if (room->closed || room->session || !seat(*room)) continue;
+        syncOpenRoom(world, room);
+        return room;
+    }
+    return nullptr;
+}
+
+// The new /join_random.
+std::shared_ptr<Room> joinFromQueue(World& world) {
+    while (auto room = world.openRooms.at(0)) {
+        std::unique_lock<std::mutex> lock(room->mutex);
+        if (!roomOpen(*room)) continue;
+        seat(*room);
+        syncOpenRoom(world, room);
+        return room;
+    }
+    return nullptr;
+}
+
+void leave(World& world, const std::shared_ptr<Room>& room, std::size_t seatIndex) {
+    std::unique_lock<std::mutex> lock(room->mutex);
+    if (room->closed) return;
+    room->seats[seatIndex] = false;
+    if (!room->seats[0] && !room->seats[1]) {
+        // retireRoom
+        room->closed = true;
+        world.openRooms.remove(*room);
+        lock.unlock();
+        world.rooms.erase(room->name, room);
+        return;
+    }
+    syncOpenRoom(world, room);
+}
+
+void startBattle(World& world, const std::shared_ptr<Room>& room) {
+    std::lock_guard<std::mutex> lock(room->mutex);
+    if (room->closed || !room->seats[0] || !room->seats[1]) return;
+    room->session = true;
+    syncOpenRoom(world, room);
+}
+
+double usPer(std::chrono::steady_clock::time_point start, std::size_t count) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+           static_cast<double>(count);
+}
+
+// Seats one joiner per open room with `join`; true if all were seated (in order, if `ordered`).
+template <typename Join>
+bool runJoins(const char* name, int roomCount, bool ordered, Join join, double& usPerJoin) {
+    World world;
+    std::vector<std::uint64_t> expected;
+    for (int i = 0; i < roomCount; ++i) {
+        const bool open = i % kOpenEvery == 0;
+        auto room = createRoom(world, !open);
+        if (open) expected.push_back(room->order);
+    }
+    std::vector<std::uint64_t> seated;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        auto room = join(world);
+        if (!room) break;
+        seated.push_back(room->order);
+    }
+    usPerJoin = usPer(start, expected.size());
+    bool ok = seated.size() == expected.size() && !join(world) && world.openRooms.size() == 0;
+    if (ordered) ok = ok && seated == expected;
+    std::printf("  %-28s %6zu joins over %6d rooms  %9.2f us/join  %s\n", name, seated.size(), roomCount, usPerJoin,
+                ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+bool runChurn(int threadCount) {
+    World world;
+    std::weak_ptr<Room> retiredProbe;
+    {
+        auto probe = createRoom(world, false);
+        retiredProbe = probe;
+        leave(world, probe, 0);
+    }
+    std::atomic<long> ops{ 0 };
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(77 + t);
+            std::vector<std::shared_ptr<Room>> mine;
+            for (int i = 0; i < kChurnOpsPerThread; ++i) {
+                switch (rng() % 5) {
+                    case 0: mine.push_back(createRoom(world, false)); break;
+                    case 1:
+                        if (auto room = joinFromQueue(world)) mine.push_back(std::move(room));
+                        break;
+                    case 2:
+                    case 3:
+                        if (!mine.empty()) {
+                            const std::size_t pick = rng() % mine.size();
+                            leave(world, mine[pick], rng() % 2);
+                            mine.erase(mine.begin() + static_cast<std::ptrdiff_t>(pick));
+                        }
+                        break;
+                    default:
+                        if (!mine.empty()) startBattle(world, mine[rng() % mine.size()]);
+                        break;
+                }
+                ++ops;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t open = 0;
+    bool ok = retiredProbe.expired();
+    for (auto& room : world.rooms.snapshot()) {
+        std::lock_guard<std::mutex> lock(room->mutex);
+        ok = ok && room->openLink.linked == roomOpen(*room);
+        if (roomOpen(*room)) ++open;
+    }
+    ok = ok && open == world.openRooms.size();
+    std::size_t walked = 0;
+    while (world.openRooms.at(walked)) ++walked;
+    ok = ok && walked == open;
+    std::printf("  churn, %d threads: %ld ops  %.0f ops/sec  %zu rooms, %zu open  %s\n", threadCount, ops.load(),
+                static_cast<double>(ops.load()) / seconds, world.rooms.size(), open, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int roomCount = argc > 1 ? std::max(kOpenEvery, std::atoi(argv[1])) : 20000;
+    const int threadCount = argc > 2 ? std::max(1, std::atoi(argv[2])) : 8;
+    std::printf("=== RocoArena Open-Room Queue Stress Test ===\n\n");
+
+    double scanUs = 0;
+    double queueUs = 0;
+    bool ok = runJoins("snapshot scan (before)", roomCount, false, joinByScan, scanUs);
+    ok = runJoins("open-room queue (after)", roomCount, true, joinFromQueue, queueUs) && ok;
+    std::printf("  speedup: %.1fx\n\n", scanUs / queueUs);
+    ok = runChurn(threadCount) && ok;
+
+    std::printf("\n=== Stress test complete: %s ===\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
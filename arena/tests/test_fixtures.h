@@ -0,0 +1,69 @@
+#pragma once
+
+// Synthetic game data for the perf benchmarks and stress tests: a small skill registry with pets
+// built from one species, and a DataStore of generated pet templates with their prototypes.
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <data_loader.h>
+#include <entity/Pet.h>
+#include <skill/SkillRegistry.h>
+
+namespace fixtures {
+
+// Skills 1..kSkillCount; every pet makeRoster builds knows all of them.
+inline constexpr int kSkillCount = 4;
+
+inline SkillRegistry makeRegistry() {
+    std::vector<SkillBase> skills;
+    for (int i = 1; i <= kSkillCount; ++i) {
+        skills.emplace_back(i, "Skill" + std::to_string(i), "test skill", SkillType::Physical, AttrType::Normal,
+                            40 + i * 10, 20);
+    }
+    SkillRegistry registry;
+    registry.load(std::move(skills));
+    return registry;
+}
+
+// `count` level-100 pets of species `sp` with max IVs and skills 1..kSkillCount from `registry`.
+inline std::vector<std::unique_ptr<Pet>> makeRoster(Species& sp, const SkillRegistry& registry, int count) {
+    std::vector<std::unique_ptr<Pet>> roster;
+    IVData iv{31, 31, 31, 31, 31, 31};
+    EVData ev{0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < count; ++i) {
+        auto pet = std::make_unique<Pet>(&sp, iv, ev);
+        pet->calcRealStat(sp.baseStats(), iv, ev, NatureType::Hardy, 100);
+        pet->setLearnableSkills({1, 2, 3, 4});
+        for (int id = 1; id <= kSkillCount; ++id) pet->configureSkill(id, registry);
+        roster.push_back(std::move(pet));
+    }
+    return roster;
+}
+
+// `templates` pet templates (ids 1..templates, base stats spread by id), each learning `learnable`
+// of `skills` generated skills, with their prototypes built as loadDataStore would.
+inline DataStore makeStore(int templates, int skills, int learnable) {
+    DataStore store;
+    std::vector<SkillBase> skillList;
+    for (int i = 1; i <= skills; ++i) {
+        skillList.emplace_back(i, "Skill" + std::to_string(i), "test skill", SkillType::Physical, AttrType::Normal,
+                               60 + i * 5, 40);
+    }
+    store.skills.load(std::move(skillList));
+    for (int id = 1; id <= templates; ++id) {
+        PetTemplate templ;
+        const int base = 60 + id % 60;
+        templ.species = std::make_shared<Species>(id, "Pet" + std::to_string(id),
+                                                  std::array<AttrType, 2>{ AttrType::Normal, AttrType::None },
+                                                  BS(base, base + 5, base + 10, base + 15, base + 20, base + 25));
+        for (int k = 0; k < learnable; ++k) templ.learnableSkillIds.push_back(1 + (id * 7 + k * 5) % skills);
+        store.pets.emplace(id, std::move(templ));
+    }
+    buildPetPrototypes(store);
+    return store;
+}
+
+} // namespace fixtures